@@ -23,6 +23,7 @@
 #include "rdkshell.h"
 #include "essosinstance.h"
 #include "compositorcontroller.h"
+#include "tracerecorder.h"
 
 #include <iostream>
 
@@ -50,6 +51,7 @@ namespace RdkShell
 
     void Animator::animate()
     {
+        RDKSHELL_TRACE_SPAN("animation", "animate");
         uint32_t screenWidth = 0;
         uint32_t screenHeight = 0;
         RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
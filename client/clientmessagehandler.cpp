@@ -19,20 +19,19 @@
 
 #include "clientmessagehandler.h"
 #include "communicationhandler.h"
+#include "binaryprotocol.h"
+#include "ipcschema.h"
 #include "logger.h"
 #include <sstream> 
 
 namespace RdkShell
 {
-    std::map<std::string, void(*)(const rapidjson::Value& , std::map<std::string, RdkShellData>&)> ClientMessageHandler::mResponseHandler;
     std::map<std::string, void(*)(const rapidjson::Value&, std::vector<std::map<std::string, RdkShellData>>&)> ClientMessageHandler::mEventHandler;
   
-    // message handlers
-    static void getScaleHandler(const rapidjson::Value& params, std::map<std::string, RdkShellData>& responseData);
-    static void getBoundsHandler(const rapidjson::Value& params, std::map<std::string, RdkShellData>& responseData);
-  
     // event handlers
     static void onAnimationHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData);
+    static void onSizeChangeCompleteHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData);
+    static void onUserInactiveHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData);
   
     struct ParameterInfo
     {
@@ -89,55 +88,39 @@ namespace RdkShell
   
     void ClientMessageHandler::initialize()
     {
-        sParameterInfo["createDisplay"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["createDisplay"]["client"] = {0, true, 's'};
+        size_t methodCount = 0;
+        const IpcMethodSchema* methods = ipcMethodSchemas(methodCount);
+        for (size_t i = 0; i < methodCount; i++)
+        {
+            std::map<std::string, ParameterInfo>& parameterInfo = sParameterInfo[methods[i].name];
+            size_t parameterCount = ipcParameterCount(methods[i]);
+            for (size_t index = 0; index < parameterCount; index++)
+            {
+                const IpcParameterSchema& parameter = methods[i].parameters[index];
+                // key modifiers are passed as flags, arrays and objects cannot be expressed as RdkShellData
+                char type = (parameter.type == 'm') ? 'u' : parameter.type;
+                if ((type == 'a') || (type == 'o'))
+                {
+                    continue;
+                }
+                parameterInfo[parameter.name] = {(int)index, parameter.mandatory, type};
+            }
+        }
+        // name used by earlier versions of the client library
         sParameterInfo["createDisplay"]["display"] = {1, false, 's'};
-  
-        sParameterInfo["launchApplication"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["launchApplication"]["client"] = {0, true, 's'};
-        sParameterInfo["launchApplication"]["uri"] = {1, true, 's'};
-        sParameterInfo["launchApplication"]["mime"] = {2, true, 's'};
-  
-        sParameterInfo["kill"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["kill"]["client"] = {0, true, 's'};
-  
-        sParameterInfo["setScale"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["setScale"]["client"] = {0, true, 's'};
-        sParameterInfo["setScale"]["sx"] = {1, false, 'f'};
-        sParameterInfo["setScale"]["sy"] = {2, false, 'f'};
-  
-        sParameterInfo["getScale"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["getScale"]["client"] = {0, true, 's'};
-  
-        sParameterInfo["getBounds"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["getBounds"]["client"] = {0, true, 's'};
-  
-        sParameterInfo["setBounds"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["setBounds"]["client"] = {0, true, 's'};
-        sParameterInfo["setBounds"]["x"] = {1, false, 'u'};
-        sParameterInfo["setBounds"]["y"] = {2, false, 'u'};
-        sParameterInfo["setBounds"]["w"] = {3, false, 'u'};
-        sParameterInfo["setBounds"]["h"] = {4, false, 'u'};
-  
-        sParameterInfo["addAnimation"] = std::map<std::string, ParameterInfo>();
-        sParameterInfo["addAnimation"]["client"] = {0, true, 's'};
-        sParameterInfo["addAnimation"]["duration"] = {1, true, 'u'};
-        sParameterInfo["addAnimation"]["x"] = {2, false, 'u'};
-        sParameterInfo["addAnimation"]["y"] = {3, false, 'u'};
-        sParameterInfo["addAnimation"]["w"] = {4, false, 'u'};
-        sParameterInfo["addAnimation"]["w"] = {5, false, 'u'};
-        sParameterInfo["addAnimation"]["sx"] = {6, false, 'f'};
-        sParameterInfo["addAnimation"]["sy"] = {7, false, 'f'};
         populateMandatoryParameterInfo();
   
-        mResponseHandler["getBounds"] = getBoundsHandler;
-        mResponseHandler["getScale"] = getScaleHandler;
         mEventHandler["onAnimation"] = onAnimationHandler;
+        mEventHandler["onSizeChangeComplete"] = onSizeChangeCompleteHandler;
+        mEventHandler["onUserInactive"] = onUserInactiveHandler;
     }
   
-    bool ClientMessageHandler::prepareRequestParameters(std::string& method, std::map<std::string, RdkShellData>& params, std::string& parameterString)
+    /*
+        collectParameters validates the parameters of a request against the method's parameter table and returns
+        the ones that apply, shared by the json and the binary encoding
+    */
+    static bool collectParameters(std::string& method, std::map<std::string, RdkShellData>& params, std::vector<std::pair<ParameterInfo*, RdkShellData*>>& parameters)
     {
-        std::stringstream outputString;
         std::map<std::string , std::map<std::string, ParameterInfo>>::iterator parametersIterator = sParameterInfo.find(method);
         if (parametersIterator == sParameterInfo.end())
         {
@@ -151,27 +134,13 @@ namespace RdkShell
         }
         int numberOfMandatoryParameters = 0;
         std::map<std::string, ParameterInfo>& info = parametersIterator->second;
-  
-        bool isFirstParameter = true;
-        outputString << "{";
         for (std::map<std::string, RdkShellData>::iterator iter = params.begin(); iter != params.end(); iter++)
         {
             std::map<std::string, ParameterInfo>::iterator parameterArgumentsIterator = info.find(iter->first);
             if (parameterArgumentsIterator != info.end())
             {
-                if (!isFirstParameter)
-                {
-                    outputString << ",";
-                }
-                isFirstParameter = false;
                 ParameterInfo& parameterInformation = parameterArgumentsIterator->second;
-                outputString << "\"" << parameterInformation.index << "\":";
-                bool ret = populateParameterValue(parameterInformation.type, iter->second, outputString);
-                if (false == ret)
-                {
-                    Logger::log(Error, "unable to call method [%s]", method.c_str());
-                    return false;
-                }
+                parameters.push_back(std::make_pair(&parameterInformation, &iter->second));
                 if (parameterInformation.mandatory == true)
                     numberOfMandatoryParameters++;
             }
@@ -185,22 +154,120 @@ namespace RdkShell
             Logger::log(Error, "Sufficient number of mandatory parameters not passed for method [%s]", method.c_str());
             return false;
         }
+        return true;
+    }
+  
+    bool ClientMessageHandler::prepareRequestParameters(std::string& method, std::map<std::string, RdkShellData>& params, std::string& parameterString)
+    {
+        std::vector<std::pair<ParameterInfo*, RdkShellData*>> parameters;
+        if (!collectParameters(method, params, parameters))
+        {
+            return false;
+        }
+
+        std::stringstream outputString;
+        outputString << "{";
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            if (i > 0)
+            {
+                outputString << ",";
+            }
+            ParameterInfo& parameterInformation = *parameters[i].first;
+            outputString << "\"" << parameterInformation.index << "\":";
+            bool ret = populateParameterValue(parameterInformation.type, *parameters[i].second, outputString);
+            if (false == ret)
+            {
+                Logger::log(Error, "unable to call method [%s]", method.c_str());
+                return false;
+            }
+        }
         outputString << "}";
         parameterString = outputString.str();
         return true;
     }
+
+    bool ClientMessageHandler::prepareBinaryRequest(std::string& name, std::map<std::string, RdkShellData>& params, uint16_t& methodId, std::string& payload)
+    {
+        methodId = binaryMethodId(name);
+        if (methodId == 0)
+        {
+            return false;
+        }
+        std::vector<std::pair<ParameterInfo*, RdkShellData*>> parameters;
+        if (!collectParameters(name, params, parameters))
+        {
+            return false;
+        }
+        payload.clear();
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            ParameterInfo& parameterInformation = *parameters[i].first;
+            if (!appendBinaryParameter((uint8_t)parameterInformation.index, parameterInformation.type, *parameters[i].second, payload))
+            {
+                Logger::log(Error, "unable to call method [%s]", name.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
   
-    bool ClientMessageHandler::prepareRequest(std::string& name, std::map<std::string, RdkShellData>& params, std::stringstream& output)
+    bool ClientMessageHandler::prepareRequest(std::string& name, std::map<std::string, RdkShellData>& params, std::stringstream& output, bool acknowledge)
     {
         std::string parameterString("");
         bool ret = prepareRequestParameters(name, params, parameterString);
         if (true == ret)
         {
-            output << "{\"method\" : \""<<name.c_str()<<"\", \"params\":" << parameterString << "}";
+            output << "{\"method\" : \""<<name.c_str()<<"\", ";
+            if (acknowledge)
+            {
+                output << "\"ack\":true, ";
+            }
+            output << "\"params\":" << parameterString << "}";
         }
         return ret;
     }
   
+    // array and object results have no RdkShellData representation and are left out
+    static void readResults(const IpcMethodSchema& schema, const rapidjson::Value& params, std::map<std::string, RdkShellData>& responseData)
+    {
+        size_t resultCount = ipcResultCount(schema);
+        for (size_t i = 0; i < resultCount; i++)
+        {
+            const IpcResultSchema& result = schema.results[i];
+            rapidjson::Value::ConstMemberIterator member = params.FindMember(result.name);
+            if (member == params.MemberEnd())
+            {
+                continue;
+            }
+            const rapidjson::Value& value = member->value;
+            if ((result.type == 'b') && value.IsBool())
+            {
+                responseData[result.name] = value.GetBool();
+            }
+            else if ((result.type == 'i') && value.IsInt())
+            {
+                responseData[result.name] = (int32_t)value.GetInt();
+            }
+            else if ((result.type == 'u') && value.IsUint())
+            {
+                responseData[result.name] = (uint32_t)value.GetUint();
+            }
+            else if ((result.type == 'u') && value.IsUint64())
+            {
+                responseData[result.name] = (uint64_t)value.GetUint64();
+            }
+            else if ((result.type == 'f') && value.IsNumber())
+            {
+                responseData[result.name] = value.GetDouble();
+            }
+            else if ((result.type == 's') && value.IsString())
+            {
+                responseData[result.name] = std::string(value.GetString(), value.GetStringLength());
+            }
+        }
+    }
+
     void ClientMessageHandler::handleResponse(Document& d, std::string& name, bool& isApiError, std::map<std::string, RdkShellData>& responseData)
     {
         if (!d.HasMember("method"))
@@ -222,14 +289,13 @@ namespace RdkShell
         {
             return;  
         }
-        if (mResponseHandler.find(method) != mResponseHandler.end())
-        {
-            mResponseHandler[method](params, responseData);
-        }
-        else
+        const IpcMethodSchema* schema = findIpcMethodSchema(method.c_str());
+        if (NULL == schema)
         {
             Logger::log(Error, "received unhandled response message [%s]", method.c_str());
+            return;
         }
+        readResults(*schema, params, responseData);
     }
   
     void ClientMessageHandler::handleEvent(Document& d, std::string& name, std::vector<std::map<std::string, RdkShellData>>& eventData)
@@ -286,20 +352,6 @@ namespace RdkShell
         return ret;
     }
   
-    static void getBoundsHandler(const rapidjson::Value& params, std::map<std::string, RdkShellData>& responseData)
-    {
-        responseData["x"] = params["x"].GetUint();
-        responseData["y"] = params["y"].GetUint();
-        responseData["w"] = params["w"].GetUint();
-        responseData["h"] = params["h"].GetUint();
-    }
-    
-    static void getScaleHandler(const rapidjson::Value& params, std::map<std::string, RdkShellData>& responseData)
-    {
-        responseData["sx"] = params["sx"].GetDouble();
-        responseData["sy"] = params["sy"].GetDouble();
-    }
-    
     static void onAnimationHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData)
     {
         if (params.IsArray())
@@ -337,4 +389,29 @@ namespace RdkShell
             }
         }
     }
+
+    static void onSizeChangeCompleteHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData)
+    {
+        if (params.IsArray())
+        {
+            for (rapidjson::SizeType i = 0; i < params.Size(); i++)
+            {
+                const rapidjson::Value& sizeChangeObject = params[i];
+                if (sizeChangeObject.IsObject() && sizeChangeObject.HasMember("client") && sizeChangeObject["client"].IsString())
+                {
+                    eventData.push_back(std::map<std::string, RdkShellData>());
+                    eventData.back()["client"] = sizeChangeObject["client"].GetString();
+                }
+            }
+        }
+    }
+
+    static void onUserInactiveHandler(const rapidjson::Value& params, std::vector<std::map<std::string, RdkShellData>>& eventData)
+    {
+        if (params.IsArray() && (params.Size() > 0) && params[0].IsObject() && params[0].HasMember("minutes") && params[0]["minutes"].IsNumber())
+        {
+            eventData.push_back(std::map<std::string, RdkShellData>());
+            eventData.back()["minutes"] = params[0]["minutes"].GetDouble();
+        }
+    }
 }
@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <stdint.h>
 #include <rapidjson/document.h>
 #include <rdkshelldata.h>
 
@@ -44,13 +45,15 @@ namespace RdkShell
         public:
             static void initialize();
             static bool prepareRequestParameters(std::string& method, std::map<std::string, RdkShellData>& params, std::string& parameterString);
-            static bool prepareRequest(std::string& name, std::map<std::string, RdkShellData>& params, std::stringstream& output);
+            // acknowledge asks the server to respond even when the method has no results
+            static bool prepareRequest(std::string& name, std::map<std::string, RdkShellData>& params, std::stringstream& output, bool acknowledge = false);
+            // fails for methods that have no binary method id
+            static bool prepareBinaryRequest(std::string& name, std::map<std::string, RdkShellData>& params, uint16_t& methodId, std::string& payload);
             static MessageType handleMessage(std::string& response, std::string& name, std::map<std::string, RdkShellData>& responseData, std::vector<std::map<std::string, RdkShellData>>& eventData);
       
         private:
             static void handleResponse(Document& d, std::string& name, bool& isApiError, std::map<std::string, RdkShellData>& responseData);
             static void handleEvent(Document &d, std::string& name, std::vector<std::map<std::string, RdkShellData>>& eventData);
-            static std::map<std::string, void(*)(const rapidjson::Value& , std::map<std::string, RdkShellData>&)> mResponseHandler;
             static std::map<std::string, void(*)(const rapidjson::Value&, std::vector<std::map<std::string, RdkShellData>>&)> mEventHandler;
     };
 }
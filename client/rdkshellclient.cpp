@@ -21,21 +21,35 @@
 #include "communicationhandler.h"
 #include "communicationfactory.h"
 #include "clientmessagehandler.h"
+#include "binaryprotocol.h"
+#include "ipcschema.h"
 #include "logger.h"
+#include <algorithm>
 #include <sstream>
 #include <iostream>
+#include <time.h>
 
-#define MESSAGE_RESPONSE_TIMEOUT 3000
+// timeouts in microseconds
+#define MESSAGE_RESPONSE_TIMEOUT 3000000
+#define PROTOCOL_NEGOTIATION_TIMEOUT 1000000
 
 namespace RdkShell
 {
     RdkShellClient* RdkShellClient::mInstance = NULL;
+
+    static int64_t monotonicMicroseconds()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+    }
 }
 
 namespace RdkShell
 {
     RdkShellClient::RdkShellClient() : mCommunicationHandler(NULL), mIsConnectedToServer(false),
-           mResponseTimeout(MESSAGE_RESPONSE_TIMEOUT), mEventHandlers(), mMessageId(0)
+           mResponseTimeout(MESSAGE_RESPONSE_TIMEOUT), mEventHandlers(), mMessageId(0), mPendingRequests(), mUseBinaryProtocol(false),
+           mNegotiationId(-1), mServerAcknowledges(false)
     {
     }
     
@@ -49,6 +63,7 @@ namespace RdkShell
         }
         mIsConnectedToServer = false;
         mEventHandlers.clear();
+        mPendingRequests.clear();
     }
 
     RdkShellClient* RdkShellClient::instance()
@@ -68,30 +83,212 @@ namespace RdkShell
         if (!ret)
         {
             Logger::log(Fatal, "client initialization failed !!");
+            return;
+        }
+        negotiateProtocol();
+        // listeners registered before the connection was up
+        for (std::map<std::string, std::vector<RdkShellEventListener*>>::iterator iter = mEventHandlers.begin(); iter != mEventHandlers.end(); iter++)
+        {
+            if (!iter->second.empty())
+            {
+                updateEventSubscription(iter->first, true);
+            }
         }
     }
 
-    bool RdkShellClient::callMethod(std::string& name, std::map<std::string, RdkShellData>& params)
+    /*
+        the negotiation is not waited for here. servers that predate it never answer, and they also do not
+        know about acknowledgements or event subscriptions, so the requests that depend on it wait for the
+        answer once, see serverAcknowledges
+    */
+    void RdkShellClient::negotiateProtocol()
+    {
+        std::string method("negotiateProtocol");
+        std::map<std::string, RdkShellData> params;
+        params["protocol"] = std::string("binary");
+        int id = ++mMessageId;
+        if (!sendRequest(id, method, params, false))
+        {
+            Logger::log(Information, "using json protocol");
+            return;
+        }
+        mNegotiationId = id;
+        PendingRequest& request = mPendingRequests[id];
+        request.method = method;
+        request.callback = [this](bool success, std::map<std::string, RdkShellData>& result)
+            {
+                mNegotiationId = -1;
+                mServerAcknowledges = success;
+                mUseBinaryProtocol = success && (result.find("protocol") != result.end()) && (result["protocol"].toString() == "binary");
+                Logger::log(Information, "using %s protocol%s", mUseBinaryProtocol ? "binary" : "json",
+                    mServerAcknowledges ? "" : ", the server does not acknowledge requests");
+            };
+        request.deadline = monotonicMicroseconds() + PROTOCOL_NEGOTIATION_TIMEOUT;
+    }
+
+    // waits for the outstanding negotiation, so its timeout is paid at most once
+    bool RdkShellClient::serverAcknowledges()
+    {
+        std::map<int, PendingRequest>::iterator requestIterator = mPendingRequests.find(mNegotiationId);
+        if (requestIterator != mPendingRequests.end())
+        {
+            waitForResponse(mNegotiationId, std::max<int64_t>(0, requestIterator->second.deadline - monotonicMicroseconds()));
+        }
+        return mServerAcknowledges;
+    }
+
+    bool RdkShellClient::sendRequest(int id, std::string& name, std::map<std::string, RdkShellData>& params, bool acknowledge)
     {
+        if (mUseBinaryProtocol && (binaryMethodId(name) != 0))
+        {
+            uint16_t methodId = 0;
+            std::string payload;
+            if (!ClientMessageHandler::prepareBinaryRequest(name, params, methodId, payload))
+            {
+                return false;
+            }
+            if (acknowledge)
+            {
+                methodId |= RDKSHELL_BINARY_ACKNOWLEDGE_FLAG;
+            }
+            return mCommunicationHandler->sendBinaryMessage(id, methodId, payload);
+        }
+
         std::stringstream message("");
-        bool ret = ClientMessageHandler::prepareRequest(name, params, message);
+        bool ret = ClientMessageHandler::prepareRequest(name, params, message, acknowledge);
         if (true == ret)
         {
             std::string request = message.str();
-            ret = mCommunicationHandler->sendMessage(mMessageId, request);
+            ret = mCommunicationHandler->sendMessage(id, request);
         }
         return ret;
     }
 
+    bool RdkShellClient::callMethod(std::string& name, std::map<std::string, RdkShellData>& params)
+    {
+        return sendRequest(++mMessageId, name, params, false);
+    }
+
     bool RdkShellClient::callMethodWithResult(std::string& name, std::map<std::string, RdkShellData>& params, std::map<std::string, RdkShellData>& result)
     {
-        std::stringstream message("");
-        bool ret = callMethod(name, params);
-        if (true == ret)
+        bool success = false;
+        int id = callMethodAsync(name, params, [&success, &result](bool callSuccess, std::map<std::string, RdkShellData>& callResult)
+            {
+                success = callSuccess;
+                result = callResult;
+            }, mResponseTimeout);
+        if (id == -1)
         {
-            processMessages(mResponseTimeout, result);
+            return false;
+        }
+        waitForResponse(id, mResponseTimeout);
+        return success;
+    }
+
+    int RdkShellClient::callMethodAsync(std::string& name, std::map<std::string, RdkShellData>& params, RdkShellResponseCallback callback,
+        int64_t timeoutInMicroseconds)
+    {
+        if (NULL == mCommunicationHandler)
+        {
+            return -1;
+        }
+        // the acknowledgement makes methods without results answer too, so every call completes
+        bool acknowledge = serverAcknowledges();
+        int id = ++mMessageId;
+        if (!sendRequest(id, name, params, acknowledge))
+        {
+            return -1;
+        }
+        const IpcMethodSchema* schema = findIpcMethodSchema(name.c_str());
+        if (!acknowledge && (NULL != schema) && (0 == ipcResultCount(*schema)))
+        {
+            std::map<std::string, RdkShellData> result;
+            if (callback)
+            {
+                callback(true, result);
+            }
+            return id;
+        }
+        PendingRequest& request = mPendingRequests[id];
+        request.method = name;
+        request.callback = callback;
+        request.deadline = monotonicMicroseconds() + ((timeoutInMicroseconds < 0) ? mResponseTimeout : timeoutInMicroseconds);
+        return id;
+    }
+
+    bool RdkShellClient::waitForResponse(int id, int64_t timeoutInMicroseconds)
+    {
+        int64_t deadline = monotonicMicroseconds() + timeoutInMicroseconds;
+        while (mPendingRequests.find(id) != mPendingRequests.end())
+        {
+            int64_t remaining = deadline - monotonicMicroseconds();
+            if ((remaining <= 0) || !receiveMessage(remaining))
+            {
+                break;
+            }
+        }
+        if (mPendingRequests.find(id) == mPendingRequests.end())
+        {
+            return true;
+        }
+        // the callback may refer to the caller's stack, it can not be left pending
+        std::map<std::string, RdkShellData> result;
+        completeRequest(id, false, result);
+        return false;
+    }
+
+    bool RdkShellClient::waitForResponses(int64_t timeoutInMicroseconds)
+    {
+        int64_t deadline = monotonicMicroseconds() + timeoutInMicroseconds;
+        while (!mPendingRequests.empty())
+        {
+            int64_t remaining = deadline - monotonicMicroseconds();
+            if ((remaining <= 0) || !receiveMessage(remaining))
+            {
+                break;
+            }
+        }
+        expirePendingRequests();
+        return mPendingRequests.empty();
+    }
+
+    size_t RdkShellClient::pendingRequestCount() const
+    {
+        return mPendingRequests.size();
+    }
+
+    void RdkShellClient::completeRequest(int id, bool success, std::map<std::string, RdkShellData>& result)
+    {
+        std::map<int, PendingRequest>::iterator requestIterator = mPendingRequests.find(id);
+        if (requestIterator == mPendingRequests.end())
+        {
+            return;
+        }
+        RdkShellResponseCallback callback = requestIterator->second.callback;
+        mPendingRequests.erase(requestIterator);
+        if (callback)
+        {
+            callback(success, result);
+        }
+    }
+
+    void RdkShellClient::expirePendingRequests()
+    {
+        int64_t now = monotonicMicroseconds();
+        std::vector<int> expiredRequests;
+        for (std::map<int, PendingRequest>::iterator iter = mPendingRequests.begin(); iter != mPendingRequests.end(); iter++)
+        {
+            if (iter->second.deadline <= now)
+            {
+                expiredRequests.push_back(iter->first);
+            }
+        }
+        for (size_t i = 0; i < expiredRequests.size(); i++)
+        {
+            Logger::log(Warn, "request %d timed out", expiredRequests[i]);
+            std::map<std::string, RdkShellData> result;
+            completeRequest(expiredRequests[i], false, result);
         }
-        return ret;
     }
 
     void RdkShellClient::registerForEvent(std::string& name, RdkShellEventListener* listener)
@@ -117,6 +314,10 @@ namespace RdkShell
         if (!found)
         {
             mEventHandlers[name].push_back(listener);
+            if (mEventHandlers[name].size() == 1)
+            {
+                updateEventSubscription(name, true);
+            }
         }
     }
 
@@ -140,54 +341,102 @@ namespace RdkShell
         if (eraseEntry != listeners.end())
         {
             listeners.erase(eraseEntry);
+            if (listeners.empty())
+            {
+                updateEventSubscription(name, false);
+            }
+        }
+    }
+
+    /*
+        the server only sends a connection the events it subscribed to. onApiError and other events that the
+        client library raises itself are not subscriptions.
+    */
+    void RdkShellClient::updateEventSubscription(const std::string& name, bool subscribe)
+    {
+        if ((NULL == mCommunicationHandler) || (findIpcEvent(name.c_str()) < 0))
+        {
+            return;
+        }
+        // earlier servers send every event to every connection
+        if (!serverAcknowledges())
+        {
+            return;
         }
+        std::string method(subscribe ? "subscribeEvent" : "unsubscribeEvent");
+        std::map<std::string, RdkShellData> params;
+        params["event"] = name;
+        callMethodAsync(method, params, [method, name](bool success, std::map<std::string, RdkShellData>& /*result*/)
+            {
+                if (!success)
+                {
+                    Logger::log(Warn, "%s for %s failed", method.c_str(), name.c_str());
+                }
+            });
     }
 
     void RdkShellClient::processMessages(int wait)
     {
-        std::map<std::string, RdkShellData> responseData;
-        processMessages(wait, responseData);
-        if (responseData.size() > 0)
+        // handle everything that is already available once the first message arrived
+        if (receiveMessage((int64_t)wait * 1000000))
         {
-            Logger::log(Warn, "got a delayed response message");
+            while (receiveMessage(0));
+        }
+        expirePendingRequests();
+    }
+
+    bool RdkShellClient::receiveMessage(int64_t timeoutInMicroseconds)
+    {
+        int id = -1;
+        std::string message;
+        if (!mCommunicationHandler->receiveMessage(timeoutInMicroseconds, id, message))
+        {
+            return false;
         }
+        handleMessage(id, message);
+        return true;
     }
 
-    void RdkShellClient::processMessages(int wait, std::map<std::string, RdkShellData>& responseData)
+    void RdkShellClient::handleMessage(int id, std::string& message)
     {
-        std::string response("");
-        if (mCommunicationHandler->process(wait, &response))
+        std::string name;
+        std::map<std::string, RdkShellData> responseData;
+        std::vector<std::map<std::string, RdkShellData>> eventData;
+        MessageType ret = ClientMessageHandler::handleMessage(message, name, responseData, eventData);
+        if (((ret == RESPONSE) || (ret == API_ERROR)) && (mPendingRequests.find(id) != mPendingRequests.end()))
         {
-            std::string name;
-            std::vector<std::map<std::string, RdkShellData>> eventData;
-            MessageType ret = ClientMessageHandler::handleMessage(response, name, responseData, eventData);
-            if (ret == EVENT)
+            completeRequest(id, ret == RESPONSE, responseData);
+        }
+        else if (ret == EVENT)
+        {
+            if (mEventHandlers.find(name) != mEventHandlers.end())
             {
-                if (mEventHandlers.find(name) != mEventHandlers.end())
+                std::vector<RdkShellEventListener*>& listeners = mEventHandlers[name];
+                for (std::vector<RdkShellEventListener*>::iterator iter=listeners.begin(); iter != listeners.end(); iter++)
                 {
-                    std::vector<RdkShellEventListener*>& listeners = mEventHandlers[name];
-                    for (std::vector<RdkShellEventListener*>::iterator iter=listeners.begin(); iter != listeners.end(); iter++)
-                    {
-                        (*iter)->onEvent(name, eventData);
-                    }
+                    (*iter)->onEvent(name, eventData);
                 }
             }
-            else if (ret == API_ERROR)
+        }
+        else if (ret == API_ERROR)
+        {
+            if (mEventHandlers.find("onApiError") != mEventHandlers.end())
             {
-                if (mEventHandlers.find("onApiError") != mEventHandlers.end())
+                std::vector<RdkShellEventListener*>& listeners = mEventHandlers["onApiError"];
+                for (std::vector<RdkShellEventListener*>::iterator iter=listeners.begin(); iter != listeners.end(); iter++)
                 {
-                    std::vector<RdkShellEventListener*>& listeners = mEventHandlers["onApiError"];
-                    for (std::vector<RdkShellEventListener*>::iterator iter=listeners.begin(); iter != listeners.end(); iter++)
-                    {
-                        (*iter)->onApiError(name);
-                    }
+                    (*iter)->onApiError(name);
                 }
-                Logger::log(Information, "error response received ");
-            }
-            else if (ret == NONE)
-            {
-                Logger::log(Warn, "error in processing message [%s] ", name.c_str());
             }
+            Logger::log(Information, "error response received ");
+        }
+        else if (ret == RESPONSE)
+        {
+            Logger::log(Warn, "got a delayed response message");
+        }
+        else
+        {
+            Logger::log(Warn, "error in processing message [%s] ", name.c_str());
         }
     }
 }
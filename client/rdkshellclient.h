@@ -25,9 +25,13 @@
 #include "rdkshelleventlistener.h"
 #include <map>
 #include <vector>
+#include <functional>
+#include <stdint.h>
 
 namespace RdkShell
 {
+    typedef std::function<void(bool success, std::map<std::string, RdkShellData>& result)> RdkShellResponseCallback;
+
     class RdkShellClient
     {
         public:
@@ -36,19 +40,50 @@ namespace RdkShell
             void initialize();
             bool callMethod(std::string& name, std::map<std::string, RdkShellData>& params);
             bool callMethodWithResult(std::string& name, std::map<std::string, RdkShellData>& params, std::map<std::string, RdkShellData>& result);
+            /*
+                sends the request without waiting for the response, so many requests can be outstanding on the
+                connection. the callback runs from processMessages or waitForResponses when the response with the
+                same id arrives, or with success false when the timeout expires. returns the request id or -1.
+                servers that predate protocol negotiation never answer methods without results, for those the
+                callback runs right away once the request was sent.
+            */
+            int callMethodAsync(std::string& name, std::map<std::string, RdkShellData>& params, RdkShellResponseCallback callback,
+                int64_t timeoutInMicroseconds = -1);
+            // processes messages until every outstanding request completed or the timeout expired
+            bool waitForResponses(int64_t timeoutInMicroseconds);
+            size_t pendingRequestCount() const;
             void processMessages(int wait = 0);
             void registerForEvent(std::string& name, RdkShellEventListener* listener);
             void unregisterEvent(std::string& name, RdkShellEventListener* listener);
 
         private:
             RdkShellClient();
-            void processMessages(int wait, std::map<std::string, RdkShellData>& responseData);
+            struct PendingRequest
+            {
+                std::string method;
+                RdkShellResponseCallback callback;
+                int64_t deadline;
+            };
+
+            bool sendRequest(int id, std::string& name, std::map<std::string, RdkShellData>& params, bool acknowledge);
+            bool receiveMessage(int64_t timeoutInMicroseconds);
+            void handleMessage(int id, std::string& message);
+            bool waitForResponse(int id, int64_t timeoutInMicroseconds);
+            void completeRequest(int id, bool success, std::map<std::string, RdkShellData>& result);
+            void expirePendingRequests();
+            void negotiateProtocol();
+            bool serverAcknowledges();
+            void updateEventSubscription(const std::string& name, bool subscribe);
             static RdkShellClient* mInstance;
             CommunicationHandler* mCommunicationHandler;
             bool mIsConnectedToServer;
-            int mResponseTimeout;
+            int64_t mResponseTimeout;
             std::map<std::string, std::vector<RdkShellEventListener*>> mEventHandlers;
             int mMessageId;
+            std::map<int, PendingRequest> mPendingRequests;
+            bool mUseBinaryProtocol;
+            int mNegotiationId; // the negotiateProtocol request while its response is outstanding, otherwise -1
+            bool mServerAcknowledges;
     };
 }
 
@@ -225,6 +225,43 @@ int main()
     ret = RdkShellClient::instance()->callMethod(method, requestParams);
     Logger::log(Information, "callmethod for kill result - [%d]", ret);
   
+    // ##################################### TEST 9
+    // pipeline a layout update and read back the result without waiting for each response
+    requestParams.clear();
+    method = "launchApplication";
+    requestParams["client"] = "test_display_async";
+    requestParams["uri"] = "westeros_test";
+    requestParams["mime"] = "application/native";
+    ret = RdkShellClient::instance()->callMethod(method, requestParams);
+    Logger::log(Information, "callmethod for launchApplication result - [%d]", ret);
+    for (int i = 0; i < 4; i++)
+    {
+        requestParams.clear();
+        method = "setBounds";
+        requestParams["client"] = "test_display_async";
+        requestParams["x"] = 10 * i;
+        requestParams["y"] = 10 * i;
+        RdkShellClient::instance()->callMethodAsync(method, requestParams, [i](bool success, std::map<std::string, RdkShellData>& /*result*/)
+            {
+                Logger::log(Information, "async setbounds [%d] result - [%d]", i, success);
+            });
+    }
+    requestParams.clear();
+    method = "getBounds";
+    requestParams["client"] = "test_display_async";
+    RdkShellClient::instance()->callMethodAsync(method, requestParams, [](bool success, std::map<std::string, RdkShellData>& result)
+        {
+            Logger::log(Information, "async getbounds result - [%d] response size [%d]", success, result.size());
+            displayResponse(result);
+        });
+    ret = RdkShellClient::instance()->waitForResponses(500000);
+    Logger::log(Information, "async requests completed - [%d] pending [%d]", ret, RdkShellClient::instance()->pendingRequestCount());
+    requestParams.clear();
+    method = "kill";
+    requestParams["client"] = "test_display_async";
+    ret = RdkShellClient::instance()->callMethod(method, requestParams);
+    Logger::log(Information, "callmethod for kill result - [%d]", ret);
+  
     method = "onAnimation";
     RdkShellClient::instance()->unregisterEvent(method, &listener);
     method = "onApiError";
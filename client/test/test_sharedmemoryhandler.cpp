@@ -0,0 +1,276 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <sharedmemoryhandler.h>
+#include <logger.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace RdkShell;
+
+#define TEST_SOCKET_PATH "/tmp/rdkshell_sharedmemory_test"
+// twice the size of a ring, so the positions wrap around while messages are split over its end
+#define WRAP_MESSAGE_COUNT 256
+#define WRAP_MESSAGE_SIZE 8191
+#define WAKEUP_DELAY_MS 200
+#define RING_SIZE (1024*1024)
+
+// mirrors the layout of the region in sharedmemoryhandler.cpp, so the test can write what a broken peer would
+struct TestRing
+{
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) std::atomic<uint32_t> readerWaiting;
+    std::atomic<uint32_t> writerWaiting;
+    alignas(64) char data[RING_SIZE];
+};
+
+struct TestRegion
+{
+    uint32_t magic;
+    uint32_t ringSize;
+    TestRing requests;
+    TestRing responses;
+};
+
+static double monotonicMilliseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000.0) + (now.tv_nsec / 1000000.0);
+}
+
+static std::string testMessage(int index)
+{
+    std::string message = std::to_string(index) + ":";
+    message.append(WRAP_MESSAGE_SIZE + (index % 7), (char)('a' + (index % 26)));
+    return message;
+}
+
+// answers every request with the request itself
+class EchoListener : public RdkShellClientListener
+{
+    public:
+        EchoListener(CommunicationHandler* handler) : mHandler(handler), mDelayNext(false), mReceived(0) {}
+        virtual void onMessageReceived(int id, std::string& message)
+        {
+            mReceived++;
+            if (mDelayNext)
+            {
+                mDelayNext = false;
+                usleep(WAKEUP_DELAY_MS * 1000);
+            }
+            if (message == "delay")
+            {
+                mDelayNext = true;
+                mHandler->completeRequest(id);
+                return;
+            }
+            mHandler->sendMessage(id, message);
+        }
+
+        int received() const
+        {
+            return mReceived;
+        }
+
+    private:
+        CommunicationHandler* mHandler;
+        bool mDelayNext;
+        std::atomic<int> mReceived;
+};
+
+static bool testRingWrap(CommunicationHandler& client)
+{
+    for (int i = 0; i < WRAP_MESSAGE_COUNT; i++)
+    {
+        std::string message = testMessage(i);
+        if (!client.sendMessage(i, message))
+        {
+            Logger::log(Error, "ring wrap: unable to send message %d", i);
+            return false;
+        }
+    }
+    for (int i = 0; i < WRAP_MESSAGE_COUNT; i++)
+    {
+        int id = -1;
+        std::string response;
+        if (!client.receiveMessage(2000000, id, response))
+        {
+            Logger::log(Error, "ring wrap: no response for message %d", i);
+            return false;
+        }
+        if ((id != i) || (response != testMessage(i)))
+        {
+            Logger::log(Error, "ring wrap: response %d does not match message %d", id, i);
+            return false;
+        }
+    }
+    Logger::log(Information, "ring wrap: %d messages of %d bytes echoed", WRAP_MESSAGE_COUNT, WRAP_MESSAGE_SIZE);
+    return true;
+}
+
+/*
+    the server waits up to a second for requests and the client waits up to two seconds for the response,
+    both are only woken up in time by the eventfds
+*/
+static bool testWakeup(CommunicationHandler& client)
+{
+    std::string delay("delay");
+    std::string message("wakeup");
+    double start = monotonicMilliseconds();
+    if (!client.sendMessage(-1, delay) || !client.sendMessage(1000, message))
+    {
+        Logger::log(Error, "wakeup: unable to send messages");
+        return false;
+    }
+    int id = -1;
+    std::string response;
+    bool received = client.receiveMessage(2000000, id, response);
+    double elapsed = monotonicMilliseconds() - start;
+    if (!received || (id != 1000) || (response != message))
+    {
+        Logger::log(Error, "wakeup: no response");
+        return false;
+    }
+    if ((elapsed < WAKEUP_DELAY_MS) || (elapsed > 900))
+    {
+        Logger::log(Error, "wakeup: response took %.1f ms", elapsed);
+        return false;
+    }
+    Logger::log(Information, "wakeup: response after %.1f ms", elapsed);
+    return true;
+}
+
+/*
+    connects without the handler and publishes a tail that leaves less than a header or more than the ring
+    in the request ring, the server has to drop the connection without dispatching anything
+*/
+static bool testCorruptRing(uint32_t used, EchoListener& listener)
+{
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, TEST_SOCKET_PATH, sizeof(address.sun_path) - 1);
+    if ((fd == -1) || (::connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0))
+    {
+        Logger::log(Error, "corrupt ring: unable to connect");
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    uint32_t version = 0;
+    struct iovec vector;
+    vector.iov_base = &version;
+    vector.iov_len = sizeof(version);
+    int descriptors[3];
+    char control[CMSG_SPACE(sizeof(descriptors))];
+    memset(control, 0, sizeof(control));
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    struct cmsghdr* header = (recvmsg(fd, &message, MSG_CMSG_CLOEXEC) == sizeof(version)) ? CMSG_FIRSTHDR(&message) : NULL;
+    if ((NULL == header) || (header->cmsg_len != CMSG_LEN(sizeof(descriptors))))
+    {
+        Logger::log(Error, "corrupt ring: no shared memory received");
+        close(fd);
+        return false;
+    }
+    memcpy(descriptors, CMSG_DATA(header), sizeof(descriptors));
+    TestRegion* region = (TestRegion*)mmap(NULL, sizeof(TestRegion), PROT_READ | PROT_WRITE, MAP_SHARED, descriptors[0], 0);
+    bool closed = false;
+    if (region != MAP_FAILED)
+    {
+        int received = listener.received();
+        region->requests.tail.store(region->requests.head.load() + used);
+        uint64_t count = 1;
+        if (write(descriptors[1], &count, sizeof(count)) != sizeof(count))
+        {
+            Logger::log(Error, "corrupt ring: unable to signal the server");
+        }
+        struct pollfd peer;
+        peer.fd = fd;
+        peer.events = POLLIN;
+        peer.revents = 0;
+        char byte = 0;
+        closed = (poll(&peer, 1, 2000) == 1) && (recv(fd, &byte, sizeof(byte), 0) <= 0) && (listener.received() == received);
+        munmap(region, sizeof(TestRegion));
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        close(descriptors[i]);
+    }
+    close(fd);
+    if (!closed)
+    {
+        Logger::log(Error, "corrupt ring: connection with %u bytes in the ring was not closed", used);
+        return false;
+    }
+    Logger::log(Information, "corrupt ring: connection with %u bytes in the ring closed", used);
+    return true;
+}
+
+int main()
+{
+    std::string path(TEST_SOCKET_PATH);
+    SharedMemoryHandler server(path, true);
+    EchoListener listener(&server);
+    server.setListener(&listener);
+    if (!server.initialize())
+    {
+        Logger::log(Error, "unable to start the shared memory server");
+        return 1;
+    }
+
+    std::atomic<bool> done(false);
+    bool success = false;
+    std::thread clientThread([&]()
+        {
+            std::string clientPath(TEST_SOCKET_PATH);
+            SharedMemoryHandler client(clientPath, false);
+            success = client.initialize() && testRingWrap(client) && testWakeup(client) &&
+                testCorruptRing(5, listener) && testCorruptRing(RING_SIZE + 12, listener);
+            client.terminate();
+            done = true;
+            server.wakeup();
+        });
+    while (!done)
+    {
+        server.process(1);
+    }
+    clientThread.join();
+    server.terminate();
+
+    Logger::log(Information, "shared memory test %s", success ? "passed" : "failed");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#include "binaryprotocol.h"
+#include <string.h>
+#include <stdio.h>
+#include <arpa/inet.h>
+
+namespace RdkShell
+{
+    // method ids are part of the wire format, only append to this table
+    static const char* sBinaryMethods[] =
+    {
+        "",
+        "kill",
+        "createDisplay",
+        "launchApplication",
+        "getBounds",
+        "setBounds",
+        "getScale",
+        "setScale",
+        "addAnimation",
+        "getFrameStats",
+        "getClientStats"
+    };
+    static const uint16_t sBinaryMethodCount = sizeof(sBinaryMethods)/sizeof(sBinaryMethods[0]);
+
+    uint16_t binaryMethodId(const std::string& method)
+    {
+        for (uint16_t methodId = 1; methodId < sBinaryMethodCount; methodId++)
+        {
+            if (method == sBinaryMethods[methodId])
+            {
+                return methodId;
+            }
+        }
+        return 0;
+    }
+
+    const char* binaryMethodName(uint16_t methodId)
+    {
+        if ((methodId == 0) || (methodId >= sBinaryMethodCount))
+        {
+            return NULL;
+        }
+        return sBinaryMethods[methodId];
+    }
+
+    static void appendUnsignedInteger32(uint32_t value, std::string& output)
+    {
+        uint32_t networkValue = htonl(value);
+        output.append((const char*)&networkValue, sizeof(networkValue));
+    }
+
+    static uint32_t readUnsignedInteger32(const char* data)
+    {
+        uint32_t networkValue = 0;
+        memcpy(&networkValue, data, sizeof(networkValue));
+        return ntohl(networkValue);
+    }
+
+    bool isBinaryFrame(const char* data, size_t length)
+    {
+        return (length > 0) && ((uint8_t)data[0] == RDKSHELL_BINARY_FRAME_MAGIC);
+    }
+
+    void writeBinaryFrameHeader(uint16_t methodId, int32_t id, uint32_t length, std::string& header)
+    {
+        uint16_t networkMethodId = htons(methodId);
+        header.clear();
+        header.reserve(RDKSHELL_BINARY_FRAME_HEADER_SIZE);
+        header.push_back((char)RDKSHELL_BINARY_FRAME_MAGIC);
+        header.push_back((char)RDKSHELL_BINARY_PROTOCOL_VERSION);
+        header.append((const char*)&networkMethodId, sizeof(networkMethodId));
+        appendUnsignedInteger32((uint32_t)id, header);
+        appendUnsignedInteger32(length, header);
+    }
+
+    bool readBinaryFrameHeader(const char* data, size_t length, BinaryFrameHeader& header)
+    {
+        if ((length < RDKSHELL_BINARY_FRAME_HEADER_SIZE) || !isBinaryFrame(data, length) ||
+            ((uint8_t)data[1] != RDKSHELL_BINARY_PROTOCOL_VERSION))
+        {
+            return false;
+        }
+        uint16_t networkMethodId = 0;
+        memcpy(&networkMethodId, data + 2, sizeof(networkMethodId));
+        header.methodId = ntohs(networkMethodId);
+        header.id = (int32_t)readUnsignedInteger32(data + 4);
+        header.length = readUnsignedInteger32(data + 8);
+        return true;
+    }
+
+    bool appendBinaryParameter(uint8_t index, char type, RdkShellData& value, std::string& payload)
+    {
+        payload.push_back((char)index);
+        switch (type)
+        {
+            case 'b':
+                payload.push_back((char)BINARY_VALUE_BOOLEAN);
+                payload.push_back(value.toBoolean() ? 1 : 0);
+                break;
+            case 'i':
+                payload.push_back((char)BINARY_VALUE_INTEGER32);
+                appendUnsignedInteger32((uint32_t)value.toInteger32(), payload);
+                break;
+            case 'u':
+                payload.push_back((char)BINARY_VALUE_UNSIGNED_INTEGER32);
+                appendUnsignedInteger32(value.toUnsignedInteger32(), payload);
+                break;
+            case 'f':
+            {
+                double doubleValue = value.toDouble();
+                uint64_t bits = 0;
+                memcpy(&bits, &doubleValue, sizeof(bits));
+                payload.push_back((char)BINARY_VALUE_DOUBLE);
+                appendUnsignedInteger32((uint32_t)(bits >> 32), payload);
+                appendUnsignedInteger32((uint32_t)(bits & 0xFFFFFFFF), payload);
+                break;
+            }
+            case 's':
+            {
+                std::string stringValue = value.toString();
+                payload.push_back((char)BINARY_VALUE_STRING);
+                appendUnsignedInteger32((uint32_t)stringValue.length(), payload);
+                payload.append(stringValue);
+                break;
+            }
+            default:
+                payload.erase(payload.length() - 1);
+                return false;
+        }
+        return true;
+    }
+
+    bool decodeBinaryParameters(const char* data, size_t length, rapidjson::Value& params, rapidjson::Document::AllocatorType& allocator)
+    {
+        params.SetObject();
+        size_t offset = 0;
+        while (offset < length)
+        {
+            if ((length - offset) < 2)
+            {
+                return false;
+            }
+            char key[4];
+            snprintf(key, sizeof(key), "%u", (unsigned int)(uint8_t)data[offset]);
+            uint8_t type = (uint8_t)data[offset + 1];
+            offset += 2;
+
+            rapidjson::Value value;
+            size_t remaining = length - offset;
+            switch (type)
+            {
+                case BINARY_VALUE_BOOLEAN:
+                    if (remaining < 1)
+                    {
+                        return false;
+                    }
+                    value.SetBool(data[offset] != 0);
+                    offset += 1;
+                    break;
+                case BINARY_VALUE_INTEGER32:
+                    if (remaining < 4)
+                    {
+                        return false;
+                    }
+                    value.SetInt((int32_t)readUnsignedInteger32(data + offset));
+                    offset += 4;
+                    break;
+                case BINARY_VALUE_UNSIGNED_INTEGER32:
+                    if (remaining < 4)
+                    {
+                        return false;
+                    }
+                    value.SetUint(readUnsignedInteger32(data + offset));
+                    offset += 4;
+                    break;
+                case BINARY_VALUE_DOUBLE:
+                {
+                    if (remaining < 8)
+                    {
+                        return false;
+                    }
+                    uint64_t bits = ((uint64_t)readUnsignedInteger32(data + offset) << 32) | readUnsignedInteger32(data + offset + 4);
+                    double doubleValue = 0.0;
+                    memcpy(&doubleValue, &bits, sizeof(doubleValue));
+                    value.SetDouble(doubleValue);
+                    offset += 8;
+                    break;
+                }
+                case BINARY_VALUE_STRING:
+                {
+                    if (remaining < 4)
+                    {
+                        return false;
+                    }
+                    uint32_t stringLength = readUnsignedInteger32(data + offset);
+                    if ((remaining - 4) < stringLength)
+                    {
+                        return false;
+                    }
+                    value.SetString(data + offset + 4, stringLength, allocator);
+                    offset += 4 + stringLength;
+                    break;
+                }
+                default:
+                    return false;
+            }
+            params.AddMember(rapidjson::Value(key, allocator).Move(), value, allocator);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef RDKSHELL_BINARY_PROTOCOL_H
+#define RDKSHELL_BINARY_PROTOCOL_H
+
+#include <rdkshelldata.h>
+#include <rapidjson/document.h>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+    binary frames start with a magic byte that can never be the first digit of the ascii length of a json
+    frame, followed by the method id, the request id and the payload length in network byte order.
+    the payload is a list of parameters, each encoded as index, type and value.
+*/
+#define RDKSHELL_BINARY_FRAME_MAGIC 0xB1
+#define RDKSHELL_BINARY_FRAME_HEADER_SIZE 12
+#define RDKSHELL_BINARY_PROTOCOL_VERSION 1
+// set in the method id of a request that wants a response even when the method has no results
+#define RDKSHELL_BINARY_ACKNOWLEDGE_FLAG 0x8000
+
+namespace RdkShell
+{
+    enum BinaryValueType
+    {
+        BINARY_VALUE_BOOLEAN = 1,
+        BINARY_VALUE_INTEGER32 = 2,
+        BINARY_VALUE_UNSIGNED_INTEGER32 = 3,
+        BINARY_VALUE_DOUBLE = 4,
+        BINARY_VALUE_STRING = 5
+    };
+
+    struct BinaryFrameHeader
+    {
+        uint16_t methodId;
+        int32_t id;
+        uint32_t length;
+    };
+
+    // returns 0 for methods that are only available as json
+    uint16_t binaryMethodId(const std::string& method);
+    const char* binaryMethodName(uint16_t methodId);
+
+    bool isBinaryFrame(const char* data, size_t length);
+    void writeBinaryFrameHeader(uint16_t methodId, int32_t id, uint32_t length, std::string& header);
+    bool readBinaryFrameHeader(const char* data, size_t length, BinaryFrameHeader& header);
+
+    // type uses the client parameter type characters: b, i, u, f and s
+    bool appendBinaryParameter(uint8_t index, char type, RdkShellData& value, std::string& payload);
+    // decodes the parameters into a json object keyed by parameter index, as sent by json clients
+    bool decodeBinaryParameters(const char* data, size_t length, rapidjson::Value& params, rapidjson::Document::AllocatorType& allocator);
+}
+
+#endif //RDKSHELL_BINARY_PROTOCOL_H
@@ -1,13 +1,29 @@
 #include "communicationfactory.h"
 #include "sockethandler.h"
+#include "sharedmemoryhandler.h"
+#include <string.h>
 
 namespace RdkShell
 {
     #define RDKSHELL_SERVER_ADDRESS "localhost"
     #define RDKSHELL_SERVER_PORT 9996
+    #define RDKSHELL_SHARED_MEMORY_SOCKET "/tmp/rdkshell_ipc"
   
     CommunicationHandler* createCommunicationHandler(bool isServer)
     {
+        // clients on the same device can use shared memory instead of the tcp socket, server and clients must agree
+        char const *transportEnvironmentValue = getenv("RDKSHELL_IPC_TRANSPORT");
+        if (transportEnvironmentValue && (strcmp(transportEnvironmentValue, "sharedmemory") == 0))
+        {
+            std::string path = RDKSHELL_SHARED_MEMORY_SOCKET;
+            char const *pathEnvironmentValue = getenv("RDKSHELL_SHARED_MEMORY_SOCKET");
+            if (pathEnvironmentValue)
+            {
+                path = pathEnvironmentValue;
+            }
+            return new SharedMemoryHandler(path, isServer);
+        }
+
         std::string address = RDKSHELL_SERVER_ADDRESS;
         int port = RDKSHELL_SERVER_PORT;
         char const *addressEnvironmentValue = getenv("RDKSHELL_SERVER_ADDRESS");
@@ -2,6 +2,7 @@
 #define RDKSHELL_COMMUNICATION_HANDLER_H
 
 #include <string>
+#include <stdint.h>
 
 namespace RdkShell
 {
@@ -9,6 +10,7 @@ namespace RdkShell
     {
         public:
             virtual void onMessageReceived(int id, std::string& message) = 0;
+            virtual void onBinaryMessageReceived(int /*id*/, uint16_t /*methodId*/, std::string& /*payload*/) {}
     };
   
     class CommunicationHandler
@@ -17,9 +19,21 @@ namespace RdkShell
             virtual bool initialize() = 0;
             virtual void terminate() = 0;
             virtual bool sendMessage(int id, std::string& message) = 0;
+            virtual bool sendBinaryMessage(int id, uint16_t methodId, std::string& payload) = 0;
             virtual bool process(int wait=0, std::string* message=nullptr) = 0;
-            virtual void sendEvent(std::string& event) = 0;
+            // client side: waits up to the timeout for the next message and the id it answers, -1 for events
+            virtual bool receiveMessage(int64_t timeoutInMicroseconds, int& id, std::string& message) = 0;
+            // eventId is the index from findIpcEvent, events with -1 go to every connection
+            virtual void sendEvent(int eventId, std::string& event) = 0;
+            // server side: changes the event subscriptions of the connection that sent the request id
+            virtual bool subscribeEvent(int id, int eventId, bool subscribe) = 0;
+            // server side: forgets a request that is not going to be answered
+            virtual void completeRequest(int id) = 0;
             virtual void setListener(RdkShellClientListener* listener) = 0;
+            // makes a process() call that is waiting for data on another thread return early
+            virtual void wakeup() = 0;
+            // server side: stops reading requests until resumed, the clients are left to fill their socket or ring
+            virtual void pauseRequests(bool pause) = 0;
     };
 }
 #endif //RDKSHELL_COMMUNICATION_HANDLER_H
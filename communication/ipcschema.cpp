@@ -0,0 +1,181 @@
+#include "ipcschema.h"
+#include <string.h>
+
+namespace RdkShell
+{
+    static const IpcMethodSchema sIpcMethodSchemas[] =
+    {
+        // protocol
+        { "negotiateProtocol", { {"protocol", 's', true} }, { {"protocol", 's'}, {"version", 'u'} }, false },
+        { "subscribeEvent", { {"event", 's', true} }, {}, false },
+        { "unsubscribeEvent", { {"event", 's', true} }, {}, false },
+
+        // application lifecycle
+        { "createDisplay", { {"client", 's', true}, {"displayName", 's', false}, {"displayWidth", 'u', false}, {"displayHeight", 'u', false},
+            {"virtualDisplay", 'b', false}, {"virtualWidth", 'u', false}, {"virtualHeight", 'u', false}, {"topmost", 'b', false},
+            {"focus", 'b', false}, {"autodestroy", 'b', false} }, {}, false },
+        { "launchApplication", { {"client", 's', true}, {"uri", 's', true}, {"mime", 's', true}, {"topmost", 'b', false}, {"focus", 'b', false} }, {}, false },
+        { "suspendApplication", { {"client", 's', true} }, {}, false },
+        { "resumeApplication", { {"client", 's', true} }, {}, false },
+        { "closeApplication", { {"client", 's', true} }, {}, false },
+        { "kill", { {"client", 's', true} }, {}, false },
+        { "getClients", {}, { {"clients", 'a'} }, true },
+        { "getClientInfo", { {"client", 's', true} }, { {"x", 'i'}, {"y", 'i'}, {"width", 'u'}, {"height", 'u'}, {"sx", 'f'}, {"sy", 'f'},
+            {"opacity", 'f'}, {"zorder", 'i'}, {"visible", 'b'} }, false },
+        { "getMimeType", { {"client", 's', true} }, { {"mimeType", 's'} }, false },
+        { "setMimeType", { {"client", 's', true}, {"mimeType", 's', true} }, {}, false },
+
+        // z-order and focus
+        { "getZOrder", {}, { {"clients", 'a'} }, true },
+        { "moveToFront", { {"client", 's', true} }, {}, false },
+        { "moveToBack", { {"client", 's', true} }, {}, false },
+        { "moveBehind", { {"client", 's', true}, {"target", 's', true} }, {}, false },
+        { "setFocus", { {"client", 's', true} }, {}, false },
+        { "getFocused", {}, { {"client", 's'} }, false },
+        { "setTopmost", { {"client", 's', true}, {"topmost", 'b', true}, {"focus", 'b', false} }, {}, false },
+        { "getTopmost", {}, { {"client", 's'} }, false },
+
+        // geometry and appearance
+        { "getBounds", { {"client", 's', true} }, { {"x", 'u'}, {"y", 'u'}, {"w", 'u'}, {"h", 'u'} }, false },
+        { "setBounds", { {"client", 's', true}, {"x", 'u', false}, {"y", 'u', false}, {"w", 'u', false}, {"h", 'u', false} }, {}, false },
+        { "getScale", { {"client", 's', true} }, { {"sx", 'f'}, {"sy", 'f'} }, false },
+        { "setScale", { {"client", 's', true}, {"sx", 'f', false}, {"sy", 'f', false} }, {}, false },
+        { "scaleToFit", { {"client", 's', true}, {"x", 'i', true}, {"y", 'i', true}, {"w", 'u', true}, {"h", 'u', true} }, {}, false },
+        { "getVisibility", { {"client", 's', true} }, { {"visible", 'b'} }, false },
+        { "setVisibility", { {"client", 's', true}, {"visible", 'b', true} }, {}, false },
+        { "getOpacity", { {"client", 's', true} }, { {"opacity", 'u'} }, false },
+        { "setOpacity", { {"client", 's', true}, {"opacity", 'u', true} }, {}, false },
+        { "getHolePunch", { {"client", 's', true} }, { {"holePunch", 'b'} }, false },
+        { "setHolePunch", { {"client", 's', true}, {"holePunch", 'b', true} }, {}, false },
+        { "getOpaque", { {"client", 's', true} }, { {"opaque", 'b'} }, false },
+        { "setOpaque", { {"client", 's', true}, {"opaque", 'b', true} }, {}, false },
+        { "addAnimation", { {"client", 's', true}, {"duration", 'f', true}, {"x", 'i', false}, {"y", 'i', false}, {"w", 'u', false},
+            {"h", 'u', false}, {"sx", 'f', false}, {"sy", 'f', false} }, {}, false },
+        { "removeAnimation", { {"client", 's', true} }, {}, false },
+        { "applyBatch", { {"operations", 'a', true} }, {}, false },
+
+        // screen and virtual displays
+        { "getScreenResolution", {}, { {"width", 'u'}, {"height", 'u'} }, false },
+        { "setScreenResolution", { {"w", 'u', true}, {"h", 'u', true} }, {}, false },
+        { "getVirtualResolution", { {"client", 's', true} }, { {"width", 'u'}, {"height", 'u'} }, false },
+        { "setVirtualResolution", { {"client", 's', true}, {"width", 'u', true}, {"height", 'u', true} }, {}, false },
+        { "enableVirtualDisplay", { {"client", 's', true}, {"enable", 'b', true} }, {}, false },
+        { "getVirtualDisplayEnabled", { {"client", 's', true} }, { {"enabled", 'b'} }, false },
+
+        // keys and input
+        { "addKeyIntercept", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false} }, {}, false },
+        { "setKeyIntercept", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false}, {"always", 'b', false} }, {}, false },
+        { "removeKeyIntercept", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false} }, {}, false },
+        { "removeAllKeyIntercepts", {}, {}, false },
+        { "addKeyListener", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false}, {"activate", 'b', false},
+            {"propagate", 'b', false} }, {}, false },
+        { "removeKeyListener", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false} }, {}, false },
+        { "addNativeKeyListener", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false}, {"activate", 'b', false},
+            {"propagate", 'b', false} }, {}, false },
+        { "removeNativeKeyListener", { {"client", 's', true}, {"keyCode", 'u', true}, {"modifiers", 'm', false} }, {}, false },
+        { "removeAllKeyListeners", {}, {}, false },
+        { "addKeyMetadataListener", { {"client", 's', true} }, {}, false },
+        { "removeKeyMetadataListener", { {"client", 's', true} }, {}, false },
+        { "injectKey", { {"keyCode", 'u', true}, {"modifiers", 'm', false} }, {}, false },
+        { "generateKey", { {"client", 's', true}, {"keyCode", 'u', false}, {"modifiers", 'm', false}, {"virtualKey", 's', false},
+            {"duration", 'f', false} }, {}, false },
+        { "getLastKeyPress", {}, { {"keyCode", 'u'}, {"modifiers", 'u'}, {"timestampInSeconds", 'u'} }, false },
+        { "ignoreKeyInputs", { {"ignore", 'b', true} }, {}, false },
+        { "enableKeyRepeats", { {"enable", 'b', true} }, {}, false },
+        { "getKeyRepeatsEnabled", {}, { {"enabled", 'b'} }, false },
+        { "setKeyRepeatConfig", { {"enabled", 'b', true}, {"initialDelay", 'i', true}, {"repeatInterval", 'i', true} }, {}, false },
+        { "enableInputEvents", { {"client", 's', true}, {"enable", 'b', true} }, {}, false },
+        { "showCursor", {}, {}, false },
+        { "hideCursor", {}, {}, false },
+        { "setCursorSize", { {"width", 'u', true}, {"height", 'u', true} }, {}, false },
+        { "getCursorSize", {}, { {"width", 'u'}, {"height", 'u'} }, false },
+
+        // splash screen, watermark and full screen images
+        { "showSplashScreen", { {"displayTime", 'u', false} }, {}, false },
+        { "hideSplashScreen", {}, {}, false },
+        { "showWatermark", {}, {}, false },
+        { "hideWatermark", {}, {}, false },
+        { "showFullScreenImage", { {"file", 's', true} }, {}, false },
+        { "hideFullScreenImage", {}, {}, false },
+        { "createWatermarkImage", { {"imageId", 'u', true}, {"zorder", 'u', false} }, {}, false },
+        { "updateWatermarkImage", { {"imageId", 'u', true}, {"key", 'i', true}, {"imageSize", 'i', true} }, {}, false },
+        { "adjustWatermarkImage", { {"imageId", 'u', true}, {"zorder", 'u', true} }, {}, false },
+        { "deleteWatermarkImage", { {"imageId", 'u', true} }, {}, false },
+        { "alwaysShowWatermarkImageOnTop", { {"show", 'b', true} }, {}, false },
+
+        // inactivity, av blocking and diagnostics
+        { "enableInactivityReporting", { {"enable", 'b', true} }, {}, false },
+        { "setInactivityInterval", { {"interval", 'f', true} }, {}, false },
+        { "resetInactivityTime", {}, {}, false },
+        { "getInactivityTime", {}, { {"minutes", 'f'} }, false },
+        { "setAVBlocked", { {"callsign", 's', true}, {"blockAV", 'b', true} }, {}, false },
+        { "getBlockedAVApplications", {}, { {"applications", 'a'} }, false },
+        { "setLogLevel", { {"level", 's', true} }, {}, false },
+        { "getLogLevel", {}, { {"level", 's'} }, false },
+        { "getFrameStats", {}, { {"stats", 'o'} }, true },
+        { "getClientStats", {}, { {"clients", 'a'} }, false },
+        { "getTextureCacheStats", {}, { {"stats", 'o'} }, true },
+        { "startTrace", { {"duration", 'f', false} }, {}, false },
+        { "stopTrace", {}, { {"file", 's'} }, false }
+    };
+    static const size_t sIpcMethodSchemaCount = sizeof(sIpcMethodSchemas)/sizeof(sIpcMethodSchemas[0]);
+
+    static const char* const sIpcEvents[] =
+    {
+        "onAnimation", // first, see RDKSHELL_IPC_DEFAULT_EVENT_MASK
+        "onSizeChangeComplete",
+        "onUserInactive"
+    };
+    static const size_t sIpcEventCount = sizeof(sIpcEvents)/sizeof(sIpcEvents[0]);
+    static_assert(sIpcEventCount <= RDKSHELL_IPC_MAX_EVENTS, "too many ipc events for the subscription mask");
+
+    const IpcMethodSchema* ipcMethodSchemas(size_t& count)
+    {
+        count = sIpcMethodSchemaCount;
+        return sIpcMethodSchemas;
+    }
+
+    const IpcMethodSchema* findIpcMethodSchema(const char* name)
+    {
+        for (size_t i = 0; i < sIpcMethodSchemaCount; i++)
+        {
+            if (strcmp(sIpcMethodSchemas[i].name, name) == 0)
+            {
+                return &sIpcMethodSchemas[i];
+            }
+        }
+        return NULL;
+    }
+
+    size_t ipcParameterCount(const IpcMethodSchema& schema)
+    {
+        size_t count = 0;
+        while ((count < RDKSHELL_IPC_MAX_PARAMETERS) && (NULL != schema.parameters[count].name))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    size_t ipcResultCount(const IpcMethodSchema& schema)
+    {
+        size_t count = 0;
+        while ((count < RDKSHELL_IPC_MAX_RESULTS) && (NULL != schema.results[count].name))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    int findIpcEvent(const char* name)
+    {
+        for (size_t i = 0; i < sIpcEventCount; i++)
+        {
+            if (strcmp(sIpcEvents[i], name) == 0)
+            {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+}
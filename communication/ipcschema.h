@@ -0,0 +1,49 @@
+#ifndef RDKSHELL_IPC_SCHEMA_H
+#define RDKSHELL_IPC_SCHEMA_H
+
+#include <stddef.h>
+
+#define RDKSHELL_IPC_MAX_PARAMETERS 10
+#define RDKSHELL_IPC_MAX_RESULTS 10
+#define RDKSHELL_IPC_MAX_EVENTS 32
+// events of connections that never subscribed, onAnimation was the only event earlier servers sent
+#define RDKSHELL_IPC_DEFAULT_EVENT_MASK 0x1
+
+/*
+    the ipc method schema is shared by the server and the client library. parameter types use the client
+    parameter type characters: b, i, u, f and s, plus m for key modifiers (flags or an array of modifier
+    names), a for arrays and o for objects. socket requests pass parameters by their position in the schema,
+    websocket requests by name.
+*/
+namespace RdkShell
+{
+    struct IpcParameterSchema
+    {
+        const char* name;
+        char type;
+        bool mandatory;
+    };
+
+    struct IpcResultSchema
+    {
+        const char* name;
+        char type;
+    };
+
+    struct IpcMethodSchema
+    {
+        const char* name;
+        IpcParameterSchema parameters[RDKSHELL_IPC_MAX_PARAMETERS]; // terminated by an entry without a name
+        IpcResultSchema results[RDKSHELL_IPC_MAX_RESULTS]; // a method without results only responds on failure
+        bool resultIsValue; // websocket responses carry the single result as the params value
+    };
+
+    const IpcMethodSchema* ipcMethodSchemas(size_t& count);
+    const IpcMethodSchema* findIpcMethodSchema(const char* name);
+    size_t ipcParameterCount(const IpcMethodSchema& schema);
+    size_t ipcResultCount(const IpcMethodSchema& schema);
+    // the index of an event is its bit in the subscription mask of a connection, -1 for events ipc clients never get
+    int findIpcEvent(const char* name);
+}
+
+#endif //RDKSHELL_IPC_SCHEMA_H
@@ -0,0 +1,920 @@
+#include "sharedmemoryhandler.h"
+#include "logger.h"
+#include <atomic>
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+namespace RdkShell
+{
+    #define SHARED_MEMORY_MAGIC 0x52534d31
+    #define SHARED_MEMORY_VERSION 1
+    #define SHARED_MEMORY_RING_SIZE (1024*1024)
+    #define SHARED_MEMORY_MESSAGE_HEADER_SIZE 12
+    #define SHARED_MEMORY_DESCRIPTOR_COUNT 3
+    #define MAX_MESSAGES_PER_PROCESS 256
+    #define MAX_PENDING_WRITE_SIZE (4*1024*1024)
+    #define MAX_EPOLL_EVENTS 16
+
+    static_assert((SHARED_MEMORY_RING_SIZE & (SHARED_MEMORY_RING_SIZE - 1)) == 0, "the ring size must be a power of two");
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "the rings need lock free atomics to be shared between processes");
+
+    /*
+        the positions are free running counters, the producer only writes tail and the consumer only writes head.
+        a side sets readerWaiting or writerWaiting before it sleeps and the other side signals the eventfd only
+        when it clears one of them, so a busy connection exchanges messages without any system call.
+    */
+    struct SharedMemoryRing
+    {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        alignas(64) std::atomic<uint32_t> readerWaiting;
+        std::atomic<uint32_t> writerWaiting;
+        alignas(64) char data[SHARED_MEMORY_RING_SIZE];
+    };
+
+    struct SharedMemoryRegion
+    {
+        uint32_t magic;
+        uint32_t ringSize;
+        SharedMemoryRing requests; // client to server
+        SharedMemoryRing responses; // server to client, responses and events
+    };
+
+    static void copyToRing(SharedMemoryRing& ring, uint32_t position, const char* data, size_t length)
+    {
+        size_t offset = position & (SHARED_MEMORY_RING_SIZE - 1);
+        size_t firstPart = std::min(length, (size_t)SHARED_MEMORY_RING_SIZE - offset);
+        memcpy(ring.data + offset, data, firstPart);
+        memcpy(ring.data, data + firstPart, length - firstPart);
+    }
+
+    static void copyFromRing(SharedMemoryRing& ring, uint32_t position, char* data, size_t length)
+    {
+        size_t offset = position & (SHARED_MEMORY_RING_SIZE - 1);
+        size_t firstPart = std::min(length, (size_t)SHARED_MEMORY_RING_SIZE - offset);
+        memcpy(data, ring.data + offset, firstPart);
+        memcpy(data + firstPart, ring.data, length - firstPart);
+    }
+
+    static void signalEvent(int fd)
+    {
+        uint64_t count = 1;
+        if ((fd != -1) && (write(fd, &count, sizeof(count)) == -1) && (errno != EAGAIN))
+        {
+            Logger::log(Warn, "unable to signal event - [%s]", strerror(errno));
+        }
+    }
+
+    static void clearEvent(int fd)
+    {
+        uint64_t count = 0;
+        if ((read(fd, &count, sizeof(count)) == -1) && (errno != EAGAIN))
+        {
+            Logger::log(Warn, "unable to clear event - [%s]", strerror(errno));
+        }
+    }
+
+    static int64_t monotonicMicroseconds()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+    }
+
+    SharedMemoryHandler::SharedMemoryHandler(std::string& path, bool isServer): mActive(false), mPath(path), mIsServer(isServer),
+        mFd(-1), mEpollFd(-1), mWakeupFd(-1), mConnection(), mClients(), mClientsByWaitFd(), mClientsToRemove(), mActiveRequests(),
+        mMessageId(0), mListener(NULL), mRequestsPaused(false)
+    {
+    }
+
+    SharedMemoryHandler::~SharedMemoryHandler()
+    {
+        terminate();
+    }
+
+    bool SharedMemoryHandler::initialize()
+    {
+        terminate();
+        mWakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (mWakeupFd == -1)
+        {
+            Logger::log(Fatal, "Failed to create wakeup event - [%s]", strerror(errno));
+            return false;
+        }
+        if (mPath.length() >= sizeof(((struct sockaddr_un*)NULL)->sun_path))
+        {
+            Logger::log(Fatal, "shared memory socket path %s is too long", mPath.c_str());
+            return false;
+        }
+        mFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (mFd == -1)
+        {
+            Logger::log(Fatal, "Failed to create socket - [%s]", strerror(errno));
+            return false;
+        }
+        bool ret = mIsServer ? initializeServer() : initializeClient();
+        mActive = ret;
+        return ret;
+    }
+
+    bool SharedMemoryHandler::initializeServer()
+    {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, mPath.c_str(), sizeof(address.sun_path) - 1);
+        unlink(mPath.c_str());
+        if (bind(mFd, (struct sockaddr *)&address, sizeof(address)) == -1)
+        {
+            Logger::log(Fatal, "Failed to bind %s - [%s]", mPath.c_str(), strerror(errno));
+            return false;
+        }
+        if (listen(mFd, 4) == -1)
+        {
+            Logger::log(Fatal, "Failed to listen - [%s]", strerror(errno));
+            return false;
+        }
+
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFd == -1)
+        {
+            Logger::log(Fatal, "Failed to create epoll instance - [%s]", strerror(errno));
+            return false;
+        }
+        int descriptors[] = { mFd, mWakeupFd };
+        for (size_t i = 0; i < sizeof(descriptors)/sizeof(descriptors[0]); i++)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = descriptors[i];
+            if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, descriptors[i], &event) == -1)
+            {
+                Logger::log(Fatal, "Failed to watch descriptor - [%s]", strerror(errno));
+                return false;
+            }
+        }
+        int flags = fcntl(mFd, F_GETFL);
+        fcntl(mFd, F_SETFL, flags | O_NONBLOCK);
+        return true;
+    }
+
+    bool SharedMemoryHandler::initializeClient()
+    {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, mPath.c_str(), sizeof(address.sun_path) - 1);
+        bool connected = false;
+        for (int retry = 0; retry <= 2; retry++)
+        {
+            if (::connect(mFd, (struct sockaddr *)&address, sizeof(address)) == 0)
+            {
+                connected = true;
+                break;
+            }
+            Logger::log(Error, "Error while connecting to [%s] - [%s]", mPath.c_str(), strerror(errno));
+            sleep(1);
+        }
+        if (!connected)
+        {
+            return false;
+        }
+
+        // the server answers the connection with the shared memory and the two eventfds
+        uint32_t version = 0;
+        struct iovec vector;
+        vector.iov_base = &version;
+        vector.iov_len = sizeof(version);
+        char control[CMSG_SPACE(sizeof(int) * SHARED_MEMORY_DESCRIPTOR_COUNT)];
+        memset(control, 0, sizeof(control));
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t bytesRead = recvmsg(mFd, &message, MSG_CMSG_CLOEXEC);
+        struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if ((bytesRead != sizeof(version)) || (NULL == header) || (header->cmsg_level != SOL_SOCKET) || (header->cmsg_type != SCM_RIGHTS) ||
+            (header->cmsg_len != CMSG_LEN(sizeof(int) * SHARED_MEMORY_DESCRIPTOR_COUNT)))
+        {
+            Logger::log(Fatal, "unable to receive the shared memory from the server");
+            return false;
+        }
+        int descriptors[SHARED_MEMORY_DESCRIPTOR_COUNT];
+        memcpy(descriptors, CMSG_DATA(header), sizeof(descriptors));
+        mConnection = SharedMemoryConnection();
+        mConnection.controlFd = mFd;
+        mConnection.signalFd = descriptors[1];
+        mConnection.waitFd = descriptors[2];
+        bool mapped = (version == SHARED_MEMORY_VERSION) && mapRegion(mConnection, descriptors[0], false);
+        close(descriptors[0]);
+        if (!mapped)
+        {
+            Logger::log(Fatal, "unsupported shared memory from the server");
+            return false;
+        }
+        int flags = fcntl(mFd, F_GETFL);
+        fcntl(mFd, F_SETFL, flags | O_NONBLOCK);
+        return true;
+    }
+
+    void SharedMemoryHandler::terminate()
+    {
+        for (auto& client : mClients)
+        {
+            mClientsToRemove.push_back(client.first);
+        }
+        removeInactiveClients();
+        mActiveRequests.clear();
+        if (NULL != mConnection.region)
+        {
+            munmap(mConnection.region, sizeof(SharedMemoryRegion));
+        }
+        if (mConnection.waitFd != -1)
+        {
+            close(mConnection.waitFd);
+        }
+        if (mConnection.signalFd != -1)
+        {
+            close(mConnection.signalFd);
+        }
+        mConnection = SharedMemoryConnection();
+
+        if (mFd != -1)
+        {
+            close(mFd);
+            if (mIsServer)
+            {
+                unlink(mPath.c_str());
+            }
+        }
+        mFd = -1;
+        if (mEpollFd != -1)
+        {
+            close(mEpollFd);
+        }
+        mEpollFd = -1;
+        if (mWakeupFd != -1)
+        {
+            close(mWakeupFd);
+        }
+        mWakeupFd = -1;
+        mActive = false;
+    }
+
+    /*
+        createRegion sets up the shared memory and eventfds of a new client. the memory is sealed so the client
+        cannot shrink it and make the server fault on its mapping.
+    */
+    bool SharedMemoryHandler::createRegion(SharedMemoryConnection& connection, int& memoryFd, int& peerWaitFd)
+    {
+        memoryFd = memfd_create("rdkshell-ipc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (memoryFd == -1)
+        {
+            Logger::log(Error, "unable to create shared memory - [%s]", strerror(errno));
+            return false;
+        }
+        if ((ftruncate(memoryFd, sizeof(SharedMemoryRegion)) == -1) ||
+            (fcntl(memoryFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) || !mapRegion(connection, memoryFd, true))
+        {
+            Logger::log(Error, "unable to set up shared memory - [%s]", strerror(errno));
+            return false;
+        }
+        connection.waitFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        peerWaitFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        connection.signalFd = peerWaitFd;
+        if ((connection.waitFd == -1) || (peerWaitFd == -1))
+        {
+            Logger::log(Error, "unable to create shared memory events - [%s]", strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    // memory the server just created is initialized, memory received from the server is checked
+    bool SharedMemoryHandler::mapRegion(SharedMemoryConnection& connection, int memoryFd, bool create)
+    {
+        if (!create)
+        {
+            struct stat info;
+            if ((fstat(memoryFd, &info) == -1) || (info.st_size < (off_t)sizeof(SharedMemoryRegion)))
+            {
+                return false;
+            }
+        }
+        void* memory = mmap(NULL, sizeof(SharedMemoryRegion), PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+        SharedMemoryRegion* region = (SharedMemoryRegion*)memory;
+        if (create)
+        {
+            // the memory starts zeroed, which is the empty state of both rings
+            region->magic = SHARED_MEMORY_MAGIC;
+            region->ringSize = SHARED_MEMORY_RING_SIZE;
+        }
+        else if ((region->magic != SHARED_MEMORY_MAGIC) || (region->ringSize != SHARED_MEMORY_RING_SIZE))
+        {
+            munmap(memory, sizeof(SharedMemoryRegion));
+            return false;
+        }
+        connection.region = region;
+        return true;
+    }
+
+    SharedMemoryRing& SharedMemoryHandler::incomingRing(SharedMemoryConnection& connection)
+    {
+        return mIsServer ? connection.region->requests : connection.region->responses;
+    }
+
+    SharedMemoryRing& SharedMemoryHandler::outgoingRing(SharedMemoryConnection& connection)
+    {
+        return mIsServer ? connection.region->responses : connection.region->requests;
+    }
+
+    void SharedMemoryHandler::acceptClients()
+    {
+        while (true)
+        {
+            int fd = accept4(mFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+                {
+                    Logger::log(Error, "accept: error - [%s]", strerror(errno));
+                }
+                return;
+            }
+
+            SharedMemoryConnection client;
+            client.controlFd = fd;
+            int memoryFd = -1, peerWaitFd = -1;
+            bool ret = createRegion(client, memoryFd, peerWaitFd);
+            if (ret)
+            {
+                uint32_t version = SHARED_MEMORY_VERSION;
+                struct iovec vector;
+                vector.iov_base = &version;
+                vector.iov_len = sizeof(version);
+                int descriptors[SHARED_MEMORY_DESCRIPTOR_COUNT] = { memoryFd, client.waitFd, peerWaitFd };
+                char control[CMSG_SPACE(sizeof(descriptors))];
+                memset(control, 0, sizeof(control));
+                struct msghdr message;
+                memset(&message, 0, sizeof(message));
+                message.msg_iov = &vector;
+                message.msg_iovlen = 1;
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+                struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+                header->cmsg_level = SOL_SOCKET;
+                header->cmsg_type = SCM_RIGHTS;
+                header->cmsg_len = CMSG_LEN(sizeof(descriptors));
+                memcpy(CMSG_DATA(header), descriptors, sizeof(descriptors));
+                ret = (sendmsg(fd, &message, MSG_NOSIGNAL) == sizeof(version));
+                if (!ret)
+                {
+                    Logger::log(Error, "unable to pass shared memory to client [%d] - [%s]", fd, strerror(errno));
+                }
+            }
+            if (memoryFd != -1)
+            {
+                close(memoryFd);
+            }
+
+            int watchedDescriptors[] = { fd, client.waitFd };
+            for (size_t i = 0; ret && (i < sizeof(watchedDescriptors)/sizeof(watchedDescriptors[0])); i++)
+            {
+                struct epoll_event event;
+                memset(&event, 0, sizeof(event));
+                event.events = EPOLLIN;
+                event.data.fd = watchedDescriptors[i];
+                ret = (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, watchedDescriptors[i], &event) == 0);
+            }
+            mClients[fd] = client;
+            if (client.waitFd != -1)
+            {
+                mClientsByWaitFd[client.waitFd] = fd;
+            }
+            if (!ret)
+            {
+                Logger::log(Error, "unable to watch client [%d]", fd);
+                mClientsToRemove.push_back(fd);
+            }
+        }
+    }
+
+    bool SharedMemoryHandler::queueMessage(SharedMemoryConnection& connection, int id, uint16_t methodId, const std::string& message)
+    {
+        if (NULL == connection.region)
+        {
+            return false;
+        }
+        if (message.length() > SHARED_MEMORY_RING_SIZE - SHARED_MEMORY_MESSAGE_HEADER_SIZE)
+        {
+            Logger::log(Error, "message of %u bytes does not fit into the shared memory", (unsigned int)message.length());
+            return false;
+        }
+        if (connection.pendingWriteBytes + message.length() > MAX_PENDING_WRITE_SIZE)
+        {
+            Logger::log(Error, "peer is not reading its messages and removing it");
+            closeConnection(connection);
+            return false;
+        }
+        SharedMemoryMessage queuedMessage;
+        queuedMessage.id = id;
+        queuedMessage.methodId = methodId;
+        queuedMessage.data = message;
+        connection.writeQueue.push_back(std::move(queuedMessage));
+        connection.pendingWriteBytes += message.length();
+        return flushWriteQueue(connection);
+    }
+
+    /*
+        flushWriteQueue moves queued messages into the ring while they fit. when the ring is full the consumer
+        is asked to signal once it made room, and the queue is retried once the flag is set so a consumer that
+        emptied the ring in the meantime is not missed.
+    */
+    bool SharedMemoryHandler::flushWriteQueue(SharedMemoryConnection& connection)
+    {
+        if ((NULL == connection.region) || connection.writeQueue.empty())
+        {
+            return true;
+        }
+        SharedMemoryRing& ring = outgoingRing(connection);
+        bool written = false;
+        bool waitingForSpace = false;
+        while (!connection.writeQueue.empty())
+        {
+            SharedMemoryMessage& message = connection.writeQueue.front();
+            uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+            uint32_t used = tail - ring.head.load(std::memory_order_acquire);
+            size_t messageSize = SHARED_MEMORY_MESSAGE_HEADER_SIZE + message.data.length();
+            if (used > SHARED_MEMORY_RING_SIZE)
+            {
+                Logger::log(Error, "shared memory ring is corrupted and removing peer");
+                closeConnection(connection);
+                return false;
+            }
+            if (messageSize > (SHARED_MEMORY_RING_SIZE - used))
+            {
+                if (waitingForSpace)
+                {
+                    break;
+                }
+                ring.writerWaiting.store(1, std::memory_order_seq_cst);
+                waitingForSpace = true;
+                continue;
+            }
+
+            char header[SHARED_MEMORY_MESSAGE_HEADER_SIZE];
+            uint32_t length = (uint32_t)message.data.length();
+            int32_t id = message.id;
+            uint16_t reserved = 0;
+            memcpy(header, &length, sizeof(length));
+            memcpy(header + 4, &id, sizeof(id));
+            memcpy(header + 8, &message.methodId, sizeof(message.methodId));
+            memcpy(header + 10, &reserved, sizeof(reserved));
+            copyToRing(ring, tail, header, SHARED_MEMORY_MESSAGE_HEADER_SIZE);
+            copyToRing(ring, tail + SHARED_MEMORY_MESSAGE_HEADER_SIZE, message.data.data(), message.data.length());
+            ring.tail.store(tail + (uint32_t)messageSize, std::memory_order_seq_cst);
+            connection.pendingWriteBytes -= message.data.length();
+            connection.writeQueue.pop_front();
+            written = true;
+        }
+        if (written && ring.readerWaiting.exchange(0, std::memory_order_seq_cst))
+        {
+            signalEvent(connection.signalFd);
+        }
+        return true;
+    }
+
+    /*
+        nextMessage takes the next message out of the incoming ring. the peer is not trusted, a ring whose
+        positions or lengths do not add up closes the connection.
+    */
+    bool SharedMemoryHandler::nextMessage(SharedMemoryConnection& connection, int& id, uint16_t& methodId, std::string& message)
+    {
+        if (NULL == connection.region)
+        {
+            return false;
+        }
+        SharedMemoryRing& ring = incomingRing(connection);
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        uint32_t used = ring.tail.load(std::memory_order_acquire) - head;
+        if (used == 0)
+        {
+            return false;
+        }
+        // the writer only publishes whole messages, so less than a header or more than the ring is corrupt
+        if ((used < SHARED_MEMORY_MESSAGE_HEADER_SIZE) || (used > SHARED_MEMORY_RING_SIZE))
+        {
+            Logger::log(Error, "received corrupted shared memory ring and removing peer");
+            closeConnection(connection);
+            return false;
+        }
+        char header[SHARED_MEMORY_MESSAGE_HEADER_SIZE];
+        uint32_t length = 0;
+        copyFromRing(ring, head, header, SHARED_MEMORY_MESSAGE_HEADER_SIZE);
+        memcpy(&length, header, sizeof(length));
+        if (length > used - SHARED_MEMORY_MESSAGE_HEADER_SIZE)
+        {
+            Logger::log(Error, "received corrupted shared memory message and removing peer");
+            ring.head.store(head + used, std::memory_order_seq_cst);
+            closeConnection(connection);
+            return false;
+        }
+        int32_t messageId = -1;
+        memcpy(&messageId, header + 4, sizeof(messageId));
+        memcpy(&methodId, header + 8, sizeof(methodId));
+        id = messageId;
+        message.resize(length);
+        if (length > 0)
+        {
+            copyFromRing(ring, head + SHARED_MEMORY_MESSAGE_HEADER_SIZE, &message[0], length);
+        }
+        ring.head.store(head + SHARED_MEMORY_MESSAGE_HEADER_SIZE + length, std::memory_order_seq_cst);
+        if (ring.writerWaiting.exchange(0, std::memory_order_seq_cst))
+        {
+            signalEvent(connection.signalFd);
+        }
+        return true;
+    }
+
+    // returns true when the incoming ring has data, so the caller must not sleep
+    bool SharedMemoryHandler::prepareToWait(SharedMemoryConnection& connection)
+    {
+        if (NULL == connection.region)
+        {
+            return false;
+        }
+        SharedMemoryRing& ring = incomingRing(connection);
+        ring.readerWaiting.store(1, std::memory_order_seq_cst);
+        return ring.tail.load(std::memory_order_seq_cst) != ring.head.load(std::memory_order_relaxed);
+    }
+
+    void SharedMemoryHandler::dispatchMessages(SharedMemoryConnection& connection)
+    {
+        std::string data;
+        int messageId = -1;
+        uint16_t methodId = 0;
+        for (int i = 0; (i < MAX_MESSAGES_PER_PROCESS) && !mRequestsPaused && nextMessage(connection, messageId, methodId, data); i++)
+        {
+            RequestInformation information;
+            information.id = messageId;
+            information.fd = connection.controlFd;
+            mActiveRequests[mMessageId] = information;
+            if ((NULL != mListener) && (methodId != 0))
+            {
+                mListener->onBinaryMessageReceived(mMessageId, methodId, data);
+            }
+            else if (NULL != mListener)
+            {
+                mListener->onMessageReceived(mMessageId, data);
+            }
+            mMessageId++;
+        }
+    }
+
+    bool SharedMemoryHandler::process(int wait, std::string* message)
+    {
+        if (!mActive)
+            return false;
+
+        if (!mIsServer)
+        {
+            if (NULL != message)
+            {
+                int messageId = -1;
+                return receiveMessage((int64_t)wait * 1000000, messageId, *message);
+            }
+            flushWriteQueue(mConnection);
+            return prepareToWait(mConnection) || (waitForData(monotonicMicroseconds() + ((int64_t)wait * 1000000)) &&
+                prepareToWait(mConnection));
+        }
+
+        // while requests are paused the clients are not asked to signal and their requests stay in the rings
+        int timeout = wait * 1000;
+        for (auto& client : mClients)
+        {
+            flushWriteQueue(client.second);
+            if (!mRequestsPaused && prepareToWait(client.second))
+            {
+                timeout = 0;
+            }
+        }
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int ret = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS, timeout);
+        if ((ret == -1) && (errno != EINTR))
+        {
+            Logger::log(Error, "error while reading  [%s]", strerror(errno));
+            return false;
+        }
+        bool processed = false;
+        for (int i = 0; i < ret; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == mWakeupFd)
+            {
+                clearEvent(mWakeupFd);
+            }
+            else if (fd == mFd)
+            {
+                acceptClients();
+                processed = true;
+            }
+            else if (mClientsByWaitFd.find(fd) != mClientsByWaitFd.end())
+            {
+                clearEvent(fd);
+            }
+            else
+            {
+                handleClientEvent(fd, events[i].events);
+            }
+        }
+
+        // every ring is checked, a signal is only sent when the server was waiting
+        for (auto& client : mClients)
+        {
+            flushWriteQueue(client.second);
+            SharedMemoryRing& ring = incomingRing(client.second);
+            if (!mRequestsPaused && (ring.tail.load(std::memory_order_acquire) != ring.head.load(std::memory_order_relaxed)))
+            {
+                dispatchMessages(client.second);
+                processed = true;
+            }
+        }
+        removeInactiveClients();
+        return processed;
+    }
+
+    /*
+        waitForData sleeps until the peer signals, the connection goes away or the deadline passes. it returns
+        false on timeout, on wakeup() and when the connection is closed.
+    */
+    bool SharedMemoryHandler::waitForData(int64_t deadline)
+    {
+        while (mActive)
+        {
+            flushWriteQueue(mConnection);
+            if (prepareToWait(mConnection))
+            {
+                return true;
+            }
+            int64_t remaining = deadline - monotonicMicroseconds();
+            if (remaining < 0)
+            {
+                remaining = 0;
+            }
+            struct pollfd descriptors[3] = { { mConnection.waitFd, POLLIN, 0 }, { mConnection.controlFd, POLLIN, 0 }, { mWakeupFd, POLLIN, 0 } };
+            struct timespec timeout = { (time_t)(remaining / 1000000), (long)((remaining % 1000000) * 1000) };
+            int ret = ppoll(descriptors, 3, &timeout, NULL);
+            if (ret == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                Logger::log(Error, "error while waiting for messages [%s]", strerror(errno));
+                return false;
+            }
+            if (ret == 0)
+            {
+                return false;
+            }
+            if (descriptors[1].revents)
+            {
+                handleClientEvent(mConnection.controlFd, EPOLLIN);
+            }
+            if (descriptors[2].revents)
+            {
+                clearEvent(mWakeupFd);
+                return false;
+            }
+            if (descriptors[0].revents)
+            {
+                clearEvent(mConnection.waitFd);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool SharedMemoryHandler::receiveMessage(int64_t timeoutInMicroseconds, int& id, std::string& message)
+    {
+        if (mIsServer)
+        {
+            return false;
+        }
+        int64_t deadline = monotonicMicroseconds() + timeoutInMicroseconds;
+        uint16_t methodId = 0;
+        while (true)
+        {
+            if (nextMessage(mConnection, id, methodId, message))
+            {
+                return true;
+            }
+            if (!waitForData(deadline))
+            {
+                return nextMessage(mConnection, id, methodId, message);
+            }
+        }
+    }
+
+    // the control socket carries no messages after the handshake, it becoming readable means the peer is gone
+    void SharedMemoryHandler::handleClientEvent(int fd, uint32_t /*events*/)
+    {
+        char buffer[64];
+        ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if ((bytesRead > 0) || ((bytesRead == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))))
+        {
+            return;
+        }
+        if (!mIsServer)
+        {
+            Logger::log(Error, "connection to the server is closed");
+            closeConnection(mConnection);
+            return;
+        }
+        std::map<int, SharedMemoryConnection>::iterator clientIterator = mClients.find(fd);
+        if (clientIterator != mClients.end())
+        {
+            // messages the client sent before it went away are still dispatched
+            dispatchMessages(clientIterator->second);
+            closeConnection(clientIterator->second);
+        }
+    }
+
+    bool SharedMemoryHandler::sendMessage(int id, std::string& message)
+    {
+        return sendBinaryMessage(id, 0, message);
+    }
+
+    bool SharedMemoryHandler::sendBinaryMessage(int id, uint16_t methodId, std::string& payload)
+    {
+        if (!mIsServer)
+        {
+            return mActive && queueMessage(mConnection, id, methodId, payload);
+        }
+        std::map<unsigned int, RequestInformation>::iterator requestIterator = mActiveRequests.find(id);
+        if (requestIterator == mActiveRequests.end())
+        {
+            return false;
+        }
+        RequestInformation information = requestIterator->second;
+        mActiveRequests.erase(requestIterator);
+        std::map<int, SharedMemoryConnection>::iterator clientIterator = mClients.find(information.fd);
+        if (clientIterator == mClients.end())
+        {
+            Logger::log(Warn, "no connection to send data to [%d]", information.fd);
+            return false;
+        }
+        return queueMessage(clientIterator->second, information.id, methodId, payload);
+    }
+
+    void SharedMemoryHandler::sendEvent(int eventId, std::string& event)
+    {
+        uint32_t eventBit = (eventId >= 0) ? (1u << eventId) : 0xFFFFFFFF;
+        for (auto& client : mClients)
+        {
+            if ((client.second.eventMask & eventBit) == 0)
+            {
+                continue;
+            }
+            if (!queueMessage(client.second, -1, 0, event))
+            {
+                Logger::log(Warn, "failed to send data to client [%d]", client.first);
+            }
+        }
+    }
+
+    bool SharedMemoryHandler::subscribeEvent(int id, int eventId, bool subscribe)
+    {
+        std::map<unsigned int, RequestInformation>::iterator requestIterator = mActiveRequests.find(id);
+        if ((requestIterator == mActiveRequests.end()) || (eventId < 0) || (eventId >= RDKSHELL_IPC_MAX_EVENTS))
+        {
+            return false;
+        }
+        std::map<int, SharedMemoryConnection>::iterator clientIterator = mClients.find(requestIterator->second.fd);
+        if (clientIterator == mClients.end())
+        {
+            return false;
+        }
+        SharedMemoryConnection& client = clientIterator->second;
+        if (subscribe)
+        {
+            if (!client.subscribed)
+            {
+                client.eventMask = 0;
+                client.subscribed = true;
+            }
+            client.eventMask |= (1u << eventId);
+        }
+        else
+        {
+            client.eventMask &= ~(1u << eventId);
+        }
+        return true;
+    }
+
+    void SharedMemoryHandler::completeRequest(int id)
+    {
+        mActiveRequests.erase(id);
+    }
+
+    // server side clients are removed by removeInactiveClients since the client map may be iterated by the caller
+    void SharedMemoryHandler::closeConnection(SharedMemoryConnection& connection)
+    {
+        connection.writeQueue.clear();
+        connection.pendingWriteBytes = 0;
+        if (mIsServer)
+        {
+            if (std::find(mClientsToRemove.begin(), mClientsToRemove.end(), connection.controlFd) == mClientsToRemove.end())
+            {
+                mClientsToRemove.push_back(connection.controlFd);
+            }
+            return;
+        }
+        mActive = false;
+    }
+
+    void SharedMemoryHandler::removeInactiveClients()
+    {
+        for (std::vector<int>::iterator iter = mClientsToRemove.begin(); iter != mClientsToRemove.end(); iter++)
+        {
+            std::map<int, SharedMemoryConnection>::iterator clientIterator = mClients.find(*iter);
+            if (clientIterator == mClients.end())
+            {
+                continue;
+            }
+            SharedMemoryConnection& client = clientIterator->second;
+            if (mEpollFd != -1)
+            {
+                epoll_ctl(mEpollFd, EPOLL_CTL_DEL, client.controlFd, NULL);
+                if (client.waitFd != -1)
+                {
+                    epoll_ctl(mEpollFd, EPOLL_CTL_DEL, client.waitFd, NULL);
+                }
+            }
+            close(client.controlFd);
+            if (client.waitFd != -1)
+            {
+                mClientsByWaitFd.erase(client.waitFd);
+                close(client.waitFd);
+            }
+            if (client.signalFd != -1)
+            {
+                close(client.signalFd);
+            }
+            if (NULL != client.region)
+            {
+                munmap(client.region, sizeof(SharedMemoryRegion));
+            }
+            mClients.erase(clientIterator);
+
+            // pending requests must not be answered on a descriptor that gets reused by a new client
+            std::map<unsigned int, RequestInformation>::iterator requestIterator = mActiveRequests.begin();
+            while (requestIterator != mActiveRequests.end())
+            {
+                if (requestIterator->second.fd == *iter)
+                {
+                    requestIterator = mActiveRequests.erase(requestIterator);
+                }
+                else
+                {
+                    requestIterator++;
+                }
+            }
+        }
+        mClientsToRemove.clear();
+    }
+
+    void SharedMemoryHandler::pauseRequests(bool pause)
+    {
+        mRequestsPaused = mIsServer && pause;
+    }
+
+    void SharedMemoryHandler::setListener(RdkShellClientListener* listener)
+    {
+        mListener = listener;
+    }
+
+    void SharedMemoryHandler::wakeup()
+    {
+        signalEvent(mWakeupFd);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef RDKSHELL_SHARED_MEMORY_HANDLER_H
+#define RDKSHELL_SHARED_MEMORY_HANDLER_H
+
+#include <communicationhandler.h>
+#include <ipcschema.h>
+#include <vector>
+#include <string>
+#include <deque>
+#include <map>
+
+namespace RdkShell
+{
+    struct SharedMemoryRegion;
+    struct SharedMemoryRing;
+
+    // a message waiting for space in the ring of its connection
+    struct SharedMemoryMessage
+    {
+        int id;
+        uint16_t methodId;
+        std::string data;
+    };
+
+    struct SharedMemoryConnection
+    {
+        SharedMemoryConnection() : controlFd(-1), waitFd(-1), signalFd(-1), region(NULL), writeQueue(), pendingWriteBytes(0),
+            eventMask(RDKSHELL_IPC_DEFAULT_EVENT_MASK), subscribed(false) {}
+        int controlFd; // unix socket the descriptors were passed over, only used to notice the peer going away
+        int waitFd; // eventfd signalled by the peer when there is something to read or space to write
+        int signalFd; // eventfd of the peer
+        SharedMemoryRegion* region;
+        std::deque<SharedMemoryMessage> writeQueue; // messages that did not fit into the ring yet
+        size_t pendingWriteBytes;
+        uint32_t eventMask;
+        bool subscribed;
+    };
+
+    /*
+        SharedMemoryHandler exchanges messages with clients on the same device through a memfd shared with
+        each connection, holding one single producer single consumer ring per direction. eventfds provide the
+        wakeups and are only signalled when the other side is waiting. the unix socket a client connects to is
+        only used to hand over the descriptors and to notice when the peer goes away.
+    */
+    class SharedMemoryHandler:public CommunicationHandler
+    {
+        public:
+            SharedMemoryHandler(std::string& path, bool isServer=false);
+            virtual ~SharedMemoryHandler();
+            bool initialize();
+            void terminate();
+            bool sendMessage(int id, std::string& message);
+            bool sendBinaryMessage(int id, uint16_t methodId, std::string& payload);
+            bool process(int wait, std::string* message = NULL);
+            bool receiveMessage(int64_t timeoutInMicroseconds, int& id, std::string& message);
+            void sendEvent(int eventId, std::string& event);
+            bool subscribeEvent(int id, int eventId, bool subscribe);
+            void completeRequest(int id);
+            void setListener(RdkShellClientListener* listener);
+            void wakeup();
+            void pauseRequests(bool pause);
+
+        private:
+            bool initializeServer();
+            bool initializeClient();
+            void acceptClients();
+            bool createRegion(SharedMemoryConnection& connection, int& memoryFd, int& peerWaitFd);
+            bool mapRegion(SharedMemoryConnection& connection, int memoryFd, bool create);
+            bool queueMessage(SharedMemoryConnection& connection, int id, uint16_t methodId, const std::string& message);
+            bool flushWriteQueue(SharedMemoryConnection& connection);
+            bool nextMessage(SharedMemoryConnection& connection, int& id, uint16_t& methodId, std::string& message);
+            bool prepareToWait(SharedMemoryConnection& connection);
+            bool waitForData(int64_t deadline);
+            void dispatchMessages(SharedMemoryConnection& connection);
+            void handleClientEvent(int fd, uint32_t events);
+            void closeConnection(SharedMemoryConnection& connection);
+            void removeInactiveClients();
+            SharedMemoryRing& incomingRing(SharedMemoryConnection& connection);
+            SharedMemoryRing& outgoingRing(SharedMemoryConnection& connection);
+            bool mActive;
+            std::string mPath;
+            bool mIsServer;
+            int mFd;
+            int mEpollFd;
+            int mWakeupFd;
+            SharedMemoryConnection mConnection; // connection to the server when running as a client
+            std::map<int, SharedMemoryConnection> mClients; // keyed by the control socket of the client
+            std::map<int, int> mClientsByWaitFd;
+            std::vector<int> mClientsToRemove;
+            struct RequestInformation
+            {
+                int fd;
+                int id;
+            };
+            std::map<unsigned int, RequestInformation> mActiveRequests;
+            unsigned int mMessageId;
+            RdkShellClientListener* mListener;
+            bool mRequestsPaused;
+    };
+}
+#endif //RDKSHELL_SHARED_MEMORY_HANDLER_H
@@ -1,52 +1,86 @@
 #include "sockethandler.h"
 #include "communicationutils.h"
+#include "binaryprotocol.h"
 #include "logger.h"
 #include <rapidjson/document.h>
 #include <stdio.h>
 #include <string.h>
-#include <sstream> 
+#include <sstream>
 #include <iostream>
 #include <vector>
 #include <map>
 #include <stdlib.h>
+#include <errno.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 
 using namespace rapidjson;
 
 namespace RdkShell
 {
-    #define READ_BUFFER_SIZE 2096
-  
+    #define READ_BUFFER_SIZE 16384
+    #define FRAME_LENGTH_FIELD_SIZE 4
+    #define MAX_HEADER_SIZE 2048
+    #define MAX_MESSAGE_SIZE (1024*1024)
+    #define MAX_PENDING_WRITE_SIZE (4*1024*1024)
+    #define MAX_READ_PER_PROCESS (64*1024)
+    #define MAX_EPOLL_EVENTS 16
+    #define MAX_WRITE_VECTORS 16
+
     struct ClientRequestInformation
     {
         int fd;
         int id;
     };
-  
+
     static std::map<unsigned int, struct ClientRequestInformation> sActiveRequestMap;
-    static std::vector<int> sClientsToRemove;
     static unsigned int sMessageId = 0;
-  
-    SocketHandler::SocketHandler(std::string& server, int port, bool isServer): mFd(-1), mServer(server), mPort(port), mIsServer(isServer), mListener(NULL), mActive(false)
+
+    /*
+        a frame is a 4 byte ascii length of the json header, the json header carrying the id and payload length,
+        and the payload. the length field is padded with zeros, which is what earlier peers send as well.
+    */
+    static void prepareFrame(int messageId, std::string& message, std::string& frameHeader)
+    {
+        std::string header;
+        prepareHeader(messageId, message, header);
+        char lengthField[FRAME_LENGTH_FIELD_SIZE + 1];
+        memset(lengthField, 0, sizeof(lengthField));
+        snprintf(lengthField, sizeof(lengthField), "%u", (unsigned int)header.length());
+        frameHeader.reserve(FRAME_LENGTH_FIELD_SIZE + header.length());
+        frameHeader.assign(lengthField, FRAME_LENGTH_FIELD_SIZE);
+        frameHeader.append(header);
+    }
+
+    static bool setNonBlocking(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL);
+        return (flags != -1) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1);
+    }
+
+    SocketHandler::SocketHandler(std::string& server, int port, bool isServer): mFd(-1), mEpollFd(-1), mWakeupFd(-1), mServer(server), mPort(port), mIsServer(isServer), mListener(NULL), mActive(false), mRequestsPaused(false)
     {
         memset(&mLocalEndpoint, 0, sizeof(struct sockaddr_storage));
         memset(&mRemoteEndpoint, 0, sizeof(struct sockaddr_storage));
         mBuffer = new char[READ_BUFFER_SIZE];
-        memset(mBuffer, 0, READ_BUFFER_SIZE);
     }
-    
+
     SocketHandler::~SocketHandler()
     {
-        delete mBuffer;
+        delete[] mBuffer;
         mBuffer = NULL;
     }
-  
+
     bool SocketHandler::initialize()
     {
         struct hostent *hostEntry = NULL;
@@ -57,12 +91,20 @@ namespace RdkShell
             return false;
         }
         mServer = inet_ntoa(*(struct in_addr*)hostEntry->h_addr);
-  
+
         if (mFd != -1)
         {
             close(mFd);
         }
-  
+        if (mEpollFd != -1)
+        {
+            close(mEpollFd);
+        }
+        if (mWakeupFd != -1)
+        {
+            close(mWakeupFd);
+        }
+
         struct sockaddr_in* ipv4Address = (struct sockaddr_in *) (mIsServer?&mLocalEndpoint:&mRemoteEndpoint);
         int ret = inet_pton(AF_INET, mServer.c_str(), &ipv4Address->sin_addr);
         if (1 == ret)
@@ -85,16 +127,34 @@ namespace RdkShell
             mRemoteEndpoint.ss_family = AF_INET;
             mFd = socket(mRemoteEndpoint.ss_family, SOCK_STREAM, 0);
         }
-  
+
         if (mFd == -1)
             return false;
-  
+
         uint32_t one = 1;
         ret = fcntl(mFd, F_SETFD, fcntl(mFd, F_GETFD) | FD_CLOEXEC);
 
         if (ret == -1)
             return false;
 
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFd == -1)
+        {
+            Logger::log(Fatal, "Failed to create epoll instance - [%s]", strerror(errno));
+            return false;
+        }
+
+        mWakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        struct epoll_event wakeupEvent;
+        memset(&wakeupEvent, 0, sizeof(wakeupEvent));
+        wakeupEvent.events = EPOLLIN;
+        wakeupEvent.data.fd = mWakeupFd;
+        if ((mWakeupFd == -1) || (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeupFd, &wakeupEvent) == -1))
+        {
+            Logger::log(Fatal, "Failed to create wakeup event - [%s]", strerror(errno));
+            return false;
+        }
+
         ret = setsockopt(mFd, SOL_TCP, TCP_NODELAY, &one, sizeof(one));
         bool isSocketReady = false;
         if (mIsServer)
@@ -121,7 +181,7 @@ namespace RdkShell
             while (retry <= 2)
             {
                 ret = ::connect(mFd, (struct sockaddr *)&mRemoteEndpoint, sizeof(struct sockaddr_in));
-                                                                                                 
+
                 if (ret == -1)
                 {
                     int err = errno;
@@ -136,28 +196,58 @@ namespace RdkShell
                 }
             }
             isSocketReady = connected;
+            mConnection = Socket();
+            mConnection.fd = mFd;
+            mConnection.endpoint = mRemoteEndpoint;
+        }
+
+        // the socket is only ever touched when epoll reports it ready, so a slow peer cannot block the caller
+        if (isSocketReady)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = mFd;
+            if (!setNonBlocking(mFd) || (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mFd, &event) == -1))
+            {
+                Logger::log(Fatal, "Failed to watch socket - [%s]", strerror(errno));
+                return false;
+            }
         }
         mActive = true;
         return isSocketReady;
     }
-  
+
     void SocketHandler::terminate()
     {
-        for (auto client : mClients)
+        for (auto& client : mClients)
         {
-            close(client.fd);
+            close(client.first);
         }
         mClients.clear();
-  
+        mClientsToRemove.clear();
+        sActiveRequestMap.clear();
+        mConnection = Socket();
+
         if (mFd != -1)
         {
             shutdown(mFd, SHUT_RDWR);
             close(mFd);
         }
         mFd = -1;
+        if (mEpollFd != -1)
+        {
+            close(mEpollFd);
+        }
+        mEpollFd = -1;
+        if (mWakeupFd != -1)
+        {
+            close(mWakeupFd);
+        }
+        mWakeupFd = -1;
         mActive = false;
     }
-    
+
     bool SocketHandler::sendMessage(int id, std::string& message)
     {
         int fd = mFd, messageId = id;
@@ -174,228 +264,728 @@ namespace RdkShell
         }
         return sendToNetwork(messageId, fd, message);
     }
-  
-    bool SocketHandler::sendToNetwork(int messageId, int fd, std::string& message)
+
+    bool SocketHandler::sendBinaryMessage(int id, uint16_t methodId, std::string& payload)
     {
-        std::string header;
-        prepareHeader(messageId, message, header);
-        std::stringstream headerLengthString;
-        headerLengthString<<header.length();
-        int sent = send(fd, headerLengthString.str().c_str() , 4, MSG_NOSIGNAL);
-        sent = send(fd, header.c_str(), header.length(), MSG_NOSIGNAL);
-        if (sent != header.length())
-        {
-            int err = errno;
-            Logger::log(Error, "error while sending header - [%s]", strerror(err));
-            return false;
+        int fd = mFd, messageId = id;
+        if (mIsServer)
+        {
+            if (sActiveRequestMap.find(id) == sActiveRequestMap.end())
+            {
+                return false;
+            }
+            struct ClientRequestInformation& information = sActiveRequestMap[id];
+            fd = information.fd;
+            messageId = information.id;
+            sActiveRequestMap.erase(id);
         }
-  
-        sent = send(fd, message.c_str(), message.length(), MSG_NOSIGNAL);
-        if (sent != message.length())
+        Socket* socket = connection(fd);
+        if (NULL == socket)
         {
-            int err = errno;
-            Logger::log(Error, "error while sending data - [%s]", strerror(err));
             return false;
         }
-        return true;
+        // header and payload go out in a single sendmsg call
+        std::string frameHeader;
+        writeBinaryFrameHeader(methodId, messageId, (uint32_t)payload.length(), frameHeader);
+        return sendFrame(*socket, frameHeader, payload);
+    }
+
+    Socket* SocketHandler::connection(int fd)
+    {
+        if (!mIsServer)
+        {
+            return ((fd != -1) && (fd == mConnection.fd)) ? &mConnection : NULL;
+        }
+        std::map<int, Socket>::iterator clientIterator = mClients.find(fd);
+        return (clientIterator != mClients.end()) ? &clientIterator->second : NULL;
     }
-  
-    bool SocketHandler::readData(int fd, int& id, std::string* message)
+
+    bool SocketHandler::sendToNetwork(int messageId, int fd, std::string& message)
     {
-        ssize_t bytesRead = 0;
-        int bytesToRead = 4;
-        int byteSent = 0;
-        memset(mBuffer, 0, READ_BUFFER_SIZE);
-        bytesRead = recv(fd, mBuffer, bytesToRead, MSG_NOSIGNAL);
-        if (bytesRead == -1)
-        {
-            Logger::log(Error, "read error:  [%s]", strerror(errno));
+        Socket* socket = connection(fd);
+        if (NULL == socket)
+        {
+            Logger::log(Warn, "no connection to send data to [%d]", fd);
             return false;
         }
-        if ((bytesRead == 0) && mIsServer)
+        std::string frameHeader;
+        prepareFrame(messageId, message, frameHeader);
+        return sendFrame(*socket, frameHeader, message);
+    }
+
+    /*
+        sendFrame writes the frame straight to the socket when nothing is queued for it and keeps whatever the
+        socket did not accept in the connection's write queue, which is drained when epoll reports it writable
+    */
+    bool SocketHandler::sendFrame(Socket& connection, const std::string& frameHeader, const std::string& message)
+    {
+        size_t frameLength = frameHeader.length() + message.length();
+        size_t sent = 0;
+        if (connection.writeQueue.empty())
+        {
+            struct iovec vectors[2];
+            vectors[0].iov_base = (void*)frameHeader.data();
+            vectors[0].iov_len = frameHeader.length();
+            vectors[1].iov_base = (void*)message.data();
+            vectors[1].iov_len = message.length();
+            struct msghdr messageHeader;
+            memset(&messageHeader, 0, sizeof(messageHeader));
+            messageHeader.msg_iov = vectors;
+            messageHeader.msg_iovlen = 2;
+            ssize_t ret = sendmsg(connection.fd, &messageHeader, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (ret == -1)
+            {
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+                {
+                    Logger::log(Error, "error while sending data - [%s]", strerror(errno));
+                    closeConnection(connection.fd);
+                    return false;
+                }
+                ret = 0;
+            }
+            sent = (size_t)ret;
+            if (sent == frameLength)
+            {
+                return true;
+            }
+        }
+
+        if ((connection.pendingWriteBytes + frameLength - sent) > MAX_PENDING_WRITE_SIZE)
         {
-            sClientsToRemove.push_back(fd);
+            Logger::log(Error, "client [%d] is not reading its messages and is removed", connection.fd);
+            closeConnection(connection.fd);
             return false;
         }
-        int headerLength = 0;
-        if (bytesRead == 4)
+
+        std::string pending;
+        pending.reserve(frameLength - sent);
+        if (sent < frameHeader.length())
         {
-            headerLength = atoi(mBuffer);
+            pending.append(frameHeader, sent, std::string::npos);
+            pending.append(message);
         }
         else
         {
-            return false;
+            pending.append(message, sent - frameHeader.length(), std::string::npos);
         }
-        if (headerLength > (READ_BUFFER_SIZE-4))
+        connection.pendingWriteBytes += pending.length();
+        connection.writeQueue.push_back(std::move(pending));
+        enableWriteEvents(connection, true);
+        return true;
+    }
+
+    bool SocketHandler::flushWriteQueue(Socket& connection)
+    {
+        while (!connection.writeQueue.empty())
         {
-            Logger::log(Error, "received long or corrupted header and removing client");
-            sClientsToRemove.push_back(fd);
-            return false;
+            struct iovec vectors[MAX_WRITE_VECTORS];
+            int vectorCount = 0;
+            for (std::deque<std::string>::iterator it = connection.writeQueue.begin();
+                 (it != connection.writeQueue.end()) && (vectorCount < MAX_WRITE_VECTORS); it++, vectorCount++)
+            {
+                size_t offset = (vectorCount == 0) ? connection.writeOffset : 0;
+                vectors[vectorCount].iov_base = (void*)(it->data() + offset);
+                vectors[vectorCount].iov_len = it->length() - offset;
+            }
+            struct msghdr messageHeader;
+            memset(&messageHeader, 0, sizeof(messageHeader));
+            messageHeader.msg_iov = vectors;
+            messageHeader.msg_iovlen = vectorCount;
+            ssize_t ret = sendmsg(connection.fd, &messageHeader, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (ret == -1)
+            {
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                {
+                    return true;
+                }
+                Logger::log(Error, "error while sending data - [%s]", strerror(errno));
+                closeConnection(connection.fd);
+                return false;
+            }
+
+            size_t sent = (size_t)ret;
+            connection.pendingWriteBytes -= sent;
+            while (sent > 0)
+            {
+                size_t remaining = connection.writeQueue.front().length() - connection.writeOffset;
+                if (sent >= remaining)
+                {
+                    sent -= remaining;
+                    connection.writeQueue.pop_front();
+                    connection.writeOffset = 0;
+                }
+                else
+                {
+                    connection.writeOffset += sent;
+                    sent = 0;
+                }
+            }
         }
-        bytesRead = recv(fd, mBuffer+4, headerLength, MSG_NOSIGNAL);
-        if (bytesRead == 0)
+        enableWriteEvents(connection, false);
+        return true;
+    }
+
+    void SocketHandler::enableWriteEvents(Socket& connection, bool enable)
+    {
+        if (connection.writeEnabled == enable)
         {
-            sClientsToRemove.push_back(fd);
-            return false;
+            return;
+        }
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = watchedEvents(enable);
+        event.data.fd = connection.fd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_MOD, connection.fd, &event) == -1)
+        {
+            Logger::log(Error, "unable to update events for [%d] - [%s]", connection.fd, strerror(errno));
+            return;
         }
-        if (bytesRead == headerLength)
+        connection.writeEnabled = enable;
+    }
+
+    // requests are not read while they are paused
+    uint32_t SocketHandler::watchedEvents(bool writeEnabled)
+    {
+        return (mRequestsPaused ? 0 : (uint32_t)EPOLLIN) | (writeEnabled ? (uint32_t)EPOLLOUT : 0);
+    }
+
+    void SocketHandler::pauseRequests(bool pause)
+    {
+        if (!mIsServer || (mRequestsPaused == pause))
         {
-            std::string headerData(mBuffer+4, headerLength);
+            return;
+        }
+        mRequestsPaused = pause;
+        for (auto& client : mClients)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = watchedEvents(client.second.writeEnabled);
+            event.data.fd = client.first;
+            if (epoll_ctl(mEpollFd, EPOLL_CTL_MOD, client.first, &event) == -1)
+            {
+                Logger::log(Error, "unable to update events for [%d] - [%s]", client.first, strerror(errno));
+            }
+        }
+    }
+
+    /*
+        readData appends whatever the socket has available to the connection's read buffer without blocking.
+        reads are capped per call so a client flooding the socket cannot hold up the frame, the remaining
+        data is picked up on the next call since epoll is level triggered. returns false when the peer is gone.
+    */
+    bool SocketHandler::readData(Socket& connection)
+    {
+        size_t totalBytesRead = 0;
+        while (totalBytesRead < MAX_READ_PER_PROCESS)
+        {
+            ssize_t bytesRead = recv(connection.fd, mBuffer, READ_BUFFER_SIZE, MSG_DONTWAIT);
+            if (bytesRead > 0)
+            {
+                connection.readBuffer.append(mBuffer, bytesRead);
+                totalBytesRead += bytesRead;
+            }
+            else if (bytesRead == 0)
+            {
+                return false;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            else
+            {
+                Logger::log(Error, "read error:  [%s]", strerror(errno));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+        nextMessage takes the next complete frame out of the connection's read buffer. partial frames stay
+        buffered until the rest arrives. a corrupted or oversized frame closes the connection. methodId is
+        set for binary frames and is 0 for json frames.
+    */
+    bool SocketHandler::nextMessage(Socket& connection, int& id, uint16_t& methodId, std::string& message)
+    {
+        std::string& buffer = connection.readBuffer;
+        while (buffer.length() >= FRAME_LENGTH_FIELD_SIZE)
+        {
+            if (isBinaryFrame(buffer.data(), buffer.length()))
+            {
+                if (buffer.length() < RDKSHELL_BINARY_FRAME_HEADER_SIZE)
+                {
+                    return false;
+                }
+                BinaryFrameHeader header;
+                if (!readBinaryFrameHeader(buffer.data(), buffer.length(), header) || (header.methodId == 0) ||
+                    (header.length > MAX_MESSAGE_SIZE))
+                {
+                    Logger::log(Error, "received corrupted binary frame and removing client");
+                    buffer.clear();
+                    closeConnection(connection.fd);
+                    return false;
+                }
+                size_t binaryFrameLength = RDKSHELL_BINARY_FRAME_HEADER_SIZE + header.length;
+                if (buffer.length() < binaryFrameLength)
+                {
+                    return false;
+                }
+                message.assign(buffer, RDKSHELL_BINARY_FRAME_HEADER_SIZE, header.length);
+                buffer.erase(0, binaryFrameLength);
+                id = header.id;
+                methodId = header.methodId;
+                return true;
+            }
+
+            char lengthField[FRAME_LENGTH_FIELD_SIZE + 1];
+            memcpy(lengthField, buffer.data(), FRAME_LENGTH_FIELD_SIZE);
+            lengthField[FRAME_LENGTH_FIELD_SIZE] = '\0';
+            int headerLength = atoi(lengthField);
+            if ((headerLength <= 0) || (headerLength > MAX_HEADER_SIZE))
+            {
+                Logger::log(Error, "received long or corrupted header and removing client");
+                buffer.clear();
+                closeConnection(connection.fd);
+                return false;
+            }
+            if (buffer.length() < (size_t)(FRAME_LENGTH_FIELD_SIZE + headerLength))
+            {
+                return false;
+            }
+
+            std::string headerData(buffer, FRAME_LENGTH_FIELD_SIZE, headerLength);
             Document d;
             d.Parse(headerData.c_str());
+            if (d.HasParseError() || !d.IsObject())
+            {
+                Logger::log(Error, "received corrupted header and removing client");
+                buffer.clear();
+                closeConnection(connection.fd);
+                return false;
+            }
             unsigned int payloadLength = 0;
-            if (d.HasMember("length"))
+            if (d.HasMember("length") && d["length"].IsUint())
             {
                 payloadLength = d["length"].GetUint();
             }
-            if (d.HasMember("id"))
+            int messageId = -1;
+            if (d.HasMember("id") && d["id"].IsInt())
             {
-                id = d["id"].GetInt();
+                messageId = d["id"].GetInt();
             }
-            bytesToRead = (payloadLength>READ_BUFFER_SIZE)?READ_BUFFER_SIZE:payloadLength;
-            while(bytesToRead > 0)
+            if (payloadLength > MAX_MESSAGE_SIZE)
             {
-                memset(mBuffer, 0, READ_BUFFER_SIZE);
-                bytesRead = recv(fd, mBuffer, bytesToRead, MSG_NOSIGNAL);
-                bytesToRead = bytesToRead-bytesRead;
-                message->append(mBuffer, bytesRead);
+                Logger::log(Error, "received message of %u bytes which exceeds the limit and removing client", payloadLength);
+                buffer.clear();
+                closeConnection(connection.fd);
+                return false;
+            }
+
+            size_t frameLength = FRAME_LENGTH_FIELD_SIZE + headerLength + payloadLength;
+            if (buffer.length() < frameLength)
+            {
+                return false;
+            }
+            message.assign(buffer, FRAME_LENGTH_FIELD_SIZE + headerLength, payloadLength);
+            buffer.erase(0, frameLength);
+            if (payloadLength > 0)
+            {
+                id = messageId;
+                methodId = 0;
+                return true;
             }
         }
-        return message->length()>0;
+        return false;
     }
-  
+
     bool SocketHandler::process(int wait, std::string* message)
     {
         if (!mActive)
             return false;
-  
-        fd_set readfds, errfds;
-        FD_ZERO(&readfds);
-        FD_ZERO(&errfds);
-  
-        FD_SET(mFd, &readfds);
-        FD_SET(mFd, &errfds);
-  
-        struct timeval polltimeout;
-        polltimeout.tv_sec = wait;
-        polltimeout.tv_usec = 0;
-  
-        int maxfd = mFd;
-        if (mIsServer)
+
+        if (!mIsServer && (NULL != message))
         {
-            for (auto& client: mClients)
+            int messageId = -1;
+            return receiveMessage((int64_t)wait * 1000000, messageId, *message);
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t deadline = ((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000) + ((int64_t)wait * 1000);
+        int timeout = wait * 1000;
+        bool processed = false;
+        bool wokenUp = false;
+        if (mIsServer && !mRequestsPaused)
+        {
+            for (auto& client : mClients)
             {
-                maxfd = (client.fd>maxfd)?client.fd:maxfd;
-                FD_SET(client.fd, &readfds);
-                FD_SET(client.fd, &errfds);
+                if (client.second.pendingRequests)
+                {
+                    dispatchMessages(client.second);
+                    processed = true;
+                    timeout = 0;
+                }
             }
         }
-        int ret = select(maxfd + 1, &readfds, NULL, &errfds, &polltimeout);
-  
-        if (ret == -1)
+        do
         {
-            Logger::log(Error, "error while reading  [%s]", strerror(errno));
-            return false;
+            struct epoll_event events[MAX_EPOLL_EVENTS];
+            int ret = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS, timeout);
+            if (ret == -1)
+            {
+                if (errno != EINTR)
+                {
+                    Logger::log(Error, "error while reading  [%s]", strerror(errno));
+                    return false;
+                }
+                ret = 0;
+            }
+
+            for (int i = 0; i < ret; i++)
+            {
+                int fd = events[i].data.fd;
+                if (fd == mWakeupFd)
+                {
+                    uint64_t count = 0;
+                    if (read(mWakeupFd, &count, sizeof(count)) == -1)
+                    {
+                        Logger::log(Warn, "unable to clear wakeup event - [%s]", strerror(errno));
+                    }
+                    wokenUp = true;
+                }
+                else if (!mIsServer)
+                {
+                    if (events[i].events & EPOLLOUT)
+                    {
+                        flushWriteQueue(mConnection);
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    {
+                        bool connected = readData(mConnection);
+                        processed = true;
+                        if (!connected)
+                        {
+                            Logger::log(Error, "connection to the server is closed");
+                            closeConnection(mFd);
+                        }
+                    }
+                }
+                else if (fd == mFd)
+                {
+                    acceptClients();
+                    processed = true;
+                }
+                else
+                {
+                    handleClientEvent(fd, events[i].events);
+                    processed = true;
+                }
+            }
+
+            if (mIsServer || processed || wokenUp || !mActive)
+            {
+                break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timeout = (int)(deadline - (((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000)));
+        } while (timeout > 0);
+
+        if (mIsServer)
+        {
+            removeInactiveClients();
         }
-  
-        if (ret <= 0)
+        return processed;
+    }
+
+    bool SocketHandler::receiveMessage(int64_t timeoutInMicroseconds, int& id, std::string& message)
+    {
+        if (mIsServer)
         {
             return false;
         }
-  
-        if (FD_ISSET(mFd, &readfds))
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t deadline = ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000) + timeoutInMicroseconds;
+        uint16_t methodId = 0;
+        while (true)
         {
-            if (mIsServer)
+            if (nextMessage(mConnection, id, methodId, message))
             {
-                acceptClient();
                 return true;
             }
-            else
+            if (!mActive)
             {
-                int messageId;
-                return readData(mFd, messageId, message);
+                return false;
             }
-        }
-        
-        if (mIsServer)
-        {
-            for (auto& client: mClients)
+
+            // the epoll descriptor becomes readable when one of its descriptors has events, ppoll gives a
+            // timeout finer than the milliseconds of epoll_wait
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t remaining = deadline - (((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000));
+            if (remaining < 0)
+            {
+                remaining = 0;
+            }
+            struct pollfd epollDescriptor = { mEpollFd, POLLIN, 0 };
+            struct timespec timeout = { (time_t)(remaining / 1000000), (long)((remaining % 1000000) * 1000) };
+            int ret = ppoll(&epollDescriptor, 1, &timeout, NULL);
+            if (ret == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                Logger::log(Error, "error while waiting for messages [%s]", strerror(errno));
+                return false;
+            }
+            if (ret == 0)
+            {
+                return false;
+            }
+
+            struct epoll_event events[MAX_EPOLL_EVENTS];
+            ret = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS, 0);
+            for (int i = 0; i < ret; i++)
             {
-                if (FD_ISSET(client.fd, &readfds))
+                if (events[i].data.fd == mWakeupFd)
                 {
-                    std::string data;
-                    int messageId;
-                    if (readData(client.fd, messageId, &data))
+                    uint64_t count = 0;
+                    if (read(mWakeupFd, &count, sizeof(count)) == -1)
                     {
-                        struct ClientRequestInformation information;
-                        information.id = messageId;
-                        information.fd = client.fd;
-                        sActiveRequestMap[sMessageId] = information;
-                        mListener->onMessageReceived(sMessageId, data);
-                        sMessageId++;
+                        Logger::log(Warn, "unable to clear wakeup event - [%s]", strerror(errno));
                     }
+                    return nextMessage(mConnection, id, methodId, message);
                 }
-                if (FD_ISSET(client.fd, &errfds))
+                if (events[i].events & EPOLLOUT)
                 {
-                    Logger::log(Warn, "received error while reading from a client");
+                    flushWriteQueue(mConnection);
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                {
+                    if (!readData(mConnection))
+                    {
+                        Logger::log(Error, "connection to the server is closed");
+                        closeConnection(mFd);
+                    }
                 }
             }
-            removeInactiveClients();
         }
-        return false;
     }
-  
-    void SocketHandler::acceptClient()
+
+    void SocketHandler::handleClientEvent(int fd, uint32_t events)
     {
-        Socket client;
-        socklen_t socketLength;
-  
-        socketLength = sizeof(struct sockaddr_storage);
-        memset(&client.endpoint, 0, sizeof(struct sockaddr_storage));
-  
-        client.fd = accept(mFd, (struct sockaddr *)&(client.endpoint), &socketLength);
-        if (client.fd == -1)
-        {
-            Logger::log(Error, "accept: error - [%s]", strerror(errno));
+        Socket* client = connection(fd);
+        if (NULL == client)
+        {
             return;
         }
-        mClients.push_back(client); 
+        if (events & EPOLLOUT)
+        {
+            flushWriteQueue(*client);
+        }
+        if (mRequestsPaused)
+        {
+            // hang ups are reported even though the socket is not watched for input
+            if (events & (EPOLLHUP | EPOLLERR))
+            {
+                closeConnection(fd);
+            }
+            return;
+        }
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        {
+            // messages that arrived before the peer closed the connection are still dispatched
+            bool connected = readData(*client);
+            dispatchMessages(*client);
+            if (!connected)
+            {
+                closeConnection(fd);
+            }
+        }
     }
-  
-    void SocketHandler::sendEvent(std::string& event)
+
+    // the listener may pause requests, the rest of the buffer is then dispatched once they are resumed
+    void SocketHandler::dispatchMessages(Socket& connection)
     {
+        std::string data;
+        int messageId = -1;
+        uint16_t methodId = 0;
+        while (!mRequestsPaused && nextMessage(connection, messageId, methodId, data))
+        {
+            struct ClientRequestInformation information;
+            information.id = messageId;
+            information.fd = connection.fd;
+            sActiveRequestMap[sMessageId] = information;
+            if ((NULL != mListener) && (methodId != 0))
+            {
+                mListener->onBinaryMessageReceived(sMessageId, methodId, data);
+            }
+            else if (NULL != mListener)
+            {
+                mListener->onMessageReceived(sMessageId, data);
+            }
+            sMessageId++;
+        }
+        connection.pendingRequests = mRequestsPaused;
+    }
+
+    void SocketHandler::acceptClients()
+    {
+        while (true)
+        {
+            Socket client;
+            socklen_t socketLength = sizeof(struct sockaddr_storage);
+            client.fd = accept4(mFd, (struct sockaddr *)&(client.endpoint), &socketLength, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client.fd == -1)
+            {
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+                {
+                    Logger::log(Error, "accept: error - [%s]", strerror(errno));
+                }
+                return;
+            }
+
+            uint32_t one = 1;
+            setsockopt(client.fd, SOL_TCP, TCP_NODELAY, &one, sizeof(one));
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = watchedEvents(false);
+            event.data.fd = client.fd;
+            if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, client.fd, &event) == -1)
+            {
+                Logger::log(Error, "unable to watch client [%d] - [%s]", client.fd, strerror(errno));
+                close(client.fd);
+                continue;
+            }
+            mClients[client.fd] = client;
+        }
+    }
+
+    void SocketHandler::sendEvent(int eventId, std::string& event)
+    {
+        // the frame header is the same for every client, only the write state differs per connection
+        uint32_t eventBit = (eventId >= 0) ? (1u << eventId) : 0xFFFFFFFF;
+        std::string frameHeader;
         for (auto& client: mClients)
         {
-            bool ret = sendToNetwork(-1, client.fd, event);
+            if ((client.second.eventMask & eventBit) == 0)
+            {
+                continue;
+            }
+            if (frameHeader.empty())
+            {
+                prepareFrame(-1, event, frameHeader);
+            }
+            bool ret = sendFrame(client.second, frameHeader, event);
             if (false == ret)
             {
-                Logger::log(Warn, "failed to send data to client [%d]", client.fd);
+                Logger::log(Warn, "failed to send data to client [%d]", client.first);
+            }
+        }
+    }
+
+    bool SocketHandler::subscribeEvent(int id, int eventId, bool subscribe)
+    {
+        std::map<unsigned int, struct ClientRequestInformation>::iterator requestIterator = sActiveRequestMap.find(id);
+        if ((requestIterator == sActiveRequestMap.end()) || (eventId < 0) || (eventId >= RDKSHELL_IPC_MAX_EVENTS))
+        {
+            return false;
+        }
+        std::map<int, Socket>::iterator clientIterator = mClients.find(requestIterator->second.fd);
+        if (clientIterator == mClients.end())
+        {
+            return false;
+        }
+        // connections that never subscribe keep getting the events earlier servers sent
+        Socket& client = clientIterator->second;
+        if (subscribe)
+        {
+            if (!client.subscribed)
+            {
+                client.eventMask = 0;
+                client.subscribed = true;
             }
+            client.eventMask |= (1u << eventId);
+        }
+        else
+        {
+            client.eventMask &= ~(1u << eventId);
+        }
+        return true;
+    }
+
+    void SocketHandler::completeRequest(int id)
+    {
+        sActiveRequestMap.erase(id);
+    }
+
+    /*
+        closeConnection defers closing server side clients to removeInactiveClients since the client map may be
+        iterated by the caller. the client side connection is closed right away.
+    */
+    void SocketHandler::closeConnection(int fd)
+    {
+        if (mIsServer)
+        {
+            mClientsToRemove.push_back(fd);
+            return;
+        }
+        if ((fd != -1) && (fd == mConnection.fd))
+        {
+            epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL);
+            mConnection.writeQueue.clear();
+            mConnection.pendingWriteBytes = 0;
+            mActive = false;
         }
     }
-  
+
     void SocketHandler::removeInactiveClients()
     {
-        for (std::vector<int>::iterator iter = sClientsToRemove.begin(); iter != sClientsToRemove.end(); iter++)
+        for (std::vector<int>::iterator iter = mClientsToRemove.begin(); iter != mClientsToRemove.end(); iter++)
         {
-            std::vector<Socket>::iterator clientIterator = mClients.begin();
-            while (clientIterator != mClients.end())
+            std::map<int, Socket>::iterator clientIterator = mClients.find(*iter);
+            if (clientIterator == mClients.end())
             {
-                if ((*clientIterator).fd == *iter)
+                continue;
+            }
+            epoll_ctl(mEpollFd, EPOLL_CTL_DEL, *iter, NULL);
+            close(*iter);
+            mClients.erase(clientIterator);
+
+            // pending requests must not be answered on a descriptor that gets reused by a new client
+            std::map<unsigned int, struct ClientRequestInformation>::iterator requestIterator = sActiveRequestMap.begin();
+            while (requestIterator != sActiveRequestMap.end())
+            {
+                if (requestIterator->second.fd == *iter)
                 {
-                    clientIterator = mClients.erase(clientIterator); 
+                    requestIterator = sActiveRequestMap.erase(requestIterator);
                 }
                 else
                 {
-                    clientIterator++;
+                    requestIterator++;
                 }
             }
         }
-        sClientsToRemove.clear();
+        mClientsToRemove.clear();
     }
-  
+
     void SocketHandler::setListener(RdkShellClientListener* listener)
     {
         mListener = listener;
     }
+
+    void SocketHandler::wakeup()
+    {
+        uint64_t count = 1;
+        if ((mWakeupFd != -1) && (write(mWakeupFd, &count, sizeof(count)) == -1) && (errno != EAGAIN))
+        {
+            Logger::log(Warn, "unable to signal wakeup event - [%s]", strerror(errno));
+        }
+    }
 }
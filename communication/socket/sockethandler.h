@@ -2,18 +2,31 @@
 #define RDKSHELL_SOCKET_HANDLER_H
 
 #include <communicationhandler.h>
+#include <ipcschema.h>
 #include <vector>
 #include <string>
+#include <deque>
+#include <map>
 #include <sys/socket.h>
 
 namespace RdkShell
 {
     struct Socket
     {
+        Socket() : fd(-1), endpoint(), readBuffer(), writeQueue(), writeOffset(0), pendingWriteBytes(0), writeEnabled(false),
+            eventMask(RDKSHELL_IPC_DEFAULT_EVENT_MASK), subscribed(false), pendingRequests(false) {}
         int fd;
         struct sockaddr_storage endpoint;
+        std::string readBuffer; // received bytes not yet consumed as complete messages
+        std::deque<std::string> writeQueue; // framed messages waiting for the socket to become writable
+        size_t writeOffset; // bytes of the first queued message already sent
+        size_t pendingWriteBytes;
+        bool writeEnabled; // EPOLLOUT is registered for the socket
+        uint32_t eventMask; // events the connection subscribed to
+        bool subscribed;
+        bool pendingRequests; // requests may be left in the read buffer from when they were paused
     };
-  
+
     class SocketHandler:public CommunicationHandler
     {
         public:
@@ -22,25 +35,45 @@ namespace RdkShell
             bool initialize();
             void terminate();
             bool sendMessage(int id, std::string& message);
+            bool sendBinaryMessage(int id, uint16_t methodId, std::string& payload);
             bool process(int wait, std::string* message = NULL);
-            void sendEvent(std::string& event);
+            bool receiveMessage(int64_t timeoutInMicroseconds, int& id, std::string& message);
+            void sendEvent(int eventId, std::string& event);
+            bool subscribeEvent(int id, int eventId, bool subscribe);
+            void completeRequest(int id);
             void setListener(RdkShellClientListener* listener);
-      
+            void wakeup();
+            void pauseRequests(bool pause);
+
         private:
-            void acceptClient();
+            void acceptClients();
+            Socket* connection(int fd);
             bool sendToNetwork(int messageId, int fd, std::string& message);
-            bool readData(int fd, int& id, std::string* message);
+            bool sendFrame(Socket& connection, const std::string& frameHeader, const std::string& message);
+            bool flushWriteQueue(Socket& connection);
+            void enableWriteEvents(Socket& connection, bool enable);
+            uint32_t watchedEvents(bool writeEnabled);
+            bool readData(Socket& connection);
+            bool nextMessage(Socket& connection, int& id, uint16_t& methodId, std::string& message);
+            void dispatchMessages(Socket& connection);
+            void handleClientEvent(int fd, uint32_t events);
+            void closeConnection(int fd);
             void removeInactiveClients();
             bool mActive;
             int mFd;
+            int mEpollFd;
+            int mWakeupFd;
             std::string mServer;
             int mPort;
             char* mBuffer;
             struct sockaddr_storage mLocalEndpoint;
             struct sockaddr_storage mRemoteEndpoint;
             bool mIsServer;
-            std::vector<Socket> mClients;
+            Socket mConnection; // connection to the server when running as a client
+            std::map<int, Socket> mClients;
+            std::vector<int> mClientsToRemove;
             RdkShellClientListener* mListener;
+            bool mRequestsPaused;
     };
 }
 #endif //RDKSHELL_SOCKET_HANDLER_H
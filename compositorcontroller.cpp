@@ -32,8 +32,15 @@
 #include "rdkshellimage.h"
 #include "rdkshellrect.h"
 #include "cursor.h"
+#include "damagetracker.h"
+#include "gputimer.h"
+#include "tracerecorder.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <atomic>
 #include <ctime>
 #include <sys/types.h>
 #include <sys/ipc.h>
@@ -43,6 +50,7 @@
 #define RDKSHELL_DEFAULT_INACTIVITY_TIMEOUT_IN_SECONDS 15*60
 #define RDKSHELL_WILDCARD_KEY_CODE 255
 #define RDKSHELL_WATERMARK_ID 65536
+#define RDKSHELL_CLIENT_STATS_SMOOTHING 0.1
 
 namespace RdkShell
 {
@@ -55,15 +63,26 @@ namespace RdkShell
         bool propagate;
     };
 
+    struct ComposeStats
+    {
+        ComposeStats() : framesComposed(0), cpuTimeInMs(0.0), maxCpuTimeInMs(0.0), gpuTimeInMs(-1.0), gpuTimer(nullptr) {}
+        uint64_t framesComposed;
+        double cpuTimeInMs;
+        double maxCpuTimeInMs;
+        double gpuTimeInMs;
+        std::shared_ptr<GpuTimer> gpuTimer;
+    };
+
     struct CompositorInfo
     {
-        CompositorInfo() : name(), compositor(nullptr), eventListeners(), mimeType() {}
+        CompositorInfo() : name(), compositor(nullptr), eventListeners(), mimeType(), composeStats() {}
         std::string name;
         std::shared_ptr<RdkCompositor> compositor;
         std::map<uint32_t, std::vector<KeyListenerInfo>> keyListenerInfo;
         std::vector<std::shared_ptr<RdkShellEventListener>> eventListeners;
         std::string mimeType;
 	bool autoDestroy;
+        ComposeStats composeStats;
     };
 
     struct KeyInterceptInfo
@@ -150,6 +169,8 @@ namespace RdkShell
     std::shared_ptr<Cursor> gCursor = nullptr;
     KeyRepeatConfig gKeyRepeatConfig;
     std::vector<GenerateKeyEvent> gGenerateKeyEvents;
+    std::atomic<bool> gSceneDirty(true);
+    std::vector<std::vector<BatchOperation>> gPendingBatches;
 
     std::string standardizeName(const std::string& clientName)
     {
@@ -158,9 +179,40 @@ namespace RdkShell
         return displayName;
     }
 
+    struct CompositorIndexEntry
+    {
+        CompositorIndexEntry() : list(nullptr), position(0) {}
+        CompositorIndexEntry(CompositorList* compositorList, size_t listPosition) : list(compositorList), position(listPosition) {}
+        CompositorList* list;
+        size_t position;
+    };
+
+    std::unordered_map<std::string, CompositorIndexEntry> gCompositorNameIndex;
+    std::unordered_map<const RdkCompositor*, CompositorIndexEntry> gCompositorPointerIndex;
+
     /*
-        getCompositorInfo searches gCompositorList and gTopmostCompositoList for compositor info with
-        client name equal to clientName parameter.
+        rebuildCompositorIndex refreshes the name and compositor lookup tables from gCompositorList and
+        gTopmostCompositorList. It must be called after any insertion, removal or reordering of those lists
+        since the index stores list positions.
+    */
+    void rebuildCompositorIndex()
+    {
+        gCompositorNameIndex.clear();
+        gCompositorPointerIndex.clear();
+        for (CompositorList* compositorList : { &gCompositorList, &gTopmostCompositorList })
+        {
+            for (size_t position = 0; position < compositorList->size(); position++)
+            {
+                CompositorInfo& compositorInfo = (*compositorList)[position];
+                gCompositorNameIndex[compositorInfo.name] = CompositorIndexEntry(compositorList, position);
+                gCompositorPointerIndex[compositorInfo.compositor.get()] = CompositorIndexEntry(compositorList, position);
+            }
+        }
+    }
+
+    /*
+        getCompositorInfo looks up compositor info with client name equal to clientName parameter
+        in gCompositorList and gTopmostCompositoList.
         Returns true if compositor info was found in any of the lists and false otherwise.
 
         Iterator for found compositor info is stored in it parameter foundIt.
@@ -171,61 +223,42 @@ namespace RdkShell
     bool getCompositorInfo(const std::string& clientName, CompositorListIterator& foundIt,
         CompositorList** compositorList = nullptr)
     {
-        std::string stdClientName = standardizeName(clientName);
-
-        for (auto it = gCompositorList.begin(); it != gCompositorList.end(); ++it)
+        // names are stored lowercase, only standardize when needed to avoid allocating on every lookup
+        auto entry = gCompositorNameIndex.find(clientName);
+        if (entry == gCompositorNameIndex.end())
         {
-            if (it->name == stdClientName)
+            if (std::none_of(clientName.begin(), clientName.end(), [](unsigned char c){ return std::isupper(c); }))
             {
-                foundIt = it;
-
-                if (compositorList)
-                    *compositorList = &gCompositorList;
-                return true;
+                return false;
             }
-        }
-
-        for (auto it = gTopmostCompositorList.begin(); it != gTopmostCompositorList.end(); ++it)
-        {
-            if (it->name == stdClientName)
+            entry = gCompositorNameIndex.find(standardizeName(clientName));
+            if (entry == gCompositorNameIndex.end())
             {
-                foundIt = it;
-
-                if (compositorList)
-                    *compositorList = &gTopmostCompositorList;
-                return true;
+                return false;
             }
         }
 
-        return false;
+        foundIt = entry->second.list->begin() + entry->second.position;
+        if (compositorList)
+            *compositorList = entry->second.list;
+        return true;
     }
 
     /*
-        getCompositorInfo searches gCompositorList and gTopmostCompositoList for compositor info with
-        RdkCompositor equal to compositor parameter.
+        getCompositorInfo looks up compositor info with RdkCompositor equal to compositor parameter
+        in gCompositorList and gTopmostCompositoList.
         Returns true if compositor info was found in any of the lists and false otherwise.
     */
     bool getCompositorInfo(const RdkCompositor* compositor, CompositorListIterator& foundIt)
     {
-        for (auto it = gCompositorList.begin(); it != gCompositorList.end(); ++it)
-        {
-            if (it->compositor.get() == compositor)
-            {
-                foundIt = it;
-                return true;
-            }
-        }
-
-        for (auto it = gTopmostCompositorList.begin(); it != gTopmostCompositorList.end(); ++it)
+        auto entry = gCompositorPointerIndex.find(compositor);
+        if (entry == gCompositorPointerIndex.end())
         {
-            if (it->compositor.get() == compositor)
-            {
-                foundIt = it;
-                return true;
-            }
+            return false;
         }
 
-        return false;
+        foundIt = entry->second.list->begin() + entry->second.position;
+        return true;
     }
 
     size_t getNumCompositorInfo()
@@ -271,6 +304,7 @@ namespace RdkShell
     
     bool interceptKey(uint32_t keycode, uint32_t flags, uint64_t metadata, bool isPressed)
     {
+        RDKSHELL_TRACE_SPAN("input", "interceptKey");
         bool ret = false;
         if (gKeyInterceptInfoMap.end() != gKeyInterceptInfoMap.find(keycode))
         {
@@ -291,7 +325,7 @@ namespace RdkShell
                     {
                         if (info.always || info.compositorInfo.name == gFocusedCompositor.name)
                         {
-                            Logger::log(Debug, "Key %d intercepted by client %s always: %d", keycode, info.compositorInfo.name.c_str(), info.always);
+                            RDKSHELL_LOG_DEBUG("Key %d intercepted by client %s always: %d", keycode, info.compositorInfo.name.c_str(), info.always);
                             if (isPressed)
                             {
                                 info.compositorInfo.compositor->onKeyPress(keycode, flags, metadata);
@@ -341,6 +375,7 @@ namespace RdkShell
 
     void bubbleKey(uint32_t keycode, uint32_t flags, uint64_t metadata, bool isPressed)
     {
+        RDKSHELL_TRACE_SPAN("input", "bubbleKey");
         std::vector<CompositorInfo>::iterator compositorIterator = gCompositorList.begin();
         std::string focusedCompositorName = gFocusedCompositor.name;
         #ifndef RDKSHELL_ENABLE_KEYBUBBING_TOP_MODE
@@ -352,7 +387,7 @@ namespace RdkShell
           }
         }
         #else
-        Logger::log(Debug, "Key bubbling is made from top application");
+        RDKSHELL_LOG_DEBUG("Key bubbling is made from top application");
         #endif //RDKSHELL_ENABLE_KEYBUBBING_TOP_MODE
 
         bool activateCompositor = false, propagateKey = true, foundListener = false;
@@ -381,7 +416,7 @@ namespace RdkShell
 
           if ((false == isFocusedCompositor) && (true == foundListener))
           {
-            Logger::log(Debug, "Key %d sent to listener %s", keycode, compositorIterator->name.c_str());
+            RDKSHELL_LOG_DEBUG("Key %d sent to listener %s", keycode, compositorIterator->name.c_str());
             if (isPressed)
             {
               compositorIterator->compositor->onKeyPress(keycode, flags, metadata);
@@ -478,6 +513,139 @@ namespace RdkShell
         }
     }
 
+    /*
+        validateBatchOperation checks that an operation queued with applyBatch names a known client and method
+        and carries the properties the method requires, so the batch can be rejected before anything is applied
+    */
+    bool validateBatchOperation(const BatchOperation& operation)
+    {
+        CompositorListIterator it;
+        if (!getCompositorInfo(operation.client, it))
+        {
+            Logger::log(LogLevel::Warn, "batch operation %s rejected, unknown client %s", operation.method.c_str(), operation.client.c_str());
+            return false;
+        }
+
+        const char* requiredProperty = nullptr;
+        if (operation.method == "setOpacity")
+        {
+            requiredProperty = "opacity";
+        }
+        else if (operation.method == "setVisibility")
+        {
+            requiredProperty = "visible";
+        }
+        else if (operation.method == "addAnimation")
+        {
+            requiredProperty = "duration";
+        }
+        else if ((operation.method != "setBounds") && (operation.method != "setScale") && (operation.method != "moveToFront"))
+        {
+            Logger::log(LogLevel::Warn, "batch operation %s is not supported", operation.method.c_str());
+            return false;
+        }
+
+        if ((requiredProperty != nullptr) && (operation.properties.find(requiredProperty) == operation.properties.end()))
+        {
+            Logger::log(LogLevel::Warn, "batch operation %s for %s is missing %s", operation.method.c_str(), operation.client.c_str(), requiredProperty);
+            return false;
+        }
+        return true;
+    }
+
+    bool applyBatchOperation(const BatchOperation& operation)
+    {
+        const std::map<std::string, RdkShellData>& properties = operation.properties;
+        if (operation.method == "setBounds")
+        {
+            uint32_t x = 0, y = 0, width = 0, height = 0;
+            if (!CompositorController::getBounds(operation.client, x, y, width, height))
+            {
+                return false;
+            }
+            for (const auto &property : properties)
+            {
+                if (property.first == "x")
+                {
+                    x = property.second.toInteger32();
+                }
+                else if (property.first == "y")
+                {
+                    y = property.second.toInteger32();
+                }
+                else if (property.first == "w")
+                {
+                    width = property.second.toUnsignedInteger32();
+                }
+                else if (property.first == "h")
+                {
+                    height = property.second.toUnsignedInteger32();
+                }
+            }
+            return CompositorController::setBounds(operation.client, x, y, width, height);
+        }
+        else if (operation.method == "setOpacity")
+        {
+            return CompositorController::setOpacity(operation.client, properties.at("opacity").toUnsignedInteger32());
+        }
+        else if (operation.method == "setScale")
+        {
+            double scaleX = 1.0, scaleY = 1.0;
+            if (!CompositorController::getScale(operation.client, scaleX, scaleY))
+            {
+                return false;
+            }
+            auto it = properties.find("sx");
+            if (it != properties.end())
+            {
+                scaleX = it->second.toDouble();
+            }
+            it = properties.find("sy");
+            if (it != properties.end())
+            {
+                scaleY = it->second.toDouble();
+            }
+            return CompositorController::setScale(operation.client, scaleX, scaleY);
+        }
+        else if (operation.method == "moveToFront")
+        {
+            return CompositorController::moveToFront(operation.client);
+        }
+        else if (operation.method == "setVisibility")
+        {
+            return CompositorController::setVisibility(operation.client, properties.at("visible").toBoolean());
+        }
+        else if (operation.method == "addAnimation")
+        {
+            std::map<std::string, RdkShellData> animationProperties(properties);
+            double duration = animationProperties["duration"].toDouble();
+            animationProperties.erase("duration");
+            return CompositorController::addAnimation(operation.client, duration, animationProperties);
+        }
+        return false;
+    }
+
+    void applyPendingBatches()
+    {
+        if (gPendingBatches.empty())
+        {
+            return;
+        }
+
+        // every queued batch is applied within the same update so no frame is drawn with a partially applied layout
+        for (const auto& batch : gPendingBatches)
+        {
+            for (const auto& operation : batch)
+            {
+                if (!applyBatchOperation(operation))
+                {
+                    Logger::log(LogLevel::Warn, "batch operation %s failed for %s", operation.method.c_str(), operation.client.c_str());
+                }
+            }
+        }
+        gPendingBatches.clear();
+    }
+
     std::shared_ptr<RdkCompositor> CompositorController::getCompositor(const std::string& displayName)
     {
         auto lambda = [displayName](CompositorInfo& info)
@@ -622,6 +790,8 @@ namespace RdkShell
         auto compositorInfo = *it;
         compositorInfoList->erase(it);
         compositorInfoList->insert(compositorInfoList->begin(), compositorInfo);
+        rebuildCompositorIndex();
+        markDirty();
 
         return true;
     }
@@ -639,6 +809,8 @@ namespace RdkShell
         auto compositorInfo = *it;
         compositorInfoList->erase(it);
         compositorInfoList->push_back(compositorInfo);
+        rebuildCompositorIndex();
+        markDirty();
 
         return true;
     }
@@ -669,10 +841,13 @@ namespace RdkShell
 
         auto compositorInfo = *clientIt;
         targetCompositorList->erase(clientIt);
+        rebuildCompositorIndex();
 
         if (getCompositorInfo(target, targetIt))
         {
             targetCompositorList->insert(++targetIt, compositorInfo);
+            rebuildCompositorIndex();
+            markDirty();
             return true;
         }
 
@@ -768,6 +943,7 @@ namespace RdkShell
             std::cout << "adding " << clientDisplayName << " to the deleted list\n";
             gDeletedCompositors.push_back(*it);
             compositorInfoList->erase(it);
+            rebuildCompositorIndex();
             if (gFocusedCompositor.name == clientDisplayName)
             {
                 // this may be changed to next available compositor
@@ -1326,6 +1502,29 @@ namespace RdkShell
         return false;
     }
 
+    bool CompositorController::getOpaque(const std::string& client, bool& opaque)
+    {
+        CompositorListIterator it;
+        if (getCompositorInfo(client, it))
+        {
+            it->compositor->opaque(opaque);
+            return true;
+        }
+        return false;
+    }
+
+    bool CompositorController::setOpaque(const std::string& client, const bool opaque)
+    {
+        CompositorListIterator it;
+        if (getCompositorInfo(client, it))
+        {
+            it->compositor->setOpaque(opaque);
+            RdkShell::Logger::log(RdkShell::LogLevel::Information, "opaque for %s set to %s", client.c_str(), opaque ? "true" : "false");
+            return true;
+        }
+        return false;
+    }
+
     bool CompositorController::scaleToFit(const std::string& client, const int32_t x, const int32_t y, const uint32_t width, const uint32_t height)
     {
         CompositorListIterator it;
@@ -1349,6 +1548,7 @@ namespace RdkShell
 
     void CompositorController::onKeyPress(uint32_t keycode, uint32_t flags, uint64_t metadata, bool physicalKeyPress)
     {
+        RDKSHELL_TRACE_SPAN("input", "onKeyPress");
         //Logger::log(LogLevel::Information,  "key press code " << keycode << " flags " << flags << std::endl;
         double currentTime = RdkShell::seconds();
         if ((true == physicalKeyPress) && (0.0 == gLastKeyPressStartTime))
@@ -1364,7 +1564,7 @@ namespace RdkShell
 
         if ((keycode != 0) && ((keycode == gPowerKeyCode) || ((gFrontPanelButtonCode != 0) && (keycode == gFrontPanelButtonCode))) && (gPowerKeyReleaseReceived == false))
         {
-            RdkShell::Logger::log(RdkShell::LogLevel::Debug, "skip power key press");
+            RDKSHELL_LOG_DEBUG("skip power key press");
             return;
         }
 
@@ -1384,13 +1584,14 @@ namespace RdkShell
         }
         if (gRdkShellEventListener && physicalKeyPress)
         {
-            RdkShell::Logger::log(RdkShell::LogLevel::Debug, "sending the keyevent for key press");
+            RDKSHELL_LOG_DEBUG("sending the keyevent for key press");
             gRdkShellEventListener->onKeyEvent(keycode, flags, true);
         }
     }
 
     void CompositorController::onKeyRelease(uint32_t keycode, uint32_t flags, uint64_t metadata, bool physicalKeyPress)
     {
+        RDKSHELL_TRACE_SPAN("input", "onKeyRelease");
         //Logger::log(LogLevel::Information,  "key release code " << keycode << " flags " << flags << std::endl;
         if ((false == gRdkShellPowerKeyReleaseOnlyEnabled) && (keycode != 0) && ((keycode == gPowerKeyCode) || ((gFrontPanelButtonCode != 0) && (keycode == gFrontPanelButtonCode))))
         {
@@ -1429,7 +1630,7 @@ namespace RdkShell
 
         if (gRdkShellEventListener && physicalKeyPress)
         {
-            RdkShell::Logger::log(RdkShell::LogLevel::Debug, "sending the keyevent for key release");
+            RDKSHELL_LOG_DEBUG("sending the keyevent for key release");
             gRdkShellEventListener->onKeyEvent(keycode, flags, false);
         }
 
@@ -1446,7 +1647,7 @@ namespace RdkShell
 
     void CompositorController::onPointerMotion(uint32_t x, uint32_t y)
     {
-        RdkShell::Logger::log(RdkShell::LogLevel::Debug, "%s, x: %d, y: %d", __func__, x, y);
+        RDKSHELL_LOG_DEBUG("%s, x: %d, y: %d", __func__, x, y);
 
         if (gCursor)
         {
@@ -1573,10 +1774,81 @@ namespace RdkShell
             {
                 gCompositorList.insert(gCompositorList.begin(), compositorInfo);
             }
+            rebuildCompositorIndex();
         }
         return ret;
     }
 
+    static void updateOcclusion(CompositorList& compositorList, std::vector<RdkShellRect>& occluders)
+    {
+        // walk front to back and skip any compositor fully inside the bounds of an opaque one above it
+        for (auto& compositorInfo : compositorList)
+        {
+            RdkShellRect bounds;
+            compositorInfo.compositor->screenBounds(bounds);
+            bool occluded = false;
+            if (!bounds.isEmpty())
+            {
+                for (auto& occluder : occluders)
+                {
+                    if (occluder.contains(bounds))
+                    {
+                        occluded = true;
+                        break;
+                    }
+                }
+            }
+            compositorInfo.compositor->setOccluded(occluded);
+            if (!occluded && !bounds.isEmpty() && compositorInfo.compositor->coversBounds())
+            {
+                occluders.push_back(bounds);
+            }
+        }
+    }
+
+    static void drawCompositor(CompositorInfo& compositorInfo, bool& needsHolePunch, RdkShellRect& rect)
+    {
+        std::shared_ptr<RdkCompositor>& compositor = compositorInfo.compositor;
+        ComposeStats& stats = compositorInfo.composeStats;
+        compositor->clearDirty();
+
+        bool visible = true;
+        compositor->visible(visible);
+        if (!visible || compositor->isOccluded())
+        {
+            compositor->draw(needsHolePunch, rect);
+            return;
+        }
+
+        if (!stats.gpuTimer && GpuTimer::isSupported())
+        {
+            stats.gpuTimer = std::make_shared<GpuTimer>();
+        }
+        double gpuTimeInMs = 0.0;
+        if (stats.gpuTimer && stats.gpuTimer->result(gpuTimeInMs))
+        {
+            stats.gpuTimeInMs = (stats.gpuTimeInMs < 0) ? gpuTimeInMs :
+                stats.gpuTimeInMs + (gpuTimeInMs - stats.gpuTimeInMs) * RDKSHELL_CLIENT_STATS_SMOOTHING;
+        }
+
+        double startTime = RdkShell::milliseconds();
+        if (stats.gpuTimer)
+        {
+            stats.gpuTimer->begin();
+        }
+        compositor->draw(needsHolePunch, rect);
+        if (stats.gpuTimer)
+        {
+            stats.gpuTimer->end();
+        }
+        double cpuTimeInMs = RdkShell::milliseconds() - startTime;
+
+        stats.cpuTimeInMs = (stats.framesComposed == 0) ? cpuTimeInMs :
+            stats.cpuTimeInMs + (cpuTimeInMs - stats.cpuTimeInMs) * RDKSHELL_CLIENT_STATS_SMOOTHING;
+        stats.maxCpuTimeInMs = std::max(stats.maxCpuTimeInMs, cpuTimeInMs);
+        stats.framesComposed++;
+    }
+
     static void drawWatermarkImages(RdkShellRect rect, bool drawWithRect=true)
     {
         if (!gShowWatermarkImage)
@@ -1613,14 +1885,20 @@ namespace RdkShell
             reverseIterator->compositor->displayName(compositorName);
             std::cout << "rendering deleted compositor " << compositorName << std::endl;
             reverseIterator->compositor->draw(needsHolePunch, rect);
+            DamageTracker::instance()->applyScissor();
         }
         gDeletedCompositors.clear();
 
+        std::vector<RdkShellRect> occluders;
+        updateOcclusion(gTopmostCompositorList, occluders);
+        updateOcclusion(gCompositorList, occluders);
+
         for (auto reverseIterator = gCompositorList.rbegin(); reverseIterator != gCompositorList.rend(); reverseIterator++)
         {
             bool needsHolePunch = false;
             RdkShellRect rect;
-            reverseIterator->compositor->draw(needsHolePunch, rect);
+            drawCompositor(*reverseIterator, needsHolePunch, rect);
+            DamageTracker::instance()->applyScissor();
             if (needsHolePunch && !gAlwaysShowWatermarkImageOnTop)
             {
                 drawWatermarkImages(rect, true);
@@ -1631,7 +1909,8 @@ namespace RdkShell
         {
             bool needsHolePunch = false;
             RdkShellRect rect;
-            reverseIterator->compositor->draw(needsHolePunch, rect);
+            drawCompositor(*reverseIterator, needsHolePunch, rect);
+            DamageTracker::instance()->applyScissor();
         }
 
         if (gAlwaysShowWatermarkImageOnTop)
@@ -1657,25 +1936,90 @@ namespace RdkShell
 
         if (gShowSplashImage && gSplashImage != nullptr)
         {
-            if (gSplashDisplayTimeInSeconds > 0)
+            gSplashImage->draw();
+        }
+        gSceneDirty = false;
+	return true;
+    }
+
+    void CompositorController::markDirty()
+    {
+        gSceneDirty = true;
+    }
+
+    bool CompositorController::needsRedraw()
+    {
+        if (gSceneDirty || !gDeletedCompositors.empty())
+        {
+            return true;
+        }
+
+        for (auto& compositorInfo : gCompositorList)
+        {
+            if (compositorInfo.compositor->isDirty())
             {
-                uint32_t splashShownTime = (uint32_t)(RdkShell::seconds() - gSplashStartTime);
-                if (splashShownTime > gSplashDisplayTimeInSeconds)
-                {
-                    RdkShell::Logger::log(RdkShell::LogLevel::Information, "hiding the splash screen after a timeout: %u", gSplashDisplayTimeInSeconds );
-                    hideSplashScreen();
-                }
-                else
-                {
-                    gSplashImage->draw();
-                }
+                return true;
             }
-            else
+        }
+
+        for (auto& compositorInfo : gTopmostCompositorList)
+        {
+            if (compositorInfo.compositor->isDirty())
             {
-                gSplashImage->draw();
+                return true;
             }
         }
-	return true;
+
+        if (gCursor && gCursor->isDirty())
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool CompositorController::damageRegion(RdkShellRect& rect)
+    {
+        // returns false when the whole screen needs to be recomposed
+        rect = RdkShellRect();
+        if (gSceneDirty)
+        {
+            return false;
+        }
+
+        for (auto& compositorInfo : gDeletedCompositors)
+        {
+            RdkShellRect drawnRect;
+            compositorInfo.compositor->drawnRect(drawnRect);
+            rect.unite(drawnRect);
+        }
+
+        for (auto& compositorInfo : gCompositorList)
+        {
+            if (compositorInfo.compositor->isDirty())
+            {
+                RdkShellRect damageRect;
+                compositorInfo.compositor->damageRect(damageRect);
+                rect.unite(damageRect);
+            }
+        }
+
+        for (auto& compositorInfo : gTopmostCompositorList)
+        {
+            if (compositorInfo.compositor->isDirty())
+            {
+                RdkShellRect damageRect;
+                compositorInfo.compositor->damageRect(damageRect);
+                rect.unite(damageRect);
+            }
+        }
+
+        if (gCursor && gCursor->isDirty())
+        {
+            RdkShellRect damageRect;
+            gCursor->damageRect(damageRect);
+            rect.unite(damageRect);
+        }
+        return true;
     }
 
     bool CompositorController::addAnimation(const std::string& client, double duration, std::map<std::string, RdkShellData> &animationProperties)
@@ -1771,10 +2115,21 @@ namespace RdkShell
     bool CompositorController::update()
     {
         resolveWaitingEasterEggs();
+        applyPendingBatches();
         RdkShell::Animator::instance()->animate();
         updateKeyRepeat();
 	updateGenerateKeyEvents();
 
+        if (gShowSplashImage && gSplashDisplayTimeInSeconds > 0)
+        {
+            uint32_t splashShownTime = (uint32_t)(RdkShell::seconds() - gSplashStartTime);
+            if (splashShownTime > gSplashDisplayTimeInSeconds)
+            {
+                RdkShell::Logger::log(RdkShell::LogLevel::Information, "hiding the splash screen after a timeout: %u", gSplashDisplayTimeInSeconds );
+                hideSplashScreen();
+            }
+        }
+
         if (gEnableInactivityReporting)
         {
             double currentTime = RdkShell::seconds();
@@ -1933,6 +2288,7 @@ namespace RdkShell
                 {
                     gCompositorList.insert(gCompositorList.begin(), compositorInfo);
                 }
+                rebuildCompositorIndex();
             }
             return true;
         }
@@ -2036,6 +2392,7 @@ namespace RdkShell
             iter->image = nullptr;
         }
         gRdkShellWatermarkImage = nullptr;
+        markDirty();
         return true;
     }
 
@@ -2047,8 +2404,18 @@ namespace RdkShell
             const char* waterMarkFile = getenv("RDKSHELL_WATERMARK_IMAGE_PNG");
             if (waterMarkFile)
             {
+                uint32_t screenWidth = 0;
+                uint32_t screenHeight = 0;
+                RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
                 gRdkShellWatermarkImage = std::make_shared<RdkShell::Image>();
-                bool imageLoaded = gRdkShellWatermarkImage->loadLocalFile(waterMarkFile);
+                bool imageLoaded = gRdkShellWatermarkImage->loadLocalFileAsync(waterMarkFile, [](bool success)
+                {
+                    if (!success)
+                    {
+                        gRdkShellWatermarkImage = nullptr;
+                    }
+                    markDirty();
+                }, screenWidth, screenHeight);
                 if (!imageLoaded)
                 {
                     RdkShell::Logger::log(RdkShell::LogLevel::Error, "error loading watermark image: %s", waterMarkFile);
@@ -2061,6 +2428,7 @@ namespace RdkShell
             }
         }
         gShowWatermarkImage = true;
+        markDirty();
         return true;
     }
 
@@ -2068,6 +2436,7 @@ namespace RdkShell
     {
         gShowFullScreenImage = false;
         gFullScreenImage = nullptr;
+        markDirty();
         return true;
     }
 
@@ -2080,17 +2449,31 @@ namespace RdkShell
         }
         else
         {
+            // the image is decoded in the background, at no more than the screen size, and shows up once it is uploaded
+            uint32_t screenWidth = 0;
+            uint32_t screenHeight = 0;
+            RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
             gFullScreenImage = std::make_shared<RdkShell::Image>();
-            bool imageLoaded = gFullScreenImage->loadLocalFile(file);
+            bool imageLoaded = gFullScreenImage->loadLocalFileAsync(file, [](bool success)
+            {
+                if (!success)
+                {
+                    gShowFullScreenImage = false;
+                    gFullScreenImage = nullptr;
+                    gCurrentFullScreenImage = "";
+                }
+                markDirty();
+            }, screenWidth, screenHeight);
             if (!imageLoaded)
             {
-                RdkShell::Logger::log(RdkShell::LogLevel::Error, "error loading fullscreen image: %s", file);
+                RdkShell::Logger::log(RdkShell::LogLevel::Error, "error loading fullscreen image: %s", file.c_str());
                 gFullScreenImage = nullptr;
                 return false;
             }
         }
         gShowFullScreenImage = true;
         gCurrentFullScreenImage = file;
+        markDirty();
         return true;
     }
 
@@ -2098,6 +2481,7 @@ namespace RdkShell
     {
         gShowSplashImage = false;
         gSplashImage = nullptr;
+        markDirty();
         return true;
     }
 
@@ -2109,8 +2493,21 @@ namespace RdkShell
             const char* splashFile = getenv("RDKSHELL_SPLASH_IMAGE_JPEG");
             if (splashFile)
             {
+                // the display time starts when the decoded splash image can be drawn
+                uint32_t screenWidth = 0;
+                uint32_t screenHeight = 0;
+                RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
                 gSplashImage = std::make_shared<RdkShell::Image>();
-                gShowSplashImage = gSplashImage->loadLocalFile(splashFile);
+                gShowSplashImage = gSplashImage->loadLocalFileAsync(splashFile, [](bool success)
+                {
+                    if (!success)
+                    {
+                        gShowSplashImage = false;
+                        gSplashImage = nullptr;
+                    }
+                    gSplashStartTime = RdkShell::seconds();
+                    markDirty();
+                }, screenWidth, screenHeight);
                 if (!gShowSplashImage)
                 {
                     RdkShell::Logger::log(RdkShell::LogLevel::Error, "error loading splash image: %s", splashFile);
@@ -2125,6 +2522,7 @@ namespace RdkShell
             }
             gSplashDisplayTimeInSeconds = displayTimeInSeconds;
             gSplashStartTime = RdkShell::seconds();
+            markDirty();
         }
         return true;
     }
@@ -2273,6 +2671,8 @@ namespace RdkShell
         auto compositorInfo = *it;
         compositorInfoList->erase(it);
         targetList->insert(targetList->begin(), compositorInfo);
+        rebuildCompositorIndex();
+        markDirty();
 
         if (topmost && focus)
         {
@@ -2386,6 +2786,7 @@ namespace RdkShell
                     iter->image = std::make_shared<RdkShell::Image>();
                 }
                 iter->image->loadImageData(imageData, imageSize);
+                markDirty();
                 break;
             }
         }
@@ -2441,7 +2842,8 @@ namespace RdkShell
         }
         WatermarkImage image(imageId, zorder);
         bool ret = insertWatermarkImage(image);
-        RdkShell::Logger::log(RdkShell::LogLevel::Debug, "watermark with image id %d created", imageId);
+        markDirty();
+        RDKSHELL_LOG_DEBUG("watermark with image id %d created", imageId);
         return ret;
     }
 
@@ -2460,6 +2862,7 @@ namespace RdkShell
         {
             iter->image == nullptr;
             gWatermarkImages.erase(iter);
+            markDirty();
             ret = true;
         }
         else
@@ -2487,12 +2890,14 @@ namespace RdkShell
         image.image = iter->image;
         gWatermarkImages.erase(iter);
         insertWatermarkImage(image);
+        markDirty();
         return true;
     }
 
     bool CompositorController::alwaysShowWatermarkImageOnTop(bool show)
     {
         gAlwaysShowWatermarkImageOnTop = show;
+        markDirty();
         return true;
     }
 
@@ -2629,4 +3034,43 @@ namespace RdkShell
         return true;
     }
 
+    bool CompositorController::getClientStats(std::vector<ClientStats>& stats)
+    {
+        stats.clear();
+        for (CompositorList* compositorList : { &gTopmostCompositorList, &gCompositorList })
+        {
+            for (auto& compositorInfo : *compositorList)
+            {
+                ClientStats clientStats;
+                clientStats.client = compositorInfo.name;
+                clientStats.framesComposed = compositorInfo.composeStats.framesComposed;
+                clientStats.cpuTimeInMs = compositorInfo.composeStats.cpuTimeInMs;
+                clientStats.maxCpuTimeInMs = compositorInfo.composeStats.maxCpuTimeInMs;
+                clientStats.gpuTimeInMs = compositorInfo.composeStats.gpuTimeInMs;
+                clientStats.surfaceCount = compositorInfo.compositor->getSurfaceCount();
+                clientStats.frameBufferMemory = compositorInfo.compositor->getFrameBufferMemory();
+                stats.push_back(clientStats);
+            }
+        }
+
+        // most expensive clients first, like top
+        std::sort(stats.begin(), stats.end(), [](const ClientStats& a, const ClientStats& b)
+        {
+            return a.cpuTimeInMs > b.cpuTimeInMs;
+        });
+        return true;
+    }
+
+    bool CompositorController::applyBatch(const std::vector<BatchOperation>& operations)
+    {
+        for (const auto& operation : operations)
+        {
+            if (!validateBatchOperation(operation))
+            {
+                return false;
+            }
+        }
+        gPendingBatches.push_back(operations);
+        return true;
+    }
 }
@@ -46,6 +46,26 @@ namespace RdkShell
         bool visible;
     };
 
+    struct ClientStats
+    {
+        ClientStats() : client(), framesComposed(0), cpuTimeInMs(0.0), maxCpuTimeInMs(0.0), gpuTimeInMs(-1.0),
+            surfaceCount(0), frameBufferMemory(0) {}
+        std::string client;
+        uint64_t framesComposed;
+        double cpuTimeInMs; // moving average of the time spent composing the client each frame
+        double maxCpuTimeInMs;
+        double gpuTimeInMs; // moving average, -1 when gpu timer queries are not available
+        uint32_t surfaceCount;
+        uint64_t frameBufferMemory;
+    };
+
+    struct BatchOperation
+    {
+        std::string method; // setBounds, setOpacity, setScale, moveToFront, setVisibility or addAnimation
+        std::string client;
+        std::map<std::string, RdkShellData> properties;
+    };
+
     class CompositorController
     {
         public:
@@ -84,6 +104,8 @@ namespace RdkShell
             static bool setScale(const std::string& client, double scaleX, double scaleY);
             static bool getHolePunch(const std::string& client, bool& holePunch);
             static bool setHolePunch(const std::string& client, const bool holePunch);
+            static bool getOpaque(const std::string& client, bool& opaque);
+            static bool setOpaque(const std::string& client, const bool opaque);
             static bool scaleToFit(const std::string& client, const int32_t x, const int32_t y, const uint32_t width, const uint32_t height);
             static void onKeyPress(uint32_t keycode, uint32_t flags, uint64_t metadata, bool physicalKeyPress=true);
             static void onKeyRelease(uint32_t keycode, uint32_t flags, uint64_t metadata, bool physicalKeyPress=true);
@@ -117,6 +139,9 @@ namespace RdkShell
             static bool showFullScreenImage(std::string file);
             static bool draw();
             static bool update();
+            static void markDirty();
+            static bool needsRedraw();
+            static bool damageRegion(RdkShellRect& rect);
             static bool setLogLevel(const std::string level);
             static bool getLogLevel(std::string& level);
             static bool setTopmost(const std::string& client, bool topmost, bool focus = false);
@@ -148,6 +173,8 @@ namespace RdkShell
             static bool isErmEnabled();
             static bool getClientInfo(const std::string& client, ClientInfo& ci);
             static bool setClientInfo(const std::string& client, const ClientInfo& ci);
+            static bool getClientStats(std::vector<ClientStats>& stats);
+            static bool applyBatch(const std::vector<BatchOperation>& operations);
     };
 }
 
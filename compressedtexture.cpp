@@ -0,0 +1,346 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "compressedtexture.h"
+#include "imagedecoder.h"
+#include "logger.h"
+
+#include <set>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#define RDKSHELL_PKM_HEADER_SIZE 16
+#define RDKSHELL_KTX_HEADER_SIZE 64
+#define RDKSHELL_GL_ETC1_RGB8_OES 0x8D64
+
+namespace RdkShell
+{
+    struct CompressedFormat
+    {
+        GLenum format;
+        uint32_t blockWidth;
+        uint32_t blockHeight;
+        uint32_t blockSize;
+    };
+
+    static const CompressedFormat sCompressedFormats[] =
+    {
+        { RDKSHELL_GL_ETC1_RGB8_OES, 4, 4, 8 },
+        { 0x9274, 4, 4, 8 }, // GL_COMPRESSED_RGB8_ETC2
+        { 0x9275, 4, 4, 8 }, // GL_COMPRESSED_SRGB8_ETC2
+        { 0x9276, 4, 4, 8 }, // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+        { 0x9277, 4, 4, 8 }, // GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
+        { 0x9278, 4, 4, 16 }, // GL_COMPRESSED_RGBA8_ETC2_EAC
+        { 0x9279, 4, 4, 16 }, // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+        { 0x93B0, 4, 4, 16 }, // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+        { 0x93B1, 5, 4, 16 },
+        { 0x93B2, 5, 5, 16 },
+        { 0x93B3, 6, 5, 16 },
+        { 0x93B4, 6, 6, 16 },
+        { 0x93B5, 8, 5, 16 },
+        { 0x93B6, 8, 6, 16 },
+        { 0x93B7, 8, 8, 16 },
+        { 0x93B8, 10, 5, 16 },
+        { 0x93B9, 10, 6, 16 },
+        { 0x93BA, 10, 8, 16 },
+        { 0x93BB, 10, 10, 16 },
+        { 0x93BC, 12, 10, 16 },
+        { 0x93BD, 12, 12, 16 } // GL_COMPRESSED_RGBA_ASTC_12x12_KHR
+    };
+
+    // pkm data types, version 1 files only have etc1
+    static const GLenum sPkmFormats[] =
+    {
+        RDKSHELL_GL_ETC1_RGB8_OES,
+        0x9274, // rgb etc2
+        0, // old rgba etc2, not supported
+        0x9278, // rgba etc2
+        0x9276 // rgba1 etc2
+    };
+
+    static const unsigned char sKtxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // render thread only
+    static std::set<GLenum> sSupportedFormats;
+    static bool sSupportedFormatsQueried = false;
+
+    static const CompressedFormat* findCompressedFormat(GLenum format)
+    {
+        for (size_t i = 0; i < sizeof(sCompressedFormats)/sizeof(sCompressedFormats[0]); i++)
+        {
+            if (sCompressedFormats[i].format == format)
+            {
+                return &sCompressedFormats[i];
+            }
+        }
+        return NULL;
+    }
+
+    static uint16_t readBigEndian16(const unsigned char* data)
+    {
+        return (uint16_t)((data[0] << 8) | data[1]);
+    }
+
+    static uint32_t readKtx32(const unsigned char* data, bool swap)
+    {
+        uint32_t value = 0;
+        memcpy(&value, data, sizeof(value));
+        return swap ? __builtin_bswap32(value) : value;
+    }
+
+    static bool hasExtension(const std::string& fileName, const char* extension)
+    {
+        size_t length = strlen(extension);
+        return (fileName.length() > length) && (strcasecmp(fileName.c_str() + fileName.length() - length, extension) == 0);
+    }
+
+    static std::string baseName(const std::string& fileName)
+    {
+        size_t dot = fileName.rfind('.');
+        size_t slash = fileName.rfind('/');
+        if ((dot == std::string::npos) || ((slash != std::string::npos) && (dot < slash)))
+        {
+            return fileName;
+        }
+        return fileName.substr(0, dot);
+    }
+
+    static bool readHeader(const std::string& fileName, CompressedTextureInfo& info)
+    {
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (NULL == file)
+        {
+            return false;
+        }
+        unsigned char header[RDKSHELL_KTX_HEADER_SIZE];
+        size_t size = fread(header, 1, sizeof(header), file);
+        fclose(file);
+        return CompressedTexture::parse(header, size, info);
+    }
+
+    bool CompressedTexture::isCompressedFile(const std::string& fileName)
+    {
+        return hasExtension(fileName, ".ktx") || hasExtension(fileName, ".pkm");
+    }
+
+    size_t CompressedTexture::expectedSize(GLenum format, uint32_t width, uint32_t height)
+    {
+        const CompressedFormat* compressedFormat = findCompressedFormat(format);
+        if (NULL == compressedFormat)
+        {
+            return 0;
+        }
+        uint64_t blocksWide = ((uint64_t)width + compressedFormat->blockWidth - 1) / compressedFormat->blockWidth;
+        uint64_t blocksHigh = ((uint64_t)height + compressedFormat->blockHeight - 1) / compressedFormat->blockHeight;
+        uint64_t blocks = blocksWide * blocksHigh;
+        if (blocks > SIZE_MAX / compressedFormat->blockSize)
+        {
+            return 0;
+        }
+        return (size_t)(blocks * compressedFormat->blockSize);
+    }
+
+    bool CompressedTexture::parse(const unsigned char* data, size_t size, CompressedTextureInfo& info)
+    {
+        if ((size >= RDKSHELL_PKM_HEADER_SIZE) && (memcmp(data, "PKM ", 4) == 0))
+        {
+            uint16_t type = readBigEndian16(data + 6);
+            bool version1 = (memcmp(data + 4, "10", 2) == 0);
+            if (!version1 && (memcmp(data + 4, "20", 2) != 0))
+            {
+                return false;
+            }
+            if ((version1 && (type != 0)) || (type >= sizeof(sPkmFormats)/sizeof(sPkmFormats[0])) || (0 == sPkmFormats[type]))
+            {
+                return false;
+            }
+            info.format = sPkmFormats[type];
+            info.width = readBigEndian16(data + 12);
+            info.height = readBigEndian16(data + 14);
+            info.dataOffset = RDKSHELL_PKM_HEADER_SIZE;
+            info.dataSize = expectedSize(info.format, info.width, info.height);
+            return (info.width > 0) && (info.height > 0);
+        }
+
+        if ((size >= RDKSHELL_KTX_HEADER_SIZE) && (memcmp(data, sKtxIdentifier, sizeof(sKtxIdentifier)) == 0))
+        {
+            uint32_t endianness = readKtx32(data + 12, false);
+            if ((endianness != 0x04030201) && (endianness != 0x01020304))
+            {
+                return false;
+            }
+            bool swap = (endianness == 0x01020304);
+            uint32_t glType = readKtx32(data + 16, swap);
+            info.format = readKtx32(data + 28, swap);
+            info.width = readKtx32(data + 36, swap);
+            info.height = readKtx32(data + 40, swap);
+            uint32_t depth = readKtx32(data + 44, swap);
+            uint32_t arrayElements = readKtx32(data + 48, swap);
+            uint32_t faces = readKtx32(data + 52, swap);
+            uint32_t keyValueBytes = readKtx32(data + 60, swap);
+            // only plain compressed 2d textures
+            if ((glType != 0) || (depth > 1) || (arrayElements > 1) || (faces != 1) || (NULL == findCompressedFormat(info.format)) ||
+                (info.width == 0) || (info.height == 0) || (0 == expectedSize(info.format, info.width, info.height)))
+            {
+                return false;
+            }
+            // the key value data is followed by the size of level 0, compared without overflowing size_t
+            const size_t imageSizeBytes = sizeof(uint32_t);
+            if (keyValueBytes > SIZE_MAX - RDKSHELL_KTX_HEADER_SIZE - imageSizeBytes)
+            {
+                return false;
+            }
+            info.dataOffset = RDKSHELL_KTX_HEADER_SIZE + (size_t)keyValueBytes + imageSizeBytes;
+            if ((size >= RDKSHELL_KTX_HEADER_SIZE + imageSizeBytes) && (keyValueBytes <= size - RDKSHELL_KTX_HEADER_SIZE - imageSizeBytes))
+            {
+                info.dataSize = readKtx32(data + RDKSHELL_KTX_HEADER_SIZE + keyValueBytes, swap);
+            }
+            else
+            {
+                info.dataSize = expectedSize(info.format, info.width, info.height);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool CompressedTexture::load(const std::string& fileName, DecodedImage& image)
+    {
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (NULL == file)
+        {
+            Logger::log(LogLevel::Error, "unable to open %s", fileName.c_str());
+            return false;
+        }
+        std::vector<unsigned char> data;
+        unsigned char buffer[64 * 1024];
+        size_t bytesRead = 0;
+        while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + bytesRead);
+        }
+        fclose(file);
+
+        CompressedTextureInfo info;
+        if (!parse(data.data(), data.size(), info) || (info.dataOffset > data.size()) || (info.dataSize > data.size() - info.dataOffset) ||
+            (info.dataSize < expectedSize(info.format, info.width, info.height)))
+        {
+            Logger::log(LogLevel::Error, "%s is not a supported compressed texture", fileName.c_str());
+            return false;
+        }
+        // a ktx image size may include padding, only the blocks of level 0 are uploaded
+        size_t imageSize = expectedSize(info.format, info.width, info.height);
+        image.pixels = (unsigned char*) malloc(imageSize);
+        if (NULL == image.pixels)
+        {
+            return false;
+        }
+        memcpy(image.pixels, data.data() + info.dataOffset, imageSize);
+        image.width = info.width;
+        image.height = info.height;
+        image.compressedFormat = info.format;
+        image.compressedSize = imageSize;
+        return true;
+    }
+
+    std::string CompressedTexture::selectFile(const std::string& fileName, CompressedFormatSupport isSupported)
+    {
+        std::string base = baseName(fileName);
+        std::vector<std::string> compressedFiles;
+        if (isCompressedFile(fileName))
+        {
+            compressedFiles.push_back(fileName);
+        }
+        else
+        {
+            compressedFiles.push_back(base + ".ktx");
+            compressedFiles.push_back(base + ".pkm");
+        }
+        for (const std::string& compressedFile : compressedFiles)
+        {
+            CompressedTextureInfo info;
+            if (readHeader(compressedFile, info) && isSupported(info.format))
+            {
+                return compressedFile;
+            }
+        }
+
+        if (isCompressedFile(fileName))
+        {
+            const char* fallbackExtensions[] = { ".png", ".jpg", ".jpeg", ".bmp" };
+            for (const char* extension : fallbackExtensions)
+            {
+                std::string fallbackFile = base + extension;
+                if (access(fallbackFile.c_str(), R_OK) == 0)
+                {
+                    Logger::log(LogLevel::Information, "%s is not supported by the gpu, decoding %s instead", fileName.c_str(), fallbackFile.c_str());
+                    return fallbackFile;
+                }
+            }
+        }
+        return fileName;
+    }
+
+    bool CompressedTexture::isFormatSupported(GLenum format)
+    {
+        if (!sSupportedFormatsQueried)
+        {
+            sSupportedFormatsQueried = true;
+            GLint formatCount = 0;
+            glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+            if (formatCount > 0)
+            {
+                std::vector<GLint> formats(formatCount);
+                glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+                sSupportedFormats.insert(formats.begin(), formats.end());
+            }
+            // some drivers only report etc1 through the extension
+            const char* extensions = (const char*) glGetString(GL_EXTENSIONS);
+            if ((NULL != extensions) && (NULL != strstr(extensions, "GL_OES_compressed_ETC1_RGB8_texture")))
+            {
+                sSupportedFormats.insert(RDKSHELL_GL_ETC1_RGB8_OES);
+            }
+        }
+        return sSupportedFormats.find(format) != sSupportedFormats.end();
+    }
+
+    bool CompressedTexture::upload(const DecodedImage& image)
+    {
+        // errors left behind by earlier calls are not reported for this texture
+        while (glGetError() != GL_NO_ERROR)
+        {
+        }
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, image.compressedFormat, image.width, image.height, 0, image.compressedSize, image.pixels);
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR)
+        {
+            Logger::log(LogLevel::Error, "unable to upload a %dx%d texture in compressed format 0x%X: glGetError() = %X", image.width, image.height,
+                image.compressedFormat, error);
+            // the driver reported the format but rejects it, later images fall back to the files decoded in software
+            isFormatSupported(image.compressedFormat);
+            sSupportedFormats.erase(image.compressedFormat);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,68 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <functional>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace RdkShell
+{
+    struct DecodedImage;
+
+    struct CompressedTextureInfo
+    {
+        CompressedTextureInfo() : format(0), width(0), height(0), dataOffset(0), dataSize(0) {}
+        GLenum format;
+        uint32_t width;
+        uint32_t height;
+        size_t dataOffset; // first mipmap level, the only one used
+        size_t dataSize;
+    };
+
+    typedef std::function<bool(GLenum format)> CompressedFormatSupport;
+
+    /*
+        CompressedTexture reads etc1, etc2 and astc textures from pkm and ktx (version 1) containers so they are
+        uploaded as they are, without decoding. the parsing and the choice of file do not need a gpu.
+    */
+    class CompressedTexture
+    {
+    public:
+        static bool isCompressedFile(const std::string& fileName);
+        // data may stop after the header, the size of the texture data is then computed from the format
+        static bool parse(const unsigned char* data, size_t size, CompressedTextureInfo& info);
+        // reads the file into image, level 0 only, with compressedFormat set
+        static bool load(const std::string& fileName, DecodedImage& image);
+        static size_t expectedSize(GLenum format, uint32_t width, uint32_t height);
+        /*
+            picks the file to load for an image: a compressed file in a format the gpu supports, either the file
+            itself or a .ktx or .pkm next to it, otherwise the file itself or, for a compressed file, a .png, .jpg
+            or .bmp next to it that is decoded in software
+        */
+        static std::string selectFile(const std::string& fileName, CompressedFormatSupport isSupported);
+        // render thread only, asks the gles driver once
+        static bool isFormatSupported(GLenum format);
+        // render thread only, uploads level 0 into the bound texture. a format the driver rejects is no longer supported
+        static bool upload(const DecodedImage& image);
+    };
+}
@@ -37,6 +37,8 @@ namespace RdkShell
         , mOffsetX(0), mOffsetY(0)
         , mLastUpdateTime(0.0)
         , mIsVisible(false)
+        , mIsDirty(true)
+        , mWasDisplayed(false)
     {
         load(fileName);
     }
@@ -50,6 +52,7 @@ namespace RdkShell
             return mIsLoaded;
         }
 
+        mIsDirty = true;
         mCursorImage = std::make_unique<RdkShell::Image>();
         mIsLoaded = mCursorImage->loadLocalFile(cursorImageName, &mWidth, &mHeight);
         if (!mIsLoaded)
@@ -76,6 +79,7 @@ namespace RdkShell
     {
         mWidth = width;
         mHeight = height;
+        mIsDirty = true;
     }
 
     void Cursor::getSize(uint32_t& width, uint32_t& height)
@@ -88,6 +92,7 @@ namespace RdkShell
     {
         mOffsetX = x;
         mOffsetY = y;
+        mIsDirty = true;
     }
 
     void Cursor::getOffset(int32_t& x,  int32_t& y)
@@ -98,7 +103,7 @@ namespace RdkShell
 
     void Cursor::setPosition(int32_t x, int32_t y)
     {
-        Logger::log(LogLevel::Debug,  "Cursor::setPosition(%d, %d), mIsLoaded: %d, cursor: %p", x, y, mIsLoaded, this);
+        RDKSHELL_LOG_DEBUG("Cursor::setPosition(%d, %d), mIsLoaded: %d, cursor: %p", x, y, mIsLoaded, this);
      
         uint32_t screenWidth = 0;
         uint32_t screenHeight = 0;
@@ -107,15 +112,17 @@ namespace RdkShell
         mX = x;
         mY = screenHeight - y;
         mLastUpdateTime = RdkShell::seconds();
+        mIsDirty = true;
     }
 
     void Cursor::draw()
     {
-        if (!mIsLoaded || !mIsVisible)
-            return;
-
-        if (RdkShell::seconds() - mLastUpdateTime < mInactivityDuration)
+        mIsDirty = false;
+        mWasDisplayed = isDisplayed();
+        mDrawnRect = RdkShellRect();
+        if (mWasDisplayed)
         {
+            screenBounds(mDrawnRect);
             mCursorImage->setBounds(mX - mOffsetX, mY - mHeight + mOffsetY, mWidth, mHeight);
             mCursorImage->draw(true);
         }
@@ -124,11 +131,56 @@ namespace RdkShell
     void Cursor::show()
     {
         mIsVisible = true;
+        mIsDirty = true;
     }
 
     void Cursor::hide()
     {
         mIsVisible = false;
+        mIsDirty = true;
+    }
+
+    bool Cursor::isDirty()
+    {
+        // the cursor also needs a new frame when it times out due to inactivity
+        return (mIsDirty && (mWasDisplayed || isDisplayed())) || (mWasDisplayed != isDisplayed());
+    }
+
+    void Cursor::damageRect(RdkShellRect& rect)
+    {
+        rect = mDrawnRect;
+        if (isDisplayed())
+        {
+            RdkShellRect bounds;
+            screenBounds(bounds);
+            rect.unite(bounds);
+        }
+    }
+
+    void Cursor::screenBounds(RdkShellRect& rect)
+    {
+        // the cursor image is positioned in gl coordinates, damage is tracked with the origin at the top left
+        uint32_t screenWidth = 0;
+        uint32_t screenHeight = 0;
+        RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
+
+        int64_t left = (int64_t)mX - mOffsetX;
+        int64_t top = (int64_t)screenHeight - ((int64_t)mY + mOffsetY);
+        int64_t right = left + mWidth;
+        int64_t bottom = top + mHeight;
+        left = (left < 0) ? 0 : left;
+        top = (top < 0) ? 0 : top;
+        if ((right <= left) || (bottom <= top))
+        {
+            rect = RdkShellRect();
+            return;
+        }
+        rect = RdkShellRect((uint32_t)left, (uint32_t)top, (uint32_t)(right - left), (uint32_t)(bottom - top));
+    }
+
+    bool Cursor::isDisplayed()
+    {
+        return mIsLoaded && mIsVisible && (RdkShell::seconds() - mLastUpdateTime < mInactivityDuration);
     }
 
 }
\ No newline at end of file
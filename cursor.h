@@ -23,6 +23,7 @@
 #include <memory>
 
 #include "rdkshellimage.h"
+#include "rdkshellrect.h"
 
 namespace RdkShell
 {
@@ -47,7 +48,14 @@ namespace RdkShell
         void show();
         void hide();
 
+        bool isDirty();
+        void damageRect(RdkShellRect& rect);
+
     private:
+        bool isDisplayed();
+        void screenBounds(RdkShellRect& rect);
+
+
         std::unique_ptr<RdkShell::Image> mCursorImage = nullptr;
         int32_t mX;
         int32_t mY;
@@ -60,5 +68,8 @@ namespace RdkShell
 
         bool mIsVisible;
         bool mIsLoaded;
+        bool mIsDirty;
+        bool mWasDisplayed; // whether the cursor was part of the last composed frame
+        RdkShellRect mDrawnRect;
     };
 }
@@ -0,0 +1,186 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "damagetracker.h"
+#include "logger.h"
+
+#include <string.h>
+#include <GLES2/gl2.h>
+
+#define RDKSHELL_MAX_DAMAGE_HISTORY 4
+
+namespace RdkShell
+{
+    DamageTracker::DamageTracker() : mPartialUpdatesEnabled(false), mExtensionsChecked(false),
+        mBufferAgeSupported(false), mPartialUpdateSupported(false), mBufferPreserved(false),
+        mSetDamageRegion(nullptr), mDamageHistory(), mRepaintRect(), mScreenHeight(0), mScissorActive(false)
+    {
+    }
+
+    DamageTracker::~DamageTracker()
+    {
+    }
+
+    DamageTracker *DamageTracker::instance()
+    {
+        static DamageTracker tracker;
+
+        return &tracker;
+    }
+
+    void DamageTracker::enablePartialUpdates(bool enable)
+    {
+        mPartialUpdatesEnabled = enable;
+        mDamageHistory.clear();
+    }
+
+    bool DamageTracker::partialUpdatesEnabled()
+    {
+        return mPartialUpdatesEnabled;
+    }
+
+    void DamageTracker::detectExtensions()
+    {
+        mExtensionsChecked = true;
+
+        EGLDisplay display = eglGetCurrentDisplay();
+        EGLSurface surface = eglGetCurrentSurface(EGL_DRAW);
+        if ((display == EGL_NO_DISPLAY) || (surface == EGL_NO_SURFACE))
+        {
+            Logger::log(LogLevel::Warn, "no current egl surface, partial updates are not available");
+            return;
+        }
+
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (extensions)
+        {
+            if (strstr(extensions, "EGL_KHR_partial_update"))
+            {
+                mSetDamageRegion = (PFNEGLSETDAMAGEREGIONKHRPROC)eglGetProcAddress("eglSetDamageRegionKHR");
+                mPartialUpdateSupported = (mSetDamageRegion != nullptr);
+            }
+            // partial update implies buffer age queries are supported as well
+            mBufferAgeSupported = mPartialUpdateSupported || (strstr(extensions, "EGL_EXT_buffer_age") != nullptr);
+        }
+
+        if (!mBufferAgeSupported)
+        {
+            // without buffer age the back buffer contents are only known when the surface preserves them
+            EGLint swapBehavior = 0;
+            if (eglSurfaceAttrib(display, surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED) &&
+                eglQuerySurface(display, surface, EGL_SWAP_BEHAVIOR, &swapBehavior))
+            {
+                mBufferPreserved = (swapBehavior == EGL_BUFFER_PRESERVED);
+            }
+        }
+
+        Logger::log(LogLevel::Information, "partial updates buffer age: %d, partial update: %d, preserved: %d",
+            mBufferAgeSupported, mPartialUpdateSupported, mBufferPreserved);
+    }
+
+    int32_t DamageTracker::bufferAge()
+    {
+        if (mBufferAgeSupported)
+        {
+            EGLint age = 0;
+            if (!eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age))
+            {
+                return 0;
+            }
+            return age;
+        }
+        return mBufferPreserved ? 1 : 0;
+    }
+
+    void DamageTracker::beginFrame(uint32_t screenWidth, uint32_t screenHeight, bool fullDamage, const RdkShellRect& frameDamage)
+    {
+        RdkShellRect screenRect(0, 0, screenWidth, screenHeight);
+        RdkShellRect damage = fullDamage ? screenRect : frameDamage;
+        damage.intersect(screenRect);
+
+        mScreenHeight = screenHeight;
+        mRepaintRect = screenRect;
+        mScissorActive = false;
+
+        if (mPartialUpdatesEnabled && !fullDamage)
+        {
+            if (!mExtensionsChecked)
+            {
+                detectExtensions();
+            }
+
+            // a back buffer of age n is missing the damage of the n-1 frames presented after it
+            int32_t age = bufferAge();
+            if ((age > 0) && ((size_t)(age - 1) <= mDamageHistory.size()))
+            {
+                mRepaintRect = damage;
+                for (int32_t i = 0; i < age - 1; i++)
+                {
+                    mRepaintRect.unite(mDamageHistory[i]);
+                }
+                mScissorActive = true;
+            }
+        }
+
+        mDamageHistory.push_front(damage);
+        if (mDamageHistory.size() > RDKSHELL_MAX_DAMAGE_HISTORY)
+        {
+            mDamageHistory.pop_back();
+        }
+
+        if (mScissorActive)
+        {
+            if (mPartialUpdateSupported && !mRepaintRect.isEmpty())
+            {
+                EGLint rect[4] = { (EGLint)mRepaintRect.x, (EGLint)(screenHeight - mRepaintRect.y - mRepaintRect.height),
+                    (EGLint)mRepaintRect.width, (EGLint)mRepaintRect.height };
+                mSetDamageRegion(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), rect, 1);
+            }
+            applyScissor();
+        }
+    }
+
+    void DamageTracker::endFrame()
+    {
+        if (mScissorActive)
+        {
+            glDisable(GL_SCISSOR_TEST);
+            mScissorActive = false;
+        }
+    }
+
+    void DamageTracker::applyScissor()
+    {
+        if (mScissorActive)
+        {
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(mRepaintRect.x, mScreenHeight - mRepaintRect.y - mRepaintRect.height, mRepaintRect.width, mRepaintRect.height);
+        }
+    }
+
+    bool DamageTracker::repaintRect(RdkShellRect& rect)
+    {
+        if (!mScissorActive)
+        {
+            return false;
+        }
+        rect = mRepaintRect;
+        return true;
+    }
+}
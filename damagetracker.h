@@ -0,0 +1,66 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <deque>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "rdkshellrect.h"
+
+namespace RdkShell
+{
+    class DamageTracker
+    {
+    public:
+        static DamageTracker *instance();
+
+        void enablePartialUpdates(bool enable);
+        bool partialUpdatesEnabled();
+
+        // decides the region of the back buffer to recompose and sets up the scissor for it.
+        // frameDamage is the area that changed since the previous frame, in screen coordinates
+        // with the origin at the top left
+        void beginFrame(uint32_t screenWidth, uint32_t screenHeight, bool fullDamage, const RdkShellRect& frameDamage);
+        void endFrame();
+
+        // reapplies the scissor after drawing code that may have changed it
+        void applyScissor();
+        bool repaintRect(RdkShellRect& rect);
+
+    private:
+        DamageTracker();
+        ~DamageTracker();
+
+        void detectExtensions();
+        int32_t bufferAge();
+
+        bool mPartialUpdatesEnabled;
+        bool mExtensionsChecked;
+        bool mBufferAgeSupported;
+        bool mPartialUpdateSupported;
+        bool mBufferPreserved;
+        PFNEGLSETDAMAGEREGIONKHRPROC mSetDamageRegion;
+        std::deque<RdkShellRect> mDamageHistory;
+        RdkShellRect mRepaintRect;
+        uint32_t mScreenHeight;
+        bool mScissorActive;
+    };
+}
@@ -23,6 +23,7 @@
 #include "linuxinput.h"
 #include "inputdevicetypes.h"
 #include "logger.h"
+#include "framestats.h"
 
 #include <iostream>
 
@@ -443,6 +444,7 @@ namespace RdkShell
         }
         mWidth = width;
         mHeight = height;
+        CompositorController::markDirty();
     }
 
     void EssosInstance::resolution(uint32_t &width, uint32_t &height)
@@ -475,11 +477,15 @@ namespace RdkShell
         enable = mKeyRepeatsEnabled;
     }
 
-    void EssosInstance::update()
+    void EssosInstance::update(bool updateDisplay)
     {
         if (mEssosContext)
         {
-            EssContextUpdateDisplay(mEssosContext);
+            if (updateDisplay)
+            {
+                FramePhaseTimer swapTimer(FramePhase::Swap);
+                EssContextUpdateDisplay(mEssosContext);
+            }
             EssContextRunEventLoopOnce(mEssosContext);
         }
     }
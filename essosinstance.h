@@ -40,7 +40,7 @@ namespace RdkShell
             void onPointerButtonPress(uint32_t keyCode, uint32_t x, uint32_t y);
             void onPointerButtonRelease(uint32_t keyCode, uint32_t x, uint32_t y);
             void onDisplaySizeChanged(uint32_t width, uint32_t height);
-            void update();
+            void update(bool updateDisplay = true);
             void resolution(uint32_t &width, uint32_t &height);
             void setResolution(uint32_t width, uint32_t height);
             void setKeyRepeats(bool enable);
@@ -19,20 +19,21 @@
 
 #include "framebufferrenderer.h"
 #include "framebuffer.h"
+#include "glprogramcache.h"
 #include "logger.h"
 
 #include <GLES2/gl2.h>
 
 namespace RdkShell
 {
-    FrameBufferRenderer::FrameBufferRenderer()
+    FrameBufferRenderer::FrameBufferRenderer() : mShaderProgram(0), mTextureLocation(-1), mResolutionLocation(-1),
+        mMatrixLocation(-1), mSizeLocation(-1), mScreenWidth(0), mScreenHeight(0), mWidth(0), mHeight(0)
     {
         createShaderProgram();
     }
 
     FrameBufferRenderer::~FrameBufferRenderer()
     {
-        glDeleteProgram(mShaderProgram);
     }
 
     FrameBufferRenderer *FrameBufferRenderer::instance()
@@ -51,34 +52,23 @@ namespace RdkShell
         glUseProgram(mShaderProgram);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, fbo->texture());
-        glUniform1i(mTextureLocation, 0);
-        glUniform2f(mResolutionLocation, screenWidth, screenHeight);
-        glUniformMatrix4fv(mMatrixLocation, 1, GL_FALSE, matrix);
-
-        // vertices in screen coordinates, origin of the blit is translated using the matrix
-        const float vertices[4][2] =
+        // the program keeps its uniforms, only the ones that changed since the last blit are set
+        if ((screenWidth != mScreenWidth) || (screenHeight != mScreenHeight))
         {
-            {0, 0},
-            {boundsWidth, 0},
-            {0, boundsHeight},
-            {boundsWidth, boundsHeight}
-        };
-
-        const float uvCoordinates[4][2] =
+            mScreenWidth = screenWidth;
+            mScreenHeight = screenHeight;
+            glUniform2f(mResolutionLocation, screenWidth, screenHeight);
+        }
+        // the unit quad is scaled to the bounds, the origin of the blit is translated using the matrix
+        if ((boundsWidth != mWidth) || (boundsHeight != mHeight))
         {
-            {0.f, 1.f},
-            {1.f, 1.f},
-            {0.f, 0.f},
-            {1.f, 0.f}
-        };
+            mWidth = boundsWidth;
+            mHeight = boundsHeight;
+            glUniform2f(mSizeLocation, boundsWidth, boundsHeight);
+        }
+        glUniformMatrix4fv(mMatrixLocation, 1, GL_FALSE, matrix);
 
-        glVertexAttribPointer(mPositionLocation, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-        glVertexAttribPointer(mUvLocation, 2, GL_FLOAT, GL_FALSE, 0, uvCoordinates);
-        glEnableVertexAttribArray(mPositionLocation);
-        glEnableVertexAttribArray(mUvLocation);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glDisableVertexAttribArray(mPositionLocation);
-        glDisableVertexAttribArray(mUvLocation);
+        GlProgramCache::instance()->drawQuad();
         glUseProgram(0);
     }
 
@@ -88,11 +78,12 @@ namespace RdkShell
             "attribute vec2 a_position; \n"
             "attribute vec2 a_uv; \n"
             "uniform vec2 u_resolution;\n"
+            "uniform vec2 u_size;\n"
             "uniform mat4 u_matrix;\n"
             "varying vec2 v_uv; \n"
             "void main() \n"
             "{ \n"
-            "  vec4 pos = u_matrix * vec4(a_position, 0, 1);\n"
+            "  vec4 pos = u_matrix * vec4(a_position * u_size, 0, 1);\n"
             "  vec4 zeroToOne = pos / vec4(u_resolution, u_resolution.x, 1);\n"
             "  vec4 zeroToTwo = zeroToOne * vec4(2.0, 2.0, 1.0, 1.0);\n"
             "  vec4 clipSpace = zeroToTwo - vec4(1.0, 1.0, 0.0, 0.0);\n"
@@ -108,73 +99,20 @@ namespace RdkShell
             "{ \n"
             "  gl_FragColor = texture2D(s_texture, v_uv); \n"
             "}\n";
-        
-        GLint status;
-
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-        glCompileShader(fragmentShader);
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &status);
 
-        if (!status)
+        mShaderProgram = GlProgramCache::instance()->program(vertexShaderSource, fragmentShaderSource);
+        if (0 == mShaderProgram)
         {
-            char errorLog[1000];
-            GLsizei errorLength;
-            glGetShaderInfoLog(fragmentShader, 1000, &errorLength, errorLog);
-
-            Logger::log(LogLevel::Error, "error compiling fragment shader: %s", errorLog);
-
-            glDeleteShader(fragmentShader);
             return;
         }
 
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-        glCompileShader(vertexShader);
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &status);
-
-        if (!status)
-        {
-            char errorLog[1000];
-            GLsizei errorLength;
-            glGetShaderInfoLog(vertexShader, 1000, &errorLength, errorLog);
-
-            Logger::log(LogLevel::Error, "error compiling vertex shader: %s", errorLog);
-
-            glDeleteShader(fragmentShader);
-            glDeleteShader(vertexShader);
-            return;
-        }
-
-        mShaderProgram = glCreateProgram();
-        glAttachShader(mShaderProgram, fragmentShader);
-        glAttachShader(mShaderProgram, vertexShader);
-
-
-        mPositionLocation = 0;
-        mUvLocation = 1;
-        glBindAttribLocation(mShaderProgram, mPositionLocation, "a_position");
-        glBindAttribLocation(mShaderProgram, mUvLocation,  "a_uv");
-
-        glLinkProgram(mShaderProgram);
-        glGetProgramiv(mShaderProgram, GL_LINK_STATUS, &status);
-
-        if (!status)
-        {
-            char errorLog[1000];
-            GLsizei errorLength;
-            glGetProgramInfoLog(mShaderProgram, 1000, &errorLength, errorLog);
-            Logger::log(LogLevel::Error, "error linking the program %s", errorLog);
-        }
-
-        // after link operation we can detach and delete the shader objects
-        glDetachShader(mShaderProgram, fragmentShader);
-        glDetachShader(mShaderProgram, vertexShader);
-        glDeleteShader(fragmentShader);
-        glDeleteShader(vertexShader);
-
         mTextureLocation = glGetUniformLocation(mShaderProgram, "s_texture");
         mResolutionLocation = glGetUniformLocation(mShaderProgram, "u_resolution");
         mMatrixLocation = glGetUniformLocation(mShaderProgram, "u_matrix");
+        mSizeLocation = glGetUniformLocation(mShaderProgram, "u_size");
+
+        glUseProgram(mShaderProgram);
+        glUniform1i(mTextureLocation, 0);
+        glUseProgram(0);
     }
 }
\ No newline at end of file
@@ -40,12 +40,17 @@ namespace RdkShell
 
         void createShaderProgram();
 
-        GLuint mShaderProgram;
+        GLuint mShaderProgram; // owned by the program cache
 
-        GLint mPositionLocation;
-        GLint mUvLocation;
         GLint mTextureLocation;
         GLint mResolutionLocation;
         GLint mMatrixLocation;
+        GLint mSizeLocation;
+
+        // uniform values the program currently holds
+        uint32_t mScreenWidth;
+        uint32_t mScreenHeight;
+        uint32_t mWidth;
+        uint32_t mHeight;
     };
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "framepacer.h"
+#include "logger.h"
+
+#include <time.h>
+#include <errno.h>
+
+#define RDKSHELL_NANOSECONDS_PER_SECOND 1000000000LL
+#define RDKSHELL_DEFAULT_PACER_FRAMERATE 40
+
+namespace RdkShell
+{
+    FramePacer::FramePacer() : mFramerate(RDKSHELL_DEFAULT_PACER_FRAMERATE),
+        mFramePeriod(RDKSHELL_NANOSECONDS_PER_SECOND / RDKSHELL_DEFAULT_PACER_FRAMERATE), mNextDeadline(0),
+        mVsyncAlignment(false), mLastPresentTime(0), mFrameCount(0), mMissedDeadlines(0)
+    {
+    }
+
+    FramePacer::~FramePacer()
+    {
+    }
+
+    FramePacer *FramePacer::instance()
+    {
+        static FramePacer pacer;
+
+        return &pacer;
+    }
+
+    int64_t FramePacer::now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((int64_t)ts.tv_sec * RDKSHELL_NANOSECONDS_PER_SECOND) + ts.tv_nsec;
+    }
+
+    void FramePacer::setFramerate(uint32_t framerate)
+    {
+        if (framerate == 0)
+        {
+            return;
+        }
+        mFramerate = framerate;
+        mFramePeriod = RDKSHELL_NANOSECONDS_PER_SECOND / framerate;
+        mNextDeadline = 0;
+    }
+
+    uint32_t FramePacer::framerate()
+    {
+        return mFramerate;
+    }
+
+    void FramePacer::enableVsyncAlignment(bool enable)
+    {
+        mVsyncAlignment = enable;
+        mLastPresentTime = 0;
+    }
+
+    void FramePacer::framePresented()
+    {
+        // essos does not expose egl presentation feedback, but with a swap interval of one the swap
+        // returns on vsync, so the time it completes is used as the phase for the following deadlines
+        if (mVsyncAlignment)
+        {
+            mLastPresentTime = now();
+        }
+    }
+
+    void FramePacer::waitForNextFrame()
+    {
+        int64_t currentTime = now();
+        mFrameCount++;
+
+        if (mNextDeadline == 0)
+        {
+            mNextDeadline = currentTime + mFramePeriod;
+        }
+        else if (mVsyncAlignment && (mLastPresentTime > 0))
+        {
+            mNextDeadline = mLastPresentTime + mFramePeriod;
+            mLastPresentTime = 0;
+        }
+        else
+        {
+            mNextDeadline += mFramePeriod;
+        }
+
+        if (currentTime > mNextDeadline)
+        {
+            // the frame overran, drop the missed slots instead of trying to catch up with back to back frames
+            int64_t missedFrames = ((currentTime - mNextDeadline) / mFramePeriod) + 1;
+            mMissedDeadlines += missedFrames;
+            mNextDeadline += missedFrames * mFramePeriod;
+        }
+
+        timespec deadline;
+        deadline.tv_sec = mNextDeadline / RDKSHELL_NANOSECONDS_PER_SECOND;
+        deadline.tv_nsec = mNextDeadline % RDKSHELL_NANOSECONDS_PER_SECOND;
+        int ret = 0;
+        do
+        {
+            ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        } while (ret == EINTR);
+
+        if (ret != 0)
+        {
+            Logger::log(LogLevel::Warn, "frame pacer sleep failed: %d", ret);
+        }
+    }
+
+    uint64_t FramePacer::frameCount()
+    {
+        return mFrameCount;
+    }
+
+    uint64_t FramePacer::missedDeadlines()
+    {
+        return mMissedDeadlines;
+    }
+}
@@ -0,0 +1,57 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace RdkShell
+{
+    class FramePacer
+    {
+    public:
+        static FramePacer *instance();
+
+        void setFramerate(uint32_t framerate);
+        uint32_t framerate();
+        void enableVsyncAlignment(bool enable);
+
+        // called right after a frame was handed to the display, used to align deadlines with vsync
+        void framePresented();
+        // sleeps until the absolute deadline of the next frame
+        void waitForNextFrame();
+
+        uint64_t frameCount();
+        uint64_t missedDeadlines();
+
+    private:
+        FramePacer();
+        ~FramePacer();
+
+        static int64_t now();
+
+        uint32_t mFramerate;
+        int64_t mFramePeriod;
+        int64_t mNextDeadline;
+        bool mVsyncAlignment;
+        int64_t mLastPresentTime;
+        uint64_t mFrameCount;
+        uint64_t mMissedDeadlines;
+    };
+}
@@ -0,0 +1,189 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "framestats.h"
+#include "framepacer.h"
+#include "rdkshell.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace RdkShell
+{
+    FrameStats::FrameStats()
+    {
+    }
+
+    FrameStats::~FrameStats()
+    {
+    }
+
+    FrameStats *FrameStats::instance()
+    {
+        static FrameStats frameStats;
+
+        return &frameStats;
+    }
+
+    const char* FrameStats::phaseName(FramePhase phase)
+    {
+        switch (phase)
+        {
+            case FramePhase::Frame:
+                return "frame";
+            case FramePhase::Update:
+                return "update";
+            case FramePhase::Compose:
+                return "compose";
+            case FramePhase::ClientCompose:
+                return "clientCompose";
+            case FramePhase::Swap:
+                return "swap";
+            case FramePhase::Ipc:
+                return "ipc";
+            default:
+                return "unknown";
+        }
+    }
+
+    void FrameStats::record(FramePhase phase, double durationInMs)
+    {
+        SampleRing& ring = mPhases[(int)phase];
+        uint64_t count = ring.count.load(std::memory_order_relaxed);
+        // a reader that sees the reused slot also sees the count published before it
+        std::atomic_thread_fence(std::memory_order_release);
+        ring.samples[count % RDKSHELL_FRAME_STATS_SAMPLE_COUNT].store((float)durationInMs, std::memory_order_relaxed);
+        ring.count.store(count + 1, std::memory_order_release);
+    }
+
+    void FrameStats::summary(FramePhase phase, FramePhaseSummary& phaseSummary)
+    {
+        SampleRing& ring = mPhases[(int)phase];
+        uint64_t resetCount = ring.resetCount.load(std::memory_order_relaxed);
+        uint64_t count = ring.count.load(std::memory_order_acquire);
+        uint64_t first = std::max<uint64_t>(resetCount, (count > RDKSHELL_FRAME_STATS_SAMPLE_COUNT) ? count - RDKSHELL_FRAME_STATS_SAMPLE_COUNT : 0);
+        std::vector<float> samples;
+        for (uint64_t index = first; index < count; index++)
+        {
+            samples.push_back(ring.samples[index % RDKSHELL_FRAME_STATS_SAMPLE_COUNT].load(std::memory_order_relaxed));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t countAfterCopy = ring.count.load(std::memory_order_relaxed);
+        uint64_t firstValid = (countAfterCopy > RDKSHELL_FRAME_STATS_SAMPLE_COUNT) ? countAfterCopy - RDKSHELL_FRAME_STATS_SAMPLE_COUNT : 0;
+        if (firstValid > first)
+        {
+            samples.erase(samples.begin(), samples.begin() + std::min<uint64_t>(firstValid - first, samples.size()));
+        }
+
+        phaseSummary = FramePhaseSummary();
+        phaseSummary.count = (count > resetCount) ? count - resetCount : 0;
+        if (samples.empty())
+        {
+            return;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double fraction)
+        {
+            size_t index = (size_t)(fraction * (samples.size() - 1) + 0.5);
+            return (double)samples[index];
+        };
+        phaseSummary.p50 = percentile(0.50);
+        phaseSummary.p95 = percentile(0.95);
+        phaseSummary.p99 = percentile(0.99);
+        phaseSummary.max = samples.back();
+    }
+
+    uint64_t FrameStats::droppedFrames()
+    {
+        return FramePacer::instance()->missedDeadlines();
+    }
+
+    void FrameStats::toJson(std::string& json)
+    {
+        rapidjson::StringBuffer buffer;
+        JsonWriter writer(buffer);
+        toJson(writer);
+        json.assign(buffer.GetString(), buffer.GetSize());
+    }
+
+    void FrameStats::toJson(JsonWriter& writer)
+    {
+        writer.StartObject();
+        writer.Key("frames");
+        writer.Uint64(FramePacer::instance()->frameCount());
+        writer.Key("droppedFrames");
+        writer.Uint64(droppedFrames());
+        writer.Key("phases");
+        writer.StartObject();
+        for (int phase = 0; phase < (int)FramePhase::Count; phase++)
+        {
+            FramePhaseSummary phaseSummary;
+            summary((FramePhase)phase, phaseSummary);
+            writer.Key(phaseName((FramePhase)phase));
+            writer.StartObject();
+            writer.Key("count");
+            writer.Uint64(phaseSummary.count);
+            writer.Key("p50");
+            writer.Double(phaseSummary.p50);
+            writer.Key("p95");
+            writer.Double(phaseSummary.p95);
+            writer.Key("p99");
+            writer.Double(phaseSummary.p99);
+            writer.Key("max");
+            writer.Double(phaseSummary.max);
+            writer.EndObject();
+        }
+        writer.EndObject();
+        writer.EndObject();
+    }
+
+    bool FrameStats::dumpToFile(const std::string& fileName)
+    {
+        std::ofstream file(fileName, std::ios::trunc);
+        if (!file.good())
+        {
+            Logger::log(LogLevel::Warn, "unable to write frame stats to %s", fileName.c_str());
+            return false;
+        }
+        std::string json;
+        toJson(json);
+        file << json << std::endl;
+        return true;
+    }
+
+    void FrameStats::reset()
+    {
+        for (int phase = 0; phase < (int)FramePhase::Count; phase++)
+        {
+            mPhases[phase].resetCount.store(mPhases[phase].count.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+
+    FramePhaseTimer::FramePhaseTimer(FramePhase phase) : mPhase(phase), mStartTime(RdkShell::milliseconds())
+    {
+    }
+
+    FramePhaseTimer::~FramePhaseTimer()
+    {
+        FrameStats::instance()->record(mPhase, RdkShell::milliseconds() - mStartTime);
+    }
+}
@@ -0,0 +1,94 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "rdkshelljson.h"
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#define RDKSHELL_FRAME_STATS_SAMPLE_COUNT 512
+
+namespace RdkShell
+{
+    enum class FramePhase
+    {
+        Frame,
+        Update,
+        Compose,
+        ClientCompose,
+        Swap,
+        Ipc,
+        Count
+    };
+
+    struct FramePhaseSummary
+    {
+        FramePhaseSummary() : count(0), p50(0.0), p95(0.0), p99(0.0), max(0.0) {}
+        uint64_t count;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    class FrameStats
+    {
+    public:
+        static FrameStats *instance();
+        static const char* phaseName(FramePhase phase);
+
+        // each phase has a single writer thread, readers copy the ring without blocking it
+        void record(FramePhase phase, double durationInMs);
+        void summary(FramePhase phase, FramePhaseSummary& phaseSummary);
+        uint64_t droppedFrames();
+        void toJson(std::string& json);
+        void toJson(JsonWriter& writer);
+        bool dumpToFile(const std::string& fileName);
+        void reset();
+
+    private:
+        FrameStats();
+        ~FrameStats();
+
+        // the writer stores a sample then publishes the count, readers drop the slots it reused while they copied
+        struct SampleRing
+        {
+            SampleRing() : count(0), resetCount(0), samples() {}
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> resetCount; // samples before it are left out of the summaries
+            std::atomic<float> samples[RDKSHELL_FRAME_STATS_SAMPLE_COUNT];
+        };
+
+        SampleRing mPhases[(int)FramePhase::Count];
+    };
+
+    class FramePhaseTimer
+    {
+    public:
+        FramePhaseTimer(FramePhase phase);
+        ~FramePhaseTimer();
+
+    private:
+        FramePhase mPhase;
+        double mStartTime;
+    };
+}
@@ -0,0 +1,154 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "glprogramcache.h"
+#include "logger.h"
+
+namespace RdkShell
+{
+    // position then uv for each vertex
+    static const float sQuadVertices[4][4] =
+    {
+        {0.f, 0.f, 0.f, 1.f},
+        {1.f, 0.f, 1.f, 1.f},
+        {0.f, 1.f, 0.f, 0.f},
+        {1.f, 1.f, 1.f, 0.f}
+    };
+
+    GlProgramCache::GlProgramCache() : mPrograms(), mQuadBuffer(0)
+    {
+    }
+
+    GlProgramCache::~GlProgramCache()
+    {
+        for (auto& program : mPrograms)
+        {
+            glDeleteProgram(program.second);
+        }
+        if (mQuadBuffer != 0)
+        {
+            glDeleteBuffers(1, &mQuadBuffer);
+        }
+    }
+
+    GlProgramCache *GlProgramCache::instance()
+    {
+        static GlProgramCache programCache;
+
+        return &programCache;
+    }
+
+    GLuint GlProgramCache::compileShader(GLenum type, const char* source)
+    {
+        GLint status;
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+        if (!status)
+        {
+            char errorLog[1000];
+            GLsizei errorLength;
+            glGetShaderInfoLog(shader, 1000, &errorLength, errorLog);
+
+            Logger::log(LogLevel::Error, "error compiling %s shader: %s", (type == GL_VERTEX_SHADER) ? "vertex" : "fragment", errorLog);
+
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    GLuint GlProgramCache::program(const char* vertexShaderSource, const char* fragmentShaderSource)
+    {
+        auto key = std::make_pair(std::string(vertexShaderSource), std::string(fragmentShaderSource));
+        auto programIterator = mPrograms.find(key);
+        if (programIterator != mPrograms.end())
+        {
+            return programIterator->second;
+        }
+
+        GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+        if (0 == fragmentShader)
+        {
+            return 0;
+        }
+        GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+        if (0 == vertexShader)
+        {
+            glDeleteShader(fragmentShader);
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, fragmentShader);
+        glAttachShader(program, vertexShader);
+        glBindAttribLocation(program, RDKSHELL_POSITION_ATTRIBUTE, "a_position");
+        glBindAttribLocation(program, RDKSHELL_UV_ATTRIBUTE, "a_uv");
+
+        GLint status;
+        glLinkProgram(program);
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+        // after link operation we can detach and delete the shader objects
+        glDetachShader(program, fragmentShader);
+        glDetachShader(program, vertexShader);
+        glDeleteShader(fragmentShader);
+        glDeleteShader(vertexShader);
+
+        if (!status)
+        {
+            char errorLog[1000];
+            GLsizei errorLength;
+            glGetProgramInfoLog(program, 1000, &errorLength, errorLog);
+            Logger::log(LogLevel::Error, "error linking the program %s", errorLog);
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        mPrograms[key] = program;
+        return program;
+    }
+
+    void GlProgramCache::drawQuad()
+    {
+        if (0 == mQuadBuffer)
+        {
+            glGenBuffers(1, &mQuadBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, mQuadBuffer);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(sQuadVertices), sQuadVertices, GL_STATIC_DRAW);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, mQuadBuffer);
+        }
+
+        glVertexAttribPointer(RDKSHELL_POSITION_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(sQuadVertices[0]), (const void*)0);
+        glVertexAttribPointer(RDKSHELL_UV_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(sQuadVertices[0]), (const void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(RDKSHELL_POSITION_ATTRIBUTE);
+        glEnableVertexAttribArray(RDKSHELL_UV_ATTRIBUTE);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glDisableVertexAttribArray(RDKSHELL_POSITION_ATTRIBUTE);
+        glDisableVertexAttribArray(RDKSHELL_UV_ATTRIBUTE);
+
+        // clients and the compositors draw from client side arrays
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
@@ -0,0 +1,55 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <map>
+#include <string>
+#include <utility>
+
+#define RDKSHELL_POSITION_ATTRIBUTE 0
+#define RDKSHELL_UV_ATTRIBUTE 1
+
+namespace RdkShell
+{
+    /*
+        GlProgramCache compiles and links each shader program once for the whole shell and owns the quad that
+        images and frame buffers are drawn with. render thread only.
+    */
+    class GlProgramCache
+    {
+    public:
+        static GlProgramCache *instance();
+
+        // a_position and a_uv are bound to RDKSHELL_POSITION_ATTRIBUTE and RDKSHELL_UV_ATTRIBUTE, 0 on error
+        GLuint program(const char* vertexShaderSource, const char* fragmentShaderSource);
+        // draws the unit quad, from (0, 0) to (1, 1), as a triangle strip with a_uv flipped vertically
+        void drawQuad();
+
+    private:
+        GlProgramCache();
+        ~GlProgramCache();
+
+        GLuint compileShader(GLenum type, const char* source);
+
+        std::map<std::pair<std::string, std::string>, GLuint> mPrograms;
+        GLuint mQuadBuffer;
+    };
+}
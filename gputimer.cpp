@@ -0,0 +1,122 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "gputimer.h"
+#include "logger.h"
+
+#include <string.h>
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+namespace RdkShell
+{
+    static bool sTimerQueryChecked = false;
+    static bool sTimerQuerySupported = false;
+    static PFNGLGENQUERIESEXTPROC sGenQueries = nullptr;
+    static PFNGLDELETEQUERIESEXTPROC sDeleteQueries = nullptr;
+    static PFNGLBEGINQUERYEXTPROC sBeginQuery = nullptr;
+    static PFNGLENDQUERYEXTPROC sEndQuery = nullptr;
+    static PFNGLGETQUERYOBJECTUIVEXTPROC sGetQueryObjectuiv = nullptr;
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC sGetQueryObjectui64v = nullptr;
+
+    GpuTimer::GpuTimer() : mQuery(0), mActive(false), mPending(false)
+    {
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        if (mQuery != 0)
+        {
+            sDeleteQueries(1, &mQuery);
+        }
+    }
+
+    bool GpuTimer::isSupported()
+    {
+        if (!sTimerQueryChecked)
+        {
+            sTimerQueryChecked = true;
+            const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+            if (extensions && strstr(extensions, "GL_EXT_disjoint_timer_query"))
+            {
+                sGenQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+                sDeleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+                sBeginQuery = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+                sEndQuery = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+                sGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+                sGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+                sTimerQuerySupported = sGenQueries && sDeleteQueries && sBeginQuery && sEndQuery &&
+                    sGetQueryObjectuiv && sGetQueryObjectui64v;
+            }
+            Logger::log(LogLevel::Information, "gpu timer queries supported: %d", sTimerQuerySupported);
+        }
+        return sTimerQuerySupported;
+    }
+
+    void GpuTimer::begin()
+    {
+        mActive = false;
+        if (mPending || !isSupported())
+        {
+            return;
+        }
+        if (mQuery == 0)
+        {
+            sGenQueries(1, &mQuery);
+        }
+        sBeginQuery(GL_TIME_ELAPSED_EXT, mQuery);
+        mActive = true;
+    }
+
+    void GpuTimer::end()
+    {
+        if (mActive)
+        {
+            sEndQuery(GL_TIME_ELAPSED_EXT);
+            mActive = false;
+            mPending = true;
+        }
+    }
+
+    bool GpuTimer::result(double& elapsedInMs)
+    {
+        if (!mPending)
+        {
+            return false;
+        }
+        GLuint available = 0;
+        sGetQueryObjectuiv(mQuery, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (!available)
+        {
+            return false;
+        }
+        mPending = false;
+
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint)
+        {
+            return false;
+        }
+        GLuint64 elapsed = 0;
+        sGetQueryObjectui64v(mQuery, GL_QUERY_RESULT_EXT, &elapsed);
+        elapsedInMs = (double)elapsed / 1000000.0;
+        return true;
+    }
+}
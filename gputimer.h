@@ -0,0 +1,45 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <GLES2/gl2.h>
+
+namespace RdkShell
+{
+    // measures gpu time with GL_EXT_disjoint_timer_query, results are read back without stalling
+    // on a later frame, so a measurement is skipped while the previous one is still in flight
+    class GpuTimer
+    {
+    public:
+        GpuTimer();
+        ~GpuTimer();
+
+        static bool isSupported();
+
+        void begin();
+        void end();
+        bool result(double& elapsedInMs);
+
+    private:
+        GLuint mQuery;
+        bool mActive;
+        bool mPending;
+    };
+}
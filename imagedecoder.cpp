@@ -0,0 +1,239 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "imagedecoder.h"
+#include "compressedtexture.h"
+#include "rdkshell.h"
+#include "tracerecorder.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace RdkShell
+{
+    ImageDecoder::ImageDecoder() : mWorkerCount(RDKSHELL_IMAGE_DECODE_THREADS), mNextRequestId(1),
+        mUploadBudgetInMs(RDKSHELL_IMAGE_UPLOAD_BUDGET_MS)
+    {
+        char const *threadCount = getenv("RDKSHELL_IMAGE_DECODE_THREADS");
+        if (threadCount && (atoi(threadCount) > 0))
+        {
+            mWorkerCount = atoi(threadCount);
+        }
+        char const *uploadBudget = getenv("RDKSHELL_IMAGE_UPLOAD_BUDGET_MS");
+        if (uploadBudget && (atof(uploadBudget) > 0))
+        {
+            mUploadBudgetInMs = atof(uploadBudget);
+        }
+    }
+
+    ImageDecoder::~ImageDecoder()
+    {
+    }
+
+    ImageDecoder* ImageDecoder::instance()
+    {
+        // never destroyed, images released while the process exits may still cancel their requests
+        static ImageDecoder* imageDecoder = new ImageDecoder();
+
+        return imageDecoder;
+    }
+
+    void ImageDecoder::startWorkers()
+    {
+        for (size_t i = 0; i < mWorkerCount; i++)
+        {
+            mWorkers.push_back(std::thread(&ImageDecoder::workerLoop, this));
+        }
+        Logger::log(LogLevel::Information, "started %zu image decode threads", mWorkerCount);
+    }
+
+    uint32_t ImageDecoder::decode(ImageDecodeFunction decodeFunction, ImageUploadCallback callback)
+    {
+        std::unique_ptr<Request> request(new Request());
+        request->decodeFunction = decodeFunction;
+        request->callback = callback;
+        uint32_t requestId = 0;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mWorkers.empty())
+            {
+                startWorkers();
+            }
+            requestId = mNextRequestId++;
+            if (0 == mNextRequestId)
+            {
+                mNextRequestId = 1;
+            }
+            request->id = requestId;
+            mDecodeQueue.push_back(std::move(request));
+        }
+        mCondition.notify_one();
+        return requestId;
+    }
+
+    void ImageDecoder::cancel(uint32_t requestId)
+    {
+        auto hasId = [requestId](const std::unique_ptr<Request>& request) { return request->id == requestId; };
+
+        auto uploadIterator = std::find_if(mUploadQueue.begin(), mUploadQueue.end(), hasId);
+        if (uploadIterator != mUploadQueue.end())
+        {
+            if ((*uploadIterator)->texture != 0)
+            {
+                glDeleteTextures(1, &(*uploadIterator)->texture);
+            }
+            mUploadQueue.erase(uploadIterator);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto decodeIterator = std::find_if(mDecodeQueue.begin(), mDecodeQueue.end(), hasId);
+        if (decodeIterator != mDecodeQueue.end())
+        {
+            mDecodeQueue.erase(decodeIterator);
+            return;
+        }
+        auto decodedIterator = std::find_if(mDecodedQueue.begin(), mDecodedQueue.end(), hasId);
+        if (decodedIterator != mDecodedQueue.end())
+        {
+            mDecodedQueue.erase(decodedIterator);
+            return;
+        }
+        mCancelledRequests.insert(requestId);
+    }
+
+    void ImageDecoder::workerLoop()
+    {
+        while (true)
+        {
+            std::unique_ptr<Request> request;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return !mDecodeQueue.empty(); });
+                request = std::move(mDecodeQueue.front());
+                mDecodeQueue.pop_front();
+            }
+
+            request->decoded = request->decodeFunction(request->image);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto cancelledIterator = mCancelledRequests.find(request->id);
+            if (cancelledIterator != mCancelledRequests.end())
+            {
+                mCancelledRequests.erase(cancelledIterator);
+                continue;
+            }
+            mDecodedQueue.push_back(std::move(request));
+        }
+    }
+
+    bool ImageDecoder::upload(Request& request)
+    {
+        DecodedImage& image = request.image;
+        if (image.compressedFormat != 0)
+        {
+            // compressed textures are a fraction of the size and go up in one piece
+            glGenTextures(1, &request.texture);
+            glBindTexture(GL_TEXTURE_2D, request.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            if (!CompressedTexture::upload(image))
+            {
+                // the callback gets no texture, so nothing is cached for the request
+                glDeleteTextures(1, &request.texture);
+                request.texture = 0;
+            }
+            return true;
+        }
+        int32_t bytesPerPixel = (image.format == GL_RGB) ? 3 : 4;
+        int32_t rowBytes = image.width * bytesPerPixel;
+        if (0 == request.texture)
+        {
+            glGenTextures(1, &request.texture);
+            glBindTexture(GL_TEXTURE_2D, request.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width, image.height, 0, image.format, GL_UNSIGNED_BYTE, NULL);
+        }
+        else
+        {
+            glBindTexture(GL_TEXTURE_2D, request.texture);
+        }
+
+        // decoded rows are tightly packed
+        int32_t rows = std::max<int32_t>(1, RDKSHELL_IMAGE_UPLOAD_CHUNK_BYTES / std::max<int32_t>(rowBytes, 1));
+        rows = std::min(rows, image.height - request.uploadedRows);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, request.uploadedRows, image.width, rows, image.format, GL_UNSIGNED_BYTE,
+            image.pixels + ((size_t)request.uploadedRows * rowBytes));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        request.uploadedRows += rows;
+        return request.uploadedRows >= image.height;
+    }
+
+    void ImageDecoder::process()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            while (!mDecodedQueue.empty())
+            {
+                mUploadQueue.push_back(std::move(mDecodedQueue.front()));
+                mDecodedQueue.pop_front();
+            }
+        }
+        if (mUploadQueue.empty())
+        {
+            return;
+        }
+
+        RDKSHELL_TRACE_SPAN("image", "upload");
+        double deadline = RdkShell::milliseconds() + mUploadBudgetInMs;
+        while (!mUploadQueue.empty())
+        {
+            Request& request = *mUploadQueue.front();
+            bool finished = true;
+            if (request.decoded && (request.image.width > 0) && (request.image.height > 0))
+            {
+                finished = upload(request);
+            }
+            if (finished)
+            {
+                // taken off the queue first, the callback may release images and cancel other requests
+                std::unique_ptr<Request> finishedRequest = std::move(mUploadQueue.front());
+                mUploadQueue.pop_front();
+                if (finishedRequest->callback)
+                {
+                    finishedRequest->callback(finishedRequest->texture, finishedRequest->image);
+                }
+                else if (finishedRequest->texture != 0)
+                {
+                    glDeleteTextures(1, &finishedRequest->texture);
+                }
+            }
+            if (RdkShell::milliseconds() >= deadline)
+            {
+                break;
+            }
+        }
+    }
+}
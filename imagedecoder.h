@@ -0,0 +1,114 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define RDKSHELL_IMAGE_DECODE_THREADS 2
+#define RDKSHELL_IMAGE_UPLOAD_BUDGET_MS 4.0
+#define RDKSHELL_IMAGE_UPLOAD_CHUNK_BYTES (256 * 1024)
+
+namespace RdkShell
+{
+    // pixels produced by a decoder, allocated with malloc
+    struct DecodedImage
+    {
+        DecodedImage() : pixels(nullptr), width(0), height(0), format(GL_RGBA), compressedFormat(0), compressedSize(0) {}
+        ~DecodedImage()
+        {
+            free(pixels);
+        }
+        // gpu memory used by the texture
+        uint64_t textureBytes() const
+        {
+            return (compressedFormat != 0) ? compressedSize : (uint64_t)width * height * ((format == GL_RGB) ? 3 : 4);
+        }
+        unsigned char* pixels;
+        int32_t width;
+        int32_t height;
+        GLenum format;
+        GLenum compressedFormat; // when set, pixels hold compressedSize bytes of compressed texture data
+        size_t compressedSize;
+    };
+
+    // runs on a worker thread
+    typedef std::function<bool(DecodedImage& image)> ImageDecodeFunction;
+    // runs on the render thread with the uploaded texture, or 0 when the image could not be decoded
+    typedef std::function<void(GLuint texture, const DecodedImage& image)> ImageUploadCallback;
+
+    /*
+        ImageDecoder decodes images on a small pool of worker threads. the render thread uploads the decoded
+        pixels from process, a band of rows at a time until the frame budget is spent, so a large image is
+        spread over several frames instead of stalling one.
+    */
+    class ImageDecoder
+    {
+    public:
+        static ImageDecoder* instance();
+
+        // returns the id to cancel the request with
+        uint32_t decode(ImageDecodeFunction decodeFunction, ImageUploadCallback callback);
+        // render thread only, the callback of a cancelled request never runs
+        void cancel(uint32_t requestId);
+        // render thread only, uploads decoded images and runs the callbacks of the finished ones
+        void process();
+
+    private:
+        ImageDecoder();
+        ~ImageDecoder();
+
+        struct Request
+        {
+            Request() : id(0), decodeFunction(), callback(), image(), decoded(false), texture(0), uploadedRows(0) {}
+            uint32_t id;
+            ImageDecodeFunction decodeFunction;
+            ImageUploadCallback callback;
+            DecodedImage image;
+            bool decoded;
+            GLuint texture;
+            int32_t uploadedRows;
+        };
+
+        void startWorkers();
+        void workerLoop();
+        bool upload(Request& request);
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::vector<std::thread> mWorkers;
+        size_t mWorkerCount;
+        uint32_t mNextRequestId;
+        std::deque<std::unique_ptr<Request>> mDecodeQueue;
+        std::deque<std::unique_ptr<Request>> mDecodedQueue;
+        std::set<uint32_t> mCancelledRequests; // requests cancelled while a worker was decoding them
+        std::deque<std::unique_ptr<Request>> mUploadQueue; // render thread only
+        double mUploadBudgetInMs;
+    };
+}
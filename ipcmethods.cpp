@@ -0,0 +1,1049 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ipcmethods.h"
+#include "compositorcontroller.h"
+#include "framestats.h"
+#include "texturecache.h"
+#include "binaryprotocol.h"
+#include "tracerecorder.h"
+#include "logger.h"
+
+#include <map>
+
+extern uint32_t getKeyFlag(std::string modifier);
+
+namespace RdkShell
+{
+    static const char* sPositionKeys[RDKSHELL_IPC_MAX_PARAMETERS] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+
+    IpcArguments::IpcArguments(const IpcMethodSchema& schema, const rapidjson::Value& params, bool named) :
+        mSchema(schema), mParams(params), mNamed(named)
+    {
+    }
+
+    static bool hasParameterType(char type, const rapidjson::Value& value)
+    {
+        switch (type)
+        {
+            case 'b':
+                return value.IsBool();
+            case 'i':
+                return value.IsInt();
+            case 'u':
+                return value.IsUint();
+            case 'f':
+                return value.IsNumber();
+            case 's':
+                return value.IsString();
+            case 'm':
+                return value.IsUint() || value.IsArray();
+            case 'a':
+                return value.IsArray();
+            case 'o':
+                return value.IsObject();
+            default:
+                return false;
+        }
+    }
+
+    bool IpcArguments::validate() const
+    {
+        if (!mParams.IsObject())
+        {
+            return false;
+        }
+        size_t parameterCount = ipcParameterCount(mSchema);
+        for (size_t i = 0; i < parameterCount; i++)
+        {
+            const IpcParameterSchema& parameter = mSchema.parameters[i];
+            const rapidjson::Value* parameterValue = value(i);
+            if (NULL == parameterValue)
+            {
+                if (parameter.mandatory)
+                {
+                    Logger::log(LogLevel::Warn, "%s is missing parameter %s", mSchema.name, parameter.name);
+                    return false;
+                }
+                continue;
+            }
+            if (!hasParameterType(parameter.type, *parameterValue))
+            {
+                Logger::log(LogLevel::Warn, "%s has an invalid %s parameter", mSchema.name, parameter.name);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IpcArguments::has(size_t index) const
+    {
+        return NULL != value(index);
+    }
+
+    const rapidjson::Value* IpcArguments::value(size_t index) const
+    {
+        if ((index >= RDKSHELL_IPC_MAX_PARAMETERS) || (NULL == mSchema.parameters[index].name) || !mParams.IsObject())
+        {
+            return NULL;
+        }
+        rapidjson::Value::ConstMemberIterator member = mParams.FindMember(mNamed ? mSchema.parameters[index].name : sPositionKeys[index]);
+        if (member == mParams.MemberEnd())
+        {
+            return NULL;
+        }
+        return &member->value;
+    }
+
+    std::string IpcArguments::getString(size_t index, const char* defaultValue) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        return ((NULL != parameterValue) && parameterValue->IsString()) ? std::string(parameterValue->GetString(), parameterValue->GetStringLength()) : std::string(defaultValue);
+    }
+
+    bool IpcArguments::getBool(size_t index, bool defaultValue) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        return ((NULL != parameterValue) && parameterValue->IsBool()) ? parameterValue->GetBool() : defaultValue;
+    }
+
+    int32_t IpcArguments::getInt(size_t index, int32_t defaultValue) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        return ((NULL != parameterValue) && parameterValue->IsInt()) ? parameterValue->GetInt() : defaultValue;
+    }
+
+    uint32_t IpcArguments::getUint(size_t index, uint32_t defaultValue) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        return ((NULL != parameterValue) && parameterValue->IsUint()) ? parameterValue->GetUint() : defaultValue;
+    }
+
+    double IpcArguments::getDouble(size_t index, double defaultValue) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        return ((NULL != parameterValue) && parameterValue->IsNumber()) ? parameterValue->GetDouble() : defaultValue;
+    }
+
+    uint32_t IpcArguments::getModifiers(size_t index) const
+    {
+        const rapidjson::Value* parameterValue = value(index);
+        if (NULL == parameterValue)
+        {
+            return 0;
+        }
+        if (parameterValue->IsUint())
+        {
+            return parameterValue->GetUint();
+        }
+        uint32_t flags = 0;
+        if (parameterValue->IsArray())
+        {
+            for (rapidjson::SizeType i = 0; i < parameterValue->Size(); i++)
+            {
+                if ((*parameterValue)[i].IsString())
+                {
+                    flags |= getKeyFlag((*parameterValue)[i].GetString());
+                }
+            }
+        }
+        return flags;
+    }
+
+    IpcResult::IpcResult(JsonWriter& writer, bool valueOnly) : mWriter(writer), mValueOnly(valueOnly), mEmpty(true)
+    {
+    }
+
+    JsonWriter& IpcResult::value(const char* name)
+    {
+        if (!mValueOnly)
+        {
+            mWriter.Key(name);
+        }
+        mEmpty = false;
+        return mWriter;
+    }
+
+    void IpcResult::add(const char* name, bool value)
+    {
+        this->value(name).Bool(value);
+    }
+
+    void IpcResult::add(const char* name, int32_t value)
+    {
+        this->value(name).Int(value);
+    }
+
+    void IpcResult::add(const char* name, uint32_t value)
+    {
+        this->value(name).Uint(value);
+    }
+
+    void IpcResult::add(const char* name, uint64_t value)
+    {
+        this->value(name).Uint64(value);
+    }
+
+    void IpcResult::add(const char* name, double value)
+    {
+        this->value(name).Double(value);
+    }
+
+    void IpcResult::add(const char* name, const char* value)
+    {
+        this->value(name).String(value);
+    }
+
+    void IpcResult::add(const char* name, const std::string& value)
+    {
+        this->value(name).String(value.c_str(), (rapidjson::SizeType)value.length());
+    }
+
+    void IpcResult::add(const char* name, const std::vector<std::string>& values)
+    {
+        JsonWriter& writer = this->value(name);
+        writer.StartArray();
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            writer.String(values[i].c_str(), (rapidjson::SizeType)values[i].length());
+        }
+        writer.EndArray();
+    }
+
+    bool IpcResult::empty() const
+    {
+        return mEmpty;
+    }
+
+    static bool negotiateProtocolMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        // binary frames are accepted from every connection, this only tells the client that the server understands them
+        std::string protocol = arguments.getString(0, "json");
+        if ((protocol != "binary") && (protocol != "json"))
+        {
+            return false;
+        }
+        result.add("protocol", protocol);
+        result.add("version", (uint32_t)RDKSHELL_BINARY_PROTOCOL_VERSION);
+        return true;
+    }
+
+    static bool createDisplayMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::createDisplay(arguments.getString(0), arguments.getString(1), arguments.getUint(2), arguments.getUint(3),
+            arguments.getBool(4), arguments.getUint(5), arguments.getUint(6), arguments.getBool(7), arguments.getBool(8), arguments.getBool(9, true));
+    }
+
+    static bool launchApplicationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::launchApplication(arguments.getString(0), arguments.getString(1), arguments.getString(2),
+            arguments.getBool(3), arguments.getBool(4));
+    }
+
+    static bool suspendApplicationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::suspendApplication(arguments.getString(0));
+    }
+
+    static bool resumeApplicationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::resumeApplication(arguments.getString(0));
+    }
+
+    static bool closeApplicationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::closeApplication(arguments.getString(0));
+    }
+
+    static bool killMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::kill(arguments.getString(0));
+    }
+
+    static bool getClientsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::vector<std::string> clients;
+        if (!CompositorController::getClients(clients))
+        {
+            return false;
+        }
+        result.add("clients", clients);
+        return true;
+    }
+
+    static bool getClientInfoMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        ClientInfo clientInfo;
+        if (!CompositorController::getClientInfo(arguments.getString(0), clientInfo))
+        {
+            return false;
+        }
+        result.add("x", clientInfo.x);
+        result.add("y", clientInfo.y);
+        result.add("width", clientInfo.width);
+        result.add("height", clientInfo.height);
+        result.add("sx", clientInfo.sx);
+        result.add("sy", clientInfo.sy);
+        result.add("opacity", clientInfo.opacity);
+        result.add("zorder", clientInfo.zorder);
+        result.add("visible", clientInfo.visible);
+        return true;
+    }
+
+    static bool getMimeTypeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string mimeType;
+        if (!CompositorController::getMimeType(arguments.getString(0), mimeType))
+        {
+            return false;
+        }
+        result.add("mimeType", mimeType);
+        return true;
+    }
+
+    static bool setMimeTypeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setMimeType(arguments.getString(0), arguments.getString(1));
+    }
+
+    static bool getZOrderMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::vector<std::string> clients;
+        if (!CompositorController::getZOrder(clients))
+        {
+            return false;
+        }
+        result.add("clients", clients);
+        return true;
+    }
+
+    static bool moveToFrontMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::moveToFront(arguments.getString(0));
+    }
+
+    static bool moveToBackMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::moveToBack(arguments.getString(0));
+    }
+
+    static bool moveBehindMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::moveBehind(arguments.getString(0), arguments.getString(1));
+    }
+
+    static bool setFocusMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setFocus(arguments.getString(0));
+    }
+
+    static bool getFocusedMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string client;
+        if (!CompositorController::getFocused(client))
+        {
+            return false;
+        }
+        result.add("client", client);
+        return true;
+    }
+
+    static bool setTopmostMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setTopmost(arguments.getString(0), arguments.getBool(1), arguments.getBool(2));
+    }
+
+    static bool getTopmostMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string client;
+        if (!CompositorController::getTopmost(client))
+        {
+            return false;
+        }
+        result.add("client", client);
+        return true;
+    }
+
+    static bool getBoundsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        uint32_t x = 0, y = 0, width = 0, height = 0;
+        if (!CompositorController::getBounds(arguments.getString(0), x, y, width, height))
+        {
+            return false;
+        }
+        result.add("x", x);
+        result.add("y", y);
+        result.add("w", width);
+        result.add("h", height);
+        return true;
+    }
+
+    static bool setBoundsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string client = arguments.getString(0);
+        uint32_t x = 0, y = 0, width = 0, height = 0;
+        if (!CompositorController::getBounds(client, x, y, width, height))
+        {
+            return false;
+        }
+        return CompositorController::setBounds(client, arguments.getUint(1, x), arguments.getUint(2, y), arguments.getUint(3, width), arguments.getUint(4, height));
+    }
+
+    static bool getScaleMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        double scaleX = 1.0, scaleY = 1.0;
+        if (!CompositorController::getScale(arguments.getString(0), scaleX, scaleY))
+        {
+            return false;
+        }
+        result.add("sx", scaleX);
+        result.add("sy", scaleY);
+        return true;
+    }
+
+    static bool setScaleMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string client = arguments.getString(0);
+        double scaleX = 1.0, scaleY = 1.0;
+        if (!CompositorController::getScale(client, scaleX, scaleY))
+        {
+            return false;
+        }
+        return CompositorController::setScale(client, arguments.getDouble(1, scaleX), arguments.getDouble(2, scaleY));
+    }
+
+    static bool scaleToFitMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::scaleToFit(arguments.getString(0), arguments.getInt(1), arguments.getInt(2), arguments.getUint(3), arguments.getUint(4));
+    }
+
+    static bool getVisibilityMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        bool visible = true;
+        if (!CompositorController::getVisibility(arguments.getString(0), visible))
+        {
+            return false;
+        }
+        result.add("visible", visible);
+        return true;
+    }
+
+    static bool setVisibilityMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setVisibility(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool getOpacityMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        unsigned int opacity = 0;
+        if (!CompositorController::getOpacity(arguments.getString(0), opacity))
+        {
+            return false;
+        }
+        result.add("opacity", (uint32_t)opacity);
+        return true;
+    }
+
+    static bool setOpacityMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setOpacity(arguments.getString(0), arguments.getUint(1));
+    }
+
+    static bool getHolePunchMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        bool holePunch = true;
+        if (!CompositorController::getHolePunch(arguments.getString(0), holePunch))
+        {
+            return false;
+        }
+        result.add("holePunch", holePunch);
+        return true;
+    }
+
+    static bool setHolePunchMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setHolePunch(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool getOpaqueMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        bool opaque = false;
+        if (!CompositorController::getOpaque(arguments.getString(0), opaque))
+        {
+            return false;
+        }
+        result.add("opaque", opaque);
+        return true;
+    }
+
+    static bool setOpaqueMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setOpaque(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool addAnimationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::map<std::string, RdkShellData> animationProperties;
+        if (arguments.has(2))
+        {
+            animationProperties["x"] = arguments.getInt(2);
+        }
+        if (arguments.has(3))
+        {
+            animationProperties["y"] = arguments.getInt(3);
+        }
+        if (arguments.has(4))
+        {
+            animationProperties["w"] = arguments.getUint(4);
+        }
+        if (arguments.has(5))
+        {
+            animationProperties["h"] = arguments.getUint(5);
+        }
+        if (arguments.has(6))
+        {
+            animationProperties["sx"] = arguments.getDouble(6);
+        }
+        if (arguments.has(7))
+        {
+            animationProperties["sy"] = arguments.getDouble(7);
+        }
+        return CompositorController::addAnimation(arguments.getString(0), arguments.getDouble(1), animationProperties);
+    }
+
+    static bool removeAnimationMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeAnimation(arguments.getString(0));
+    }
+
+    static bool applyBatchMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::vector<BatchOperation> operations;
+        if (!RdkShellJson::readBatchOperations(*arguments.value(0), operations))
+        {
+            return false;
+        }
+        return CompositorController::applyBatch(operations);
+    }
+
+    static bool getScreenResolutionMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        uint32_t width = 0, height = 0;
+        if (!CompositorController::getScreenResolution(width, height))
+        {
+            return false;
+        }
+        result.add("width", width);
+        result.add("height", height);
+        return true;
+    }
+
+    static bool setScreenResolutionMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setScreenResolution(arguments.getUint(0), arguments.getUint(1));
+    }
+
+    static bool getVirtualResolutionMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        uint32_t width = 0, height = 0;
+        if (!CompositorController::getVirtualResolution(arguments.getString(0), width, height))
+        {
+            return false;
+        }
+        result.add("width", width);
+        result.add("height", height);
+        return true;
+    }
+
+    static bool setVirtualResolutionMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setVirtualResolution(arguments.getString(0), arguments.getUint(1), arguments.getUint(2));
+    }
+
+    static bool enableVirtualDisplayMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::enableVirtualDisplay(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool getVirtualDisplayEnabledMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        bool enabled = false;
+        if (!CompositorController::getVirtualDisplayEnabled(arguments.getString(0), enabled))
+        {
+            return false;
+        }
+        result.add("enabled", enabled);
+        return true;
+    }
+
+    static bool addKeyInterceptMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::addKeyIntercept(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2));
+    }
+
+    static bool setKeyInterceptMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setKeyIntercept(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2), arguments.getBool(3));
+    }
+
+    static bool removeKeyInterceptMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeKeyIntercept(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2));
+    }
+
+    static bool removeAllKeyInterceptsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeAllKeyIntercepts();
+    }
+
+    static void readKeyListenerProperties(const IpcArguments& arguments, std::map<std::string, RdkShellData>& listenerProperties)
+    {
+        if (arguments.has(3))
+        {
+            listenerProperties["activate"] = arguments.getBool(3);
+        }
+        if (arguments.has(4))
+        {
+            listenerProperties["propagate"] = arguments.getBool(4);
+        }
+    }
+
+    static bool addKeyListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::map<std::string, RdkShellData> listenerProperties;
+        readKeyListenerProperties(arguments, listenerProperties);
+        return CompositorController::addKeyListener(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2), listenerProperties);
+    }
+
+    static bool removeKeyListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeKeyListener(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2));
+    }
+
+    static bool addNativeKeyListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::map<std::string, RdkShellData> listenerProperties;
+        readKeyListenerProperties(arguments, listenerProperties);
+        return CompositorController::addNativeKeyListener(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2), listenerProperties);
+    }
+
+    static bool removeNativeKeyListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeNativeKeyListener(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2));
+    }
+
+    static bool removeAllKeyListenersMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeAllKeyListeners();
+    }
+
+    static bool addKeyMetadataListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::addKeyMetadataListener(arguments.getString(0));
+    }
+
+    static bool removeKeyMetadataListenerMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::removeKeyMetadataListener(arguments.getString(0));
+    }
+
+    static bool injectKeyMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::injectKey(arguments.getUint(0), arguments.getModifiers(1));
+    }
+
+    static bool generateKeyMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        if (arguments.has(4))
+        {
+            return CompositorController::generateKey(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2), arguments.getString(3),
+                arguments.getDouble(4));
+        }
+        return CompositorController::generateKey(arguments.getString(0), arguments.getUint(1), arguments.getModifiers(2), arguments.getString(3));
+    }
+
+    static bool getLastKeyPressMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        uint32_t keyCode = 0, modifiers = 0;
+        uint64_t timestampInSeconds = 0;
+        if (!CompositorController::getLastKeyPress(keyCode, modifiers, timestampInSeconds))
+        {
+            return false;
+        }
+        result.add("keyCode", keyCode);
+        result.add("modifiers", modifiers);
+        result.add("timestampInSeconds", timestampInSeconds);
+        return true;
+    }
+
+    static bool ignoreKeyInputsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::ignoreKeyInputs(arguments.getBool(0));
+    }
+
+    static bool enableKeyRepeatsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::enableKeyRepeats(arguments.getBool(0));
+    }
+
+    static bool getKeyRepeatsEnabledMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        bool enabled = false;
+        if (!CompositorController::getKeyRepeatsEnabled(enabled))
+        {
+            return false;
+        }
+        result.add("enabled", enabled);
+        return true;
+    }
+
+    static bool setKeyRepeatConfigMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        CompositorController::setKeyRepeatConfig(arguments.getBool(0), arguments.getInt(1), arguments.getInt(2));
+        return true;
+    }
+
+    static bool enableInputEventsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::enableInputEvents(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool showCursorMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::showCursor();
+    }
+
+    static bool hideCursorMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::hideCursor();
+    }
+
+    static bool setCursorSizeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setCursorSize(arguments.getUint(0), arguments.getUint(1));
+    }
+
+    static bool getCursorSizeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        uint32_t width = 0, height = 0;
+        if (!CompositorController::getCursorSize(width, height))
+        {
+            return false;
+        }
+        result.add("width", width);
+        result.add("height", height);
+        return true;
+    }
+
+    static bool showSplashScreenMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::showSplashScreen(arguments.getUint(0));
+    }
+
+    static bool hideSplashScreenMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::hideSplashScreen();
+    }
+
+    static bool showWatermarkMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::showWatermark();
+    }
+
+    static bool hideWatermarkMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::hideWatermark();
+    }
+
+    static bool showFullScreenImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::showFullScreenImage(arguments.getString(0));
+    }
+
+    static bool hideFullScreenImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::hideFullScreenImage();
+    }
+
+    static bool createWatermarkImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::createWatermarkImage(arguments.getUint(0), arguments.getUint(1));
+    }
+
+    static bool updateWatermarkImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::updateWatermarkImage(arguments.getUint(0), arguments.getInt(1), arguments.getInt(2));
+    }
+
+    static bool adjustWatermarkImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::adjustWatermarkImage(arguments.getUint(0), arguments.getUint(1));
+    }
+
+    static bool deleteWatermarkImageMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::deleteWatermarkImage(arguments.getUint(0));
+    }
+
+    static bool alwaysShowWatermarkImageOnTopMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::alwaysShowWatermarkImageOnTop(arguments.getBool(0));
+    }
+
+    static bool enableInactivityReportingMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        CompositorController::enableInactivityReporting(arguments.getBool(0));
+        return true;
+    }
+
+    static bool setInactivityIntervalMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        CompositorController::setInactivityInterval(arguments.getDouble(0));
+        return true;
+    }
+
+    static bool resetInactivityTimeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        CompositorController::resetInactivityTime();
+        return true;
+    }
+
+    static bool getInactivityTimeMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        result.add("minutes", CompositorController::getInactivityTimeInMinutes());
+        return true;
+    }
+
+    static bool setAVBlockedMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setAVBlocked(arguments.getString(0), arguments.getBool(1));
+    }
+
+    static bool getBlockedAVApplicationsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::vector<std::string> applications;
+        if (!CompositorController::getBlockedAVApplications(applications))
+        {
+            return false;
+        }
+        result.add("applications", applications);
+        return true;
+    }
+
+    static bool setLogLevelMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        return CompositorController::setLogLevel(arguments.getString(0));
+    }
+
+    static bool getLogLevelMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::string level;
+        if (!CompositorController::getLogLevel(level))
+        {
+            return false;
+        }
+        result.add("level", level);
+        return true;
+    }
+
+    static bool getFrameStatsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        FrameStats::instance()->toJson(result.value("stats"));
+        return true;
+    }
+
+    static bool getClientStatsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        std::vector<ClientStats> stats;
+        if (!CompositorController::getClientStats(stats))
+        {
+            return false;
+        }
+        RdkShellJson::writeClientStats(result.value("clients"), stats);
+        return true;
+    }
+
+    static bool getTextureCacheStatsMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        TextureCache::instance()->toJson(result.value("stats"));
+        return true;
+    }
+
+    static bool startTraceMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        TraceRecorder::instance()->start(arguments.getDouble(0));
+        return true;
+    }
+
+    static bool stopTraceMethod(const IpcArguments& arguments, IpcResult& result)
+    {
+        if (!TraceRecorder::instance()->stop())
+        {
+            return false;
+        }
+        result.add("file", TraceRecorder::instance()->traceFile());
+        return true;
+    }
+
+    struct IpcMethodHandlerEntry
+    {
+        const char* name;
+        IpcMethodHandler handler;
+    };
+
+    static const IpcMethodHandlerEntry sIpcMethodHandlers[] =
+    {
+        { "negotiateProtocol", negotiateProtocolMethod },
+        { "createDisplay", createDisplayMethod },
+        { "launchApplication", launchApplicationMethod },
+        { "suspendApplication", suspendApplicationMethod },
+        { "resumeApplication", resumeApplicationMethod },
+        { "closeApplication", closeApplicationMethod },
+        { "kill", killMethod },
+        { "getClients", getClientsMethod },
+        { "getClientInfo", getClientInfoMethod },
+        { "getMimeType", getMimeTypeMethod },
+        { "setMimeType", setMimeTypeMethod },
+        { "getZOrder", getZOrderMethod },
+        { "moveToFront", moveToFrontMethod },
+        { "moveToBack", moveToBackMethod },
+        { "moveBehind", moveBehindMethod },
+        { "setFocus", setFocusMethod },
+        { "getFocused", getFocusedMethod },
+        { "setTopmost", setTopmostMethod },
+        { "getTopmost", getTopmostMethod },
+        { "getBounds", getBoundsMethod },
+        { "setBounds", setBoundsMethod },
+        { "getScale", getScaleMethod },
+        { "setScale", setScaleMethod },
+        { "scaleToFit", scaleToFitMethod },
+        { "getVisibility", getVisibilityMethod },
+        { "setVisibility", setVisibilityMethod },
+        { "getOpacity", getOpacityMethod },
+        { "setOpacity", setOpacityMethod },
+        { "getHolePunch", getHolePunchMethod },
+        { "setHolePunch", setHolePunchMethod },
+        { "getOpaque", getOpaqueMethod },
+        { "setOpaque", setOpaqueMethod },
+        { "addAnimation", addAnimationMethod },
+        { "removeAnimation", removeAnimationMethod },
+        { "applyBatch", applyBatchMethod },
+        { "getScreenResolution", getScreenResolutionMethod },
+        { "setScreenResolution", setScreenResolutionMethod },
+        { "getVirtualResolution", getVirtualResolutionMethod },
+        { "setVirtualResolution", setVirtualResolutionMethod },
+        { "enableVirtualDisplay", enableVirtualDisplayMethod },
+        { "getVirtualDisplayEnabled", getVirtualDisplayEnabledMethod },
+        { "addKeyIntercept", addKeyInterceptMethod },
+        { "setKeyIntercept", setKeyInterceptMethod },
+        { "removeKeyIntercept", removeKeyInterceptMethod },
+        { "removeAllKeyIntercepts", removeAllKeyInterceptsMethod },
+        { "addKeyListener", addKeyListenerMethod },
+        { "removeKeyListener", removeKeyListenerMethod },
+        { "addNativeKeyListener", addNativeKeyListenerMethod },
+        { "removeNativeKeyListener", removeNativeKeyListenerMethod },
+        { "removeAllKeyListeners", removeAllKeyListenersMethod },
+        { "addKeyMetadataListener", addKeyMetadataListenerMethod },
+        { "removeKeyMetadataListener", removeKeyMetadataListenerMethod },
+        { "injectKey", injectKeyMethod },
+        { "generateKey", generateKeyMethod },
+        { "getLastKeyPress", getLastKeyPressMethod },
+        { "ignoreKeyInputs", ignoreKeyInputsMethod },
+        { "enableKeyRepeats", enableKeyRepeatsMethod },
+        { "getKeyRepeatsEnabled", getKeyRepeatsEnabledMethod },
+        { "setKeyRepeatConfig", setKeyRepeatConfigMethod },
+        { "enableInputEvents", enableInputEventsMethod },
+        { "showCursor", showCursorMethod },
+        { "hideCursor", hideCursorMethod },
+        { "setCursorSize", setCursorSizeMethod },
+        { "getCursorSize", getCursorSizeMethod },
+        { "showSplashScreen", showSplashScreenMethod },
+        { "hideSplashScreen", hideSplashScreenMethod },
+        { "showWatermark", showWatermarkMethod },
+        { "hideWatermark", hideWatermarkMethod },
+        { "showFullScreenImage", showFullScreenImageMethod },
+        { "hideFullScreenImage", hideFullScreenImageMethod },
+        { "createWatermarkImage", createWatermarkImageMethod },
+        { "updateWatermarkImage", updateWatermarkImageMethod },
+        { "adjustWatermarkImage", adjustWatermarkImageMethod },
+        { "deleteWatermarkImage", deleteWatermarkImageMethod },
+        { "alwaysShowWatermarkImageOnTop", alwaysShowWatermarkImageOnTopMethod },
+        { "enableInactivityReporting", enableInactivityReportingMethod },
+        { "setInactivityInterval", setInactivityIntervalMethod },
+        { "resetInactivityTime", resetInactivityTimeMethod },
+        { "getInactivityTime", getInactivityTimeMethod },
+        { "setAVBlocked", setAVBlockedMethod },
+        { "getBlockedAVApplications", getBlockedAVApplicationsMethod },
+        { "setLogLevel", setLogLevelMethod },
+        { "getLogLevel", getLogLevelMethod },
+        { "getFrameStats", getFrameStatsMethod },
+        { "getClientStats", getClientStatsMethod },
+        { "getTextureCacheStats", getTextureCacheStatsMethod },
+        { "startTrace", startTraceMethod },
+        { "stopTrace", stopTraceMethod }
+    };
+
+    static std::vector<IpcMethod>& ipcMethods()
+    {
+        static std::vector<IpcMethod> methods;
+        if (methods.empty())
+        {
+            for (size_t i = 0; i < sizeof(sIpcMethodHandlers)/sizeof(sIpcMethodHandlers[0]); i++)
+            {
+                const IpcMethodSchema* schema = findIpcMethodSchema(sIpcMethodHandlers[i].name);
+                if (NULL == schema)
+                {
+                    Logger::log(LogLevel::Error, "ipc method %s has no schema", sIpcMethodHandlers[i].name);
+                    continue;
+                }
+                IpcMethod method;
+                method.schema = schema;
+                method.handler = sIpcMethodHandlers[i].handler;
+                methods.push_back(method);
+            }
+        }
+        return methods;
+    }
+
+    bool IpcMethods::registerMethods(IpcMethodTable& table)
+    {
+        std::vector<IpcMethod>& methods = ipcMethods();
+        for (size_t i = 0; i < methods.size(); i++)
+        {
+            table.add(methods[i].schema->name, &methods[i]);
+        }
+        return table.build();
+    }
+
+    bool IpcMethods::invoke(const IpcMethod& method, const rapidjson::Value& params, bool named, IpcResult& result)
+    {
+        RDKSHELL_TRACE_SPAN("ipc", method.schema->name);
+        IpcArguments arguments(*method.schema, params, named);
+        if (!arguments.validate())
+        {
+            return false;
+        }
+        return method.handler(arguments, result);
+    }
+
+    bool IpcMethods::hasResults(const IpcMethod& method)
+    {
+        return NULL != method.schema->results[0].name;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "ipcschema.h"
+#include "rdkshelljson.h"
+#include "methodtable.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace RdkShell
+{
+    /*
+        IpcArguments gives a method handler typed access to the request parameters by their schema position,
+        whether the transport passed them by position or by name.
+    */
+    class IpcArguments
+    {
+      public:
+        IpcArguments(const IpcMethodSchema& schema, const rapidjson::Value& params, bool named);
+        // checks that the mandatory parameters are present and that every parameter has the schema type
+        bool validate() const;
+        bool has(size_t index) const;
+        const rapidjson::Value* value(size_t index) const;
+        std::string getString(size_t index, const char* defaultValue = "") const;
+        bool getBool(size_t index, bool defaultValue = false) const;
+        int32_t getInt(size_t index, int32_t defaultValue = 0) const;
+        uint32_t getUint(size_t index, uint32_t defaultValue = 0) const;
+        double getDouble(size_t index, double defaultValue = 0.0) const;
+        uint32_t getModifiers(size_t index) const;
+
+      private:
+        const IpcMethodSchema& mSchema;
+        const rapidjson::Value& mParams;
+        bool mNamed;
+    };
+
+    /*
+        IpcResult writes the results of a method into the response. when the transport expects the single result
+        as the params value, the result names are left out.
+    */
+    class IpcResult
+    {
+      public:
+        IpcResult(JsonWriter& writer, bool valueOnly);
+        void add(const char* name, bool value);
+        void add(const char* name, int32_t value);
+        void add(const char* name, uint32_t value);
+        void add(const char* name, uint64_t value);
+        void add(const char* name, double value);
+        void add(const char* name, const char* value);
+        void add(const char* name, const std::string& value);
+        void add(const char* name, const std::vector<std::string>& values);
+        // writes the name and returns the writer for a value the caller serializes itself
+        JsonWriter& value(const char* name);
+        bool empty() const;
+
+      private:
+        JsonWriter& mWriter;
+        bool mValueOnly;
+        bool mEmpty;
+    };
+
+    typedef bool (*IpcMethodHandler)(const IpcArguments& arguments, IpcResult& result);
+
+    struct IpcMethod
+    {
+        const IpcMethodSchema* schema;
+        IpcMethodHandler handler;
+    };
+
+    typedef MethodTable<const IpcMethod*> IpcMethodTable;
+
+    class IpcMethods
+    {
+      public:
+        // adds every method of the schema that has a server handler and builds the table
+        static bool registerMethods(IpcMethodTable& table);
+        // validates the parameters and runs the handler on the render thread
+        static bool invoke(const IpcMethod& method, const rapidjson::Value& params, bool named, IpcResult& result);
+        static bool hasResults(const IpcMethod& method);
+    };
+}
@@ -234,13 +234,13 @@ void mapVirtualKeyCodes()
 
 bool keyCodeFromWayland(uint32_t waylandKeyCode, uint32_t waylandFlags, uint32_t &mappedKeyCode, uint32_t &mappedFlags)
 {
-    RdkShell::Logger::log(RdkShell::LogLevel::Debug, "key event - keyCode: %u flags: %u", waylandKeyCode, waylandFlags);
+    RDKSHELL_LOG_DEBUG("key event - keyCode: %u flags: %u", waylandKeyCode, waylandFlags);
     std::map<uint32_t, struct RdkShellKeyMap>::iterator it  = sRdkShellKeyMap.find(waylandKeyCode);
     if (it != sRdkShellKeyMap.end())
     {
       mappedKeyCode = it->second.code;
       mappedFlags = it->second.flags;
-      RdkShell::Logger::log(RdkShell::LogLevel::Debug, "key mapped from config - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
+      RDKSHELL_LOG_DEBUG("key mapped from config - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
       return true;
     }
     int standardKeyCode = 0;
@@ -636,19 +636,19 @@ bool keyCodeFromWayland(uint32_t waylandKeyCode, uint32_t waylandFlags, uint32_t
     }
     mappedKeyCode = standardKeyCode;
     mappedFlags = waylandFlags;
-    RdkShell::Logger::log(RdkShell::LogLevel::Debug, "key mapped - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
+    RDKSHELL_LOG_DEBUG("key mapped - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
     return true;
 }
 
 bool keyCodeFromVirtual(std::string& virtualKey, uint32_t &mappedKeyCode, uint32_t &mappedFlags)
 {
-    RdkShell::Logger::log(RdkShell::LogLevel::Debug, "virtual key event - key: %s", virtualKey);
+    RDKSHELL_LOG_DEBUG("virtual key event - key: %s", virtualKey.c_str());
     std::map<std::string, struct RdkShellKeyMap>::iterator it  = sRdkShellVirtualKeyMap.find(virtualKey);
     if (it != sRdkShellVirtualKeyMap.end())
     {
       mappedKeyCode = it->second.code;
       mappedFlags = it->second.flags;
-      RdkShell::Logger::log(RdkShell::LogLevel::Debug, "virtaul key mapped from config - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
+      RDKSHELL_LOG_DEBUG("virtaul key mapped from config - mappedKeyCode: %u mappedFlags: %u", mappedKeyCode, mappedFlags);
       return true;
     }
     return false;
@@ -19,11 +19,23 @@
 
 #include "logger.h"
 #include "rdkshell.h"
+#include "spscqueue.h"
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h> 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define RDKSHELL_LOG_MESSAGE_SIZE 512
+#define RDKSHELL_LOG_QUEUE_SIZE 256
+#define RDKSHELL_LOG_WRITER_INTERVAL_MS 10
 
 namespace RdkShell
 {
@@ -50,6 +62,206 @@ namespace RdkShell
     LogLevel Logger::sLogLevel = Information;
     bool Logger::sFlushingEnabled = false;
 
+    struct LogEntry
+    {
+      LogLevel level;
+      int threadId;
+      double timestamp;
+      char message[RDKSHELL_LOG_MESSAGE_SIZE];
+    };
+
+    // the messages of one thread, written by that thread and taken out by the background writer
+    struct LogQueue
+    {
+      LogQueue(int id) : threadId(id), entries(RDKSHELL_LOG_QUEUE_SIZE), dropped(0), orphaned(false) {}
+      int threadId;
+      SpscQueue<LogEntry> entries;
+      std::atomic<uint64_t> dropped;
+      std::atomic<bool> orphaned; // the thread exited, the queue is freed once it is drained
+    };
+
+    static std::atomic<uint64_t> sDroppedMessages(0);
+    // set when the writer is destroyed at exit, later messages are written directly
+    static std::atomic<bool> sWriterStopped(false);
+
+    static void writeEntry(const LogEntry& entry)
+    {
+      #ifdef RDKSHELL_LOGGER_DISABLE_TIMESTAMP
+      printf("[%s] RDKShell Thread-%d : %s\n", logLevelToString(entry.level), entry.threadId, entry.message);
+      #else
+      printf("[%s] RDKShell Thread-%d Time-%lf: %s\n", logLevelToString(entry.level), entry.threadId, entry.timestamp, entry.message);
+      #endif
+    }
+
+    /*
+        LogWriter prints the messages of all threads from a background thread, so logging only costs the caller
+        the formatting and a copy into its own queue. a full queue drops the message and counts it.
+    */
+    class LogWriter
+    {
+      public:
+        static LogWriter& instance()
+        {
+          static LogWriter writer;
+          return writer;
+        }
+
+        void push(LogEntry& entry);
+        void drain();
+
+      private:
+        LogWriter();
+        ~LogWriter();
+        LogQueue* queueForThread(int threadId);
+        void run();
+
+        std::mutex mQueuesMutex;
+        std::vector<LogQueue*> mQueues;
+        std::mutex mDrainMutex;
+        std::vector<LogEntry> mBatch;
+        std::mutex mWakeMutex;
+        std::condition_variable mWakeCondition;
+        bool mRunning;
+        std::thread mThread;
+    };
+
+    struct ThreadLogState
+    {
+      ThreadLogState() : threadId(0), queue(NULL) {}
+      ~ThreadLogState()
+      {
+        if (NULL != queue)
+        {
+          queue->orphaned.store(true, std::memory_order_release);
+        }
+      }
+      int threadId;
+      LogQueue* queue;
+    };
+
+    static thread_local ThreadLogState sThreadLogState;
+
+    static int currentThreadId()
+    {
+      if (sThreadLogState.threadId == 0)
+      {
+        sThreadLogState.threadId = syscall(__NR_gettid);
+      }
+      return sThreadLogState.threadId;
+    }
+
+    LogWriter::LogWriter() : mRunning(true)
+    {
+      mThread = std::thread(&LogWriter::run, this);
+    }
+
+    LogWriter::~LogWriter()
+    {
+      sWriterStopped = true;
+      {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mRunning = false;
+      }
+      mWakeCondition.notify_one();
+      if (mThread.joinable())
+      {
+        mThread.join();
+      }
+      drain();
+    }
+
+    LogQueue* LogWriter::queueForThread(int threadId)
+    {
+      if (NULL == sThreadLogState.queue)
+      {
+        sThreadLogState.queue = new LogQueue(threadId);
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        mQueues.push_back(sThreadLogState.queue);
+      }
+      return sThreadLogState.queue;
+    }
+
+    void LogWriter::push(LogEntry& entry)
+    {
+      LogQueue* queue = queueForThread(entry.threadId);
+      bool urgent = (entry.level >= Error);
+      if (!queue->entries.push(std::move(entry)))
+      {
+        queue->dropped.fetch_add(1, std::memory_order_relaxed);
+        sDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+        urgent = true;
+      }
+      // the writer wakes up on its own shortly, it is only woken early when the message should not wait
+      if (urgent)
+      {
+        mWakeCondition.notify_one();
+      }
+    }
+
+    // messages of different threads are written in the order they were logged
+    void LogWriter::drain()
+    {
+      std::lock_guard<std::mutex> drainLock(mDrainMutex);
+      {
+        std::lock_guard<std::mutex> lock(mQueuesMutex);
+        std::vector<LogQueue*>::iterator iter = mQueues.begin();
+        while (iter != mQueues.end())
+        {
+          LogQueue* queue = *iter;
+          bool orphaned = queue->orphaned.load(std::memory_order_acquire);
+          LogEntry entry;
+          while (queue->entries.pop(entry))
+          {
+            mBatch.push_back(entry);
+          }
+          uint64_t dropped = queue->dropped.exchange(0, std::memory_order_relaxed);
+          if (dropped > 0)
+          {
+            entry.level = Warn;
+            entry.threadId = queue->threadId;
+            entry.timestamp = mBatch.empty() ? 0.0 : mBatch.back().timestamp;
+            snprintf(entry.message, sizeof(entry.message), "%llu log messages were dropped", (unsigned long long)dropped);
+            mBatch.push_back(entry);
+          }
+          if (orphaned)
+          {
+            delete queue;
+            iter = mQueues.erase(iter);
+          }
+          else
+          {
+            iter++;
+          }
+        }
+      }
+      if (mBatch.empty())
+      {
+        return;
+      }
+      std::stable_sort(mBatch.begin(), mBatch.end(), [](const LogEntry& left, const LogEntry& right)
+        {
+          return left.timestamp < right.timestamp;
+        });
+      for (size_t i = 0; i < mBatch.size(); i++)
+      {
+        writeEntry(mBatch[i]);
+      }
+      mBatch.clear();
+      fflush(stdout);
+    }
+
+    void LogWriter::run()
+    {
+      std::unique_lock<std::mutex> lock(mWakeMutex);
+      while (mRunning)
+      {
+        mWakeCondition.wait_for(lock, std::chrono::milliseconds(RDKSHELL_LOG_WRITER_INTERVAL_MS));
+        lock.unlock();
+        drain();
+        lock.lock();
+      }
+    }
+
     void Logger::setLogLevel(const char* loglevel)
     {
       LogLevel level = Information;
@@ -84,31 +296,48 @@ namespace RdkShell
       return sFlushingEnabled;
     }
 
+    void Logger::flush()
+    {
+      if (!sWriterStopped)
+      {
+        LogWriter::instance().drain();
+      }
+    }
+
+    uint64_t Logger::droppedMessages()
+    {
+      return sDroppedMessages.load(std::memory_order_relaxed);
+    }
+
     void Logger::log(LogLevel level, const char* format, ...)
     {
-      if (level < sLogLevel)
+      if (!isEnabled(level))
       {
         return;
       }
 
-      int threadId = syscall(__NR_gettid);
-      const char* logLevel = logLevelToString(level);
-      char buffer[256];
+      LogEntry entry;
+      entry.level = level;
+      entry.threadId = currentThreadId();
+      #ifdef RDKSHELL_LOGGER_DISABLE_TIMESTAMP
+      entry.timestamp = 0.0;
+      #else
+      entry.timestamp = seconds();
+      #endif
       va_list ptr;
 
       va_start(ptr, format);
-      vsprintf(buffer, format, ptr);
+      vsnprintf(entry.message, sizeof(entry.message), format, ptr);
       va_end(ptr);
 
-      #ifdef RDKSHELL_LOGGER_DISABLE_TIMESTAMP
-      printf("[%s] RDKShell Thread-%d : %s\n", logLevel, threadId, buffer);
-      #else
-      printf("[%s] RDKShell Thread-%d Time-%lf: %s\n", logLevel, threadId, seconds(), buffer);
-      #endif
-
-      if (sFlushingEnabled)
+      // fatal messages usually come right before the process goes away, they are not left in the queue
+      if (sFlushingEnabled || (level == Fatal) || sWriterStopped)
       {
+        Logger::flush();
+        writeEntry(entry);
         fflush(stdout);
+        return;
       }
+      LogWriter::instance().push(entry);
     }
 }
@@ -20,6 +20,12 @@
 #ifndef RDKSHELL_LOGGER_H
 #define RDKSHELL_LOGGER_H
 #include <string>
+#include <stdint.h>
+
+// messages below this level are compiled out of the RDKSHELL_LOG macros, 0 keeps debug messages
+#ifndef RDKSHELL_LOG_MINIMUM_LEVEL
+#define RDKSHELL_LOG_MINIMUM_LEVEL 0
+#endif
 
 namespace RdkShell
 {
@@ -37,8 +43,17 @@ namespace RdkShell
             static void log(LogLevel level, const char* format, ...);
             static void setLogLevel(const char* loglevel);
             static void logLevel(std::string& level);
+            // with flushing enabled messages are written right away instead of by the background writer
             static void enableFlushing(bool enable);
             static bool isFlushingEnabled();
+            // writes everything logged so far, returns once it is written
+            static void flush();
+            // messages lost because the log buffer of their thread was full
+            static uint64_t droppedMessages();
+            static bool isEnabled(LogLevel level)
+            {
+                return (level >= RDKSHELL_LOG_MINIMUM_LEVEL) && (level >= sLogLevel);
+            }
 
         private:
             static LogLevel sLogLevel;
@@ -46,4 +61,22 @@ namespace RdkShell
     };
 }
 
+/*
+    the RDKSHELL_LOG macros check the level before the call, so the arguments of a filtered message are not
+    evaluated and levels below RDKSHELL_LOG_MINIMUM_LEVEL cost nothing at all. use them on frequently run paths.
+*/
+#define RDKSHELL_LOG(level, ...) \
+    do \
+    { \
+        if (RdkShell::Logger::isEnabled(level)) \
+        { \
+            RdkShell::Logger::log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define RDKSHELL_LOG_DEBUG(...) RDKSHELL_LOG(RdkShell::Debug, __VA_ARGS__)
+#define RDKSHELL_LOG_INFO(...) RDKSHELL_LOG(RdkShell::Information, __VA_ARGS__)
+#define RDKSHELL_LOG_WARN(...) RDKSHELL_LOG(RdkShell::Warn, __VA_ARGS__)
+#define RDKSHELL_LOG_ERROR(...) RDKSHELL_LOG(RdkShell::Error, __VA_ARGS__)
+
 #endif //RDKSHELL_LOGGER_H
@@ -0,0 +1,139 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+namespace RdkShell
+{
+    /*
+        MethodTable maps ipc method names to handlers with a perfect hash. after all methods are added, build()
+        searches for a hash seed that puts every name in its own bucket, so a lookup hashes the name once and
+        does a single compare, straight from the bytes of the request without creating a std::string.
+    */
+    template <typename Handler>
+    class MethodTable
+    {
+    public:
+        struct Entry
+        {
+            std::string name;
+            Handler handler;
+        };
+
+        MethodTable() : mEntries(), mBuckets(), mMask(0), mSeed(0)
+        {
+        }
+
+        // only valid before build()
+        void add(const char* name, Handler handler)
+        {
+            Entry entry;
+            entry.name = name;
+            entry.handler = handler;
+            mEntries.push_back(entry);
+        }
+
+        bool build()
+        {
+            size_t bucketCount = 1;
+            while (bucketCount < (mEntries.size() * 2))
+            {
+                bucketCount <<= 1;
+            }
+            // the table only grows when no seed gives a collision free layout at the current size
+            for (; bucketCount <= (mEntries.size() * 64) + 1; bucketCount <<= 1)
+            {
+                for (uint32_t seed = 0; seed < 1024; seed++)
+                {
+                    if (tryBuild(bucketCount, seed))
+                    {
+                        return true;
+                    }
+                }
+            }
+            mBuckets.clear();
+            return false;
+        }
+
+        const Entry* find(const char* name, size_t length) const
+        {
+            if (mBuckets.empty())
+            {
+                return NULL;
+            }
+            int index = mBuckets[hash(name, length, mSeed) & mMask];
+            if (index < 0)
+            {
+                return NULL;
+            }
+            const Entry& entry = mEntries[index];
+            if ((entry.name.length() != length) || (memcmp(entry.name.data(), name, length) != 0))
+            {
+                return NULL;
+            }
+            return &entry;
+        }
+
+        const Entry* find(const std::string& name) const
+        {
+            return find(name.data(), name.length());
+        }
+
+    private:
+        static uint32_t hash(const char* name, size_t length, uint32_t seed)
+        {
+            // fnv-1a
+            uint32_t value = 2166136261u ^ seed;
+            for (size_t i = 0; i < length; i++)
+            {
+                value ^= (uint8_t)name[i];
+                value *= 16777619u;
+            }
+            return value;
+        }
+
+        bool tryBuild(size_t bucketCount, uint32_t seed)
+        {
+            mBuckets.assign(bucketCount, -1);
+            mMask = bucketCount - 1;
+            mSeed = seed;
+            for (size_t i = 0; i < mEntries.size(); i++)
+            {
+                int& bucket = mBuckets[hash(mEntries[i].name.data(), mEntries[i].name.length(), seed) & mMask];
+                if (bucket >= 0)
+                {
+                    return false;
+                }
+                bucket = (int)i;
+            }
+            return true;
+        }
+
+        std::vector<Entry> mEntries;
+        std::vector<int> mBuckets;
+        size_t mMask;
+        uint32_t mSeed;
+    };
+}
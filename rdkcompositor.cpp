@@ -24,12 +24,15 @@
 #include <string.h>
 #include <signal.h>
 #include <unistd.h>
+#include <cmath>
 #include "linuxkeys.h"
 #include "rdkshell.h"
 #include "permissions.h"
 #include "framebuffer.h"
 #include "framebufferrenderer.h"
 #include "logger.h"
+#include "framestats.h"
+#include "tracerecorder.h"
 
 extern bool gForce720;
 
@@ -53,7 +56,8 @@ namespace RdkShell
         mApplicationName(), mApplicationThread(), mApplicationState(RdkShell::ApplicationState::Unknown),
         mApplicationPid(-1), mApplicationThreadStarted(false), mApplicationClosedByCompositor(false), mApplicationMutex(), mReceivedKeyPress(false),
         mVirtualDisplayEnabled(false), mVirtualWidth(0), mVirtualHeight(0), mSizeChangeRequestPresent(false), mSurfaceCount(0),
-        mInputEventsEnabled(true), mSuspendedBeforeStart(false), mFocused(false)
+        mInputEventsEnabled(true), mSuspendedBeforeStart(false), mFocused(false), mDirty(true), mDrawnRect(),
+        mOpaque(false), mOccluded(false)
     {
         if (gForce720)
         {
@@ -120,7 +124,12 @@ namespace RdkShell
 
     void RdkCompositor::onInvalidate()
     {
-        //todo
+        // called from the westeros compositor thread when a client commits new content.
+        // new content of a client hidden behind an opaque one does not change the screen
+        if (!mOccluded)
+        {
+            mDirty = true;
+        }
     }
 
     void RdkCompositor::onClientStatus(int status, int pid, int detail)
@@ -250,7 +259,7 @@ namespace RdkShell
         rect.y = y;
         rect.width = w;
         rect.height = h;
-        RdkShell::Logger::log(LogLevel::Debug,  "hole punch rectangle: x %d y %d w %d h %d", x, y, w, h);
+        RDKSHELL_LOG_DEBUG("hole punch rectangle: x %d y %d w %d h %d", x, y, w, h);
     }
 
     void RdkCompositor::draw(bool &needsHolePunch, RdkShellRect& rect)
@@ -258,10 +267,19 @@ namespace RdkShell
         #ifndef RDKSHELL_ENABLE_HIDDEN_SUPPORT
         if (!mVisible)
         {
+            mDrawnRect = RdkShellRect();
             return;
         }
         #endif //!RDKSHELL_ENABLE_HIDDEN_SUPPORT
 
+        if (mOccluded)
+        {
+            mDrawnRect = RdkShellRect();
+            return;
+        }
+
+        FramePhaseTimer clientComposeTimer(FramePhase::ClientCompose);
+
         if (mVirtualDisplayEnabled)
         {
             drawFbo(needsHolePunch, rect);
@@ -270,10 +288,17 @@ namespace RdkShell
         {
             drawDirect(needsHolePunch, rect);
         }
+
+        screenBounds(mDrawnRect);
+        if (needsHolePunch)
+        {
+            mDrawnRect.unite(rect);
+        }
     }
 
     void RdkCompositor::drawFbo(bool &needsHolePunch, RdkShellRect& rect)
     {
+        RDKSHELL_TRACE_SPAN("render", "drawFbo");
         // create the FBO if it's not created yet or its size was changed
         if (!mFbo ||
             mFbo->width() != mVirtualWidth ||
@@ -290,6 +315,10 @@ namespace RdkShell
             WstCompositorSetOutputSize(mWstContext, mVirtualWidth, mVirtualHeight);
         }
 
+        // the scissor is set up in screen coordinates for partial updates and must not clip the fbo
+        GLboolean scissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+        glDisable(GL_SCISSOR_TEST);
+
         mFbo->bind();
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -318,6 +347,10 @@ namespace RdkShell
 
         glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
         mFbo->unbind();
+        if (scissorEnabled)
+        {
+            glEnable(GL_SCISSOR_TEST);
+        }
 
         uint32_t screenWidth, screenHeight;
         CompositorController::getScreenResolution(screenWidth, screenHeight);
@@ -328,6 +361,7 @@ namespace RdkShell
 
     void RdkCompositor::drawDirect(bool &needsHolePunch, RdkShellRect& rect)
     {
+        RDKSHELL_TRACE_SPAN("render", "drawDirect");
         int hints = WstHints_none;
         hints |= WstHints_applyTransform;
         if (mHolePunch)
@@ -434,6 +468,10 @@ namespace RdkShell
 
     void RdkCompositor::setPosition(int32_t x, int32_t y)
     {
+        if ((mPositionX != x) || (mPositionY != y))
+        {
+            mDirty = true;
+        }
         mPositionX = x;
         mPositionY = y;
         mMatrix[12] = x;
@@ -448,6 +486,10 @@ namespace RdkShell
 
     void RdkCompositor::setOpacity(double opacity)
     {
+        if (mOpacity != opacity)
+        {
+            mDirty = true;
+        }
         mOpacity = opacity;
     }
 
@@ -468,6 +510,10 @@ namespace RdkShell
             mScaleY = scaleY;
         }
 
+        if ((mMatrix[0] != (float)mScaleX) || (mMatrix[5] != (float)mScaleY))
+        {
+            mDirty = true;
+        }
         mMatrix[0] = 1 * mScaleX;
         mMatrix[5] = 1 * mScaleY;
     }
@@ -484,6 +530,10 @@ namespace RdkShell
             mSizeChangeRequestPresent = true;
             WstCompositorSetOutputSize(mWstContext, width, height);
         }
+        if ((mWidth != width) || (mHeight != height))
+        {
+            mDirty = true;
+        }
         mWidth = width;
         mHeight = height;
     }
@@ -507,6 +557,10 @@ namespace RdkShell
             return;
         }
 
+        if (mVisible != visible)
+        {
+            mDirty = true;
+        }
         mVisible = visible;
         updateWaylandState();
     }
@@ -519,11 +573,50 @@ namespace RdkShell
     void RdkCompositor::setAnimating(bool animating)
     {
         mAnimating = animating;
+        mDirty = true;
     }
 
     void RdkCompositor::setHolePunch(bool holePunchEnabled)
     {
         mHolePunch = holePunchEnabled;
+        mDirty = true;
+    }
+
+    void RdkCompositor::setOpaque(bool opaque)
+    {
+        mOpaque = opaque;
+        mDirty = true;
+    }
+
+    void RdkCompositor::opaque(bool &opaque)
+    {
+        opaque = mOpaque;
+    }
+
+    bool RdkCompositor::coversBounds()
+    {
+        // only a client that declared its content opaque and is drawn without blending hides what is behind it
+        return mOpaque && mVisible && (mOpacity >= 1.0);
+    }
+
+    void RdkCompositor::setOccluded(bool occluded)
+    {
+        mOccluded = occluded;
+    }
+
+    bool RdkCompositor::isOccluded() const
+    {
+        return mOccluded;
+    }
+
+    uint64_t RdkCompositor::getFrameBufferMemory()
+    {
+        if (!mFbo)
+        {
+            return 0;
+        }
+        // the fbo color attachment is RGBA8888
+        return (uint64_t)mFbo->width() * mFbo->height() * 4;
     }
 
     void RdkCompositor::holePunch(bool &holePunchEnabled)
@@ -557,7 +650,7 @@ namespace RdkShell
 
     void RdkCompositor::broadcastInputEvent(const RdkShell::InputEvent &inputEvent)
     {
-        RdkShell::Logger::log(LogLevel::Information,  "sending input metadata for device: %d", inputEvent.deviceId);
+        RDKSHELL_LOG_INFO("sending input metadata for device: %d", inputEvent.deviceId);
         std::lock_guard<std::mutex> locker(mInputLock);
         for (const auto &listener : mInputListeners)
         {
@@ -724,11 +817,13 @@ namespace RdkShell
     {
         mVirtualWidth = (virtualWidth > 0) ? virtualWidth : mWidth;
         mVirtualHeight = (virtualHeight > 0) ? virtualHeight : mHeight;
+        mDirty = true;
     }
 
     void RdkCompositor::enableVirtualDisplay(bool enable)
     {
-        mVirtualDisplayEnabled = enable;   
+        mVirtualDisplayEnabled = enable;
+        mDirty = true;
     }
 
     bool RdkCompositor::getVirtualDisplayEnabled()
@@ -795,4 +890,47 @@ namespace RdkShell
         mFocused = focused;
         updateWaylandState();
     }
+
+    bool RdkCompositor::isDirty() const
+    {
+        return mDirty;
+    }
+
+    void RdkCompositor::clearDirty()
+    {
+        mDirty = false;
+    }
+
+    void RdkCompositor::screenBounds(RdkShellRect& rect)
+    {
+        int64_t left = mPositionX;
+        int64_t top = mPositionY;
+        int64_t right = left + (int64_t)ceil(mWidth * mScaleX);
+        int64_t bottom = top + (int64_t)ceil(mHeight * mScaleY);
+        left = (left < 0) ? 0 : left;
+        top = (top < 0) ? 0 : top;
+        if ((right <= left) || (bottom <= top))
+        {
+            rect = RdkShellRect();
+            return;
+        }
+        rect = RdkShellRect((uint32_t)left, (uint32_t)top, (uint32_t)(right - left), (uint32_t)(bottom - top));
+    }
+
+    void RdkCompositor::drawnRect(RdkShellRect& rect)
+    {
+        rect = mDrawnRect;
+    }
+
+    void RdkCompositor::damageRect(RdkShellRect& rect)
+    {
+        // both the area covered in the last frame and the area about to be covered need to be recomposed
+        rect = mDrawnRect;
+        if (mVisible)
+        {
+            RdkShellRect bounds;
+            screenBounds(bounds);
+            rect.unite(bounds);
+        }
+    }
 }
@@ -23,6 +23,7 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <functional>
 #include <unordered_map>
 #include "westeros-compositor.h"
@@ -62,6 +63,12 @@ namespace RdkShell
             void setAnimating(bool animating);
             void setHolePunch(bool holePunchEnabled);
             void holePunch(bool &holePunchEnabled);
+            void setOpaque(bool opaque);
+            void opaque(bool &opaque);
+            bool coversBounds();
+            void setOccluded(bool occluded);
+            bool isOccluded() const;
+            uint64_t getFrameBufferMemory();
             void keyMetadataEnabled(bool &enabled);
             void setKeyMetadataEnabled(bool enable);
             int registerInputEventListener(std::function<void(const RdkShell::InputEvent&)> listener);
@@ -84,6 +91,11 @@ namespace RdkShell
             void enableInputEvents(bool enable);
             bool getInputEventsEnabled() const;
             void setFocused(bool focused);
+            bool isDirty() const;
+            void clearDirty();
+            void screenBounds(RdkShellRect& rect);
+            void drawnRect(RdkShellRect& rect);
+            void damageRect(RdkShellRect& rect);
 
         private:
             void prepareHolePunchRects(std::vector<WstRect> wstrects, RdkShellRect& rect);
@@ -141,6 +153,10 @@ namespace RdkShell
             bool mInputEventsEnabled;
             bool mSuspendedBeforeStart;
             bool mFocused;
+            std::atomic<bool> mDirty;
+            RdkShellRect mDrawnRect;
+            bool mOpaque;
+            std::atomic<bool> mOccluded;
     };
 }
 
@@ -35,6 +35,11 @@
 #include "logger.h"
 #include "rdkshell.h"
 #include "rdkshellimage.h"
+#include "imagedecoder.h"
+#include "damagetracker.h"
+#include "framepacer.h"
+#include "framestats.h"
+#include "tracerecorder.h"
 #include "permissions.h"
 #include <unistd.h>
 #include <time.h>
@@ -49,6 +54,7 @@
 #define RDKSHELL_DEFAULT_CRITICALLY_LOW_MEMORY_THRESHOLD_MB 100
 #define RDKSHELL_DEFAULT_SWAP_INCREASE_THRESHOLD_MB 50
 #define RDKSHELL_SPLASH_SCREEN_FILE_CHECK "/tmp/.rdkshellsplash"
+#define RDKSHELL_FRAME_STATS_DUMP_INTERVAL_SECONDS 10
 
 int gCurrentFramerate = RDKSHELL_FPS;
 bool gRdkShellIsRunning = false;
@@ -62,6 +68,10 @@ double gSwapMemoryIncreaseThresoldInMb =  RDKSHELL_DEFAULT_SWAP_INCREASE_THRESHO
 bool gLowRamMemoryNotificationSent = false;
 bool gCriticallyLowRamMemoryNotificationSent = false;
 bool gForce720 = false;
+bool gAlwaysRedraw = false;
+bool gFramePending = false;
+std::string gFrameStatsDumpFile;
+double gFrameStatsDumpIntervalInSeconds = RDKSHELL_FRAME_STATS_DUMP_INTERVAL_SECONDS;
 
 #ifdef RDKSHELL_ENABLE_IPC
 std::shared_ptr<RdkShell::ServerMessageHandler> gServerMessageHandler;
@@ -115,7 +125,7 @@ namespace RdkShell
 
         if (0 != ret)
         {
-            Logger::log(Debug, "failed to get memory details");
+            RDKSHELL_LOG_DEBUG("failed to get memory details");
             return false;
         }
 	totalMemKb = (systemInformation.totalram * systemInformation.mem_unit)/1024;
@@ -127,7 +137,7 @@ namespace RdkShell
         FILE* file = fopen("/proc/meminfo", "r");
         if (!file)
         {
-            Logger::log(Debug, "failed to get memory details");
+            RDKSHELL_LOG_DEBUG("failed to get memory details");
             return false;
         }
         char buffer[128];
@@ -149,7 +159,7 @@ namespace RdkShell
                 }
                 else
 		{
-                    Logger::log(Debug, "failed to get memory details");
+                    RDKSHELL_LOG_DEBUG("failed to get memory details");
                 }
 		break;
             }
@@ -320,6 +330,52 @@ namespace RdkShell
             }
         }
 
+        char const *vsyncPacing = getenv("RDKSHELL_VSYNC_FRAME_PACING");
+        if (vsyncPacing && (strcmp(vsyncPacing, "1") == 0))
+        {
+            Logger::log(LogLevel::Information,  "RDKSHELL_VSYNC_FRAME_PACING is set, frame deadlines will follow buffer swaps");
+            RdkShell::FramePacer::instance()->enableVsyncAlignment(true);
+        }
+
+        char const *frameStatsFile = getenv("RDKSHELL_FRAME_STATS_FILE");
+        if (frameStatsFile)
+        {
+            gFrameStatsDumpFile = frameStatsFile;
+            char const *frameStatsInterval = getenv("RDKSHELL_FRAME_STATS_INTERVAL");
+            if (frameStatsInterval && (atof(frameStatsInterval) > 0))
+            {
+                gFrameStatsDumpIntervalInSeconds = atof(frameStatsInterval);
+            }
+            Logger::log(LogLevel::Information,  "frame stats will be written to %s every %f seconds", frameStatsFile, gFrameStatsDumpIntervalInSeconds);
+        }
+
+        char const *traceFile = getenv("RDKSHELL_TRACE_FILE");
+        if (traceFile)
+        {
+            double traceDuration = RDKSHELL_TRACE_DEFAULT_DURATION_SECONDS;
+            char const *traceDurationValue = getenv("RDKSHELL_TRACE_DURATION");
+            if (traceDurationValue && (atof(traceDurationValue) > 0))
+            {
+                traceDuration = atof(traceDurationValue);
+            }
+            RdkShell::TraceRecorder::instance()->setTraceFile(traceFile);
+            RdkShell::TraceRecorder::instance()->enableSignalTrigger(traceDuration);
+        }
+
+        char const *alwaysRedraw = getenv("RDKSHELL_ALWAYS_REDRAW");
+        if (alwaysRedraw && (strcmp(alwaysRedraw, "1") == 0))
+        {
+            Logger::log(LogLevel::Information,  "RDKSHELL_ALWAYS_REDRAW is set, frames will be composed even when nothing changed");
+            gAlwaysRedraw = true;
+        }
+
+        char const *partialUpdate = getenv("RDKSHELL_ENABLE_PARTIAL_UPDATE");
+        if (partialUpdate && (strcmp(partialUpdate, "1") == 0))
+        {
+            Logger::log(LogLevel::Information,  "RDKSHELL_ENABLE_PARTIAL_UPDATE is set, only damaged regions will be recomposed");
+            RdkShell::DamageTracker::instance()->enablePartialUpdates(true);
+        }
+
         char const *lowRamMemoryThresholdInMb = getenv("RDKSHELL_LOW_MEMORY_THRESHOLD");
         if (lowRamMemoryThresholdInMb)
         {
@@ -388,9 +444,17 @@ namespace RdkShell
         {
             gIpcEnabled = true;
         }
+        // requests are read and parsed on a dedicated thread unless RDKSHELL_ENABLE_IPC_THREAD is set to 0
+        bool useIpcThread = true;
+        char const* ipcThreadSetting = getenv("RDKSHELL_ENABLE_IPC_THREAD");
+        if (ipcThreadSetting && (strcmp(ipcThreadSetting,"0") == 0))
+        {
+            useIpcThread = false;
+        }
         if (gIpcEnabled)
         {
-            gServerMessageHandler = std::make_shared<RdkShell::ServerMessageHandler>();
+            Logger::log(LogLevel::Information,  "ipc thread enabled: %d", useIpcThread);
+            gServerMessageHandler = std::make_shared<RdkShell::ServerMessageHandler>(useIpcThread);
             gServerMessageHandler->start();
         }
         #endif
@@ -489,61 +553,96 @@ namespace RdkShell
         gMemoryMonitorMutex.unlock();
     }
 
+    static void composeFrame()
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        RdkShell::EssosInstance::instance()->resolution(width, height);
+        glViewport( 0, 0, width, height );
+
+        RdkShellRect damageRect;
+        bool fullDamage = !RdkShell::CompositorController::damageRegion(damageRect) || gAlwaysRedraw;
+        RdkShell::DamageTracker::instance()->beginFrame(width, height, fullDamage, damageRect);
+
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        {
+            RDKSHELL_TRACE_SPAN("frame", "compose");
+            RdkShell::FramePhaseTimer composeTimer(RdkShell::FramePhase::Compose);
+            RdkShell::CompositorController::draw();
+        }
+        RdkShell::DamageTracker::instance()->endFrame();
+    }
+
     void run()
     {
         gRdkShellIsRunning = true;
+        RdkShell::FramePacer* framePacer = RdkShell::FramePacer::instance();
+        framePacer->setFramerate(gCurrentFramerate);
+        double nextFrameStatsDumpTime = seconds() + gFrameStatsDumpIntervalInSeconds;
         while( gRdkShellIsRunning )
         {
-            update();
-            uint32_t width = 0;
-            uint32_t height = 0;
-            RdkShell::EssosInstance::instance()->resolution(width, height);
-            glViewport( 0, 0, width, height );
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_COLOR_BUFFER_BIT);
+            double frameStartTime = milliseconds();
+            {
+                RDKSHELL_TRACE_SPAN("frame", "frame");
+                update();
 
-            const double maxSleepTime = (1000 / gCurrentFramerate) * 1000;
-            double startFrameTime = microseconds();
-            RdkShell::CompositorController::draw();
-            RdkShell::EssosInstance::instance()->update();
+                // skip composition and the buffer swap when no client committed a frame and the scene is unchanged
+                bool redraw = gAlwaysRedraw || RdkShell::CompositorController::needsRedraw();
+                if (redraw)
+                {
+                    composeFrame();
+                }
+                {
+                    RDKSHELL_TRACE_SPAN("frame", "swap");
+                    RdkShell::EssosInstance::instance()->update(redraw);
+                }
+                if (redraw)
+                {
+                    framePacer->framePresented();
+                }
 
-            #ifdef RDKSHELL_ENABLE_WEBSOCKET_IPC
-            if (gWebsocketIpcEnabled)
-            {
-                gMessageHandler->poll();
+                #ifdef RDKSHELL_ENABLE_WEBSOCKET_IPC
+                if (gWebsocketIpcEnabled)
+                {
+                    gMessageHandler->poll();
+                }
+                #endif
             }
-            #endif
-            double frameTime = (int)microseconds() - (int)startFrameTime;
-            int32_t sleepTimeInMs = gCurrentFramerate - frameTime;
-            if (frameTime < maxSleepTime)
+            RdkShell::FrameStats::instance()->record(RdkShell::FramePhase::Frame, milliseconds() - frameStartTime);
+            if (!gFrameStatsDumpFile.empty() && (seconds() > nextFrameStatsDumpTime))
             {
-                int sleepTime = (int)maxSleepTime-(int)frameTime;
-                usleep(sleepTime);
+                RdkShell::FrameStats::instance()->dumpToFile(gFrameStatsDumpFile);
+                nextFrameStatsDumpTime = seconds() + gFrameStatsDumpIntervalInSeconds;
             }
+            framePacer->waitForNextFrame();
         }
     }
 
     void draw()
     {
-        RdkShell::EssosInstance::instance()->update();
-        uint32_t width = 0;
-        uint32_t height = 0;
-        RdkShell::EssosInstance::instance()->resolution(width, height);
-        glViewport( 0, 0, width, height );
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        RdkShell::CompositorController::draw();
+        // the frame composed by the previous call is presented here, so only swap when one is pending
+        RdkShell::EssosInstance::instance()->update(gFramePending);
+        gFramePending = gAlwaysRedraw || RdkShell::CompositorController::needsRedraw();
+        if (gFramePending)
+        {
+            composeFrame();
+        }
     }
 
     void update()
     {
+        RdkShell::TraceRecorder::instance()->update();
+        RDKSHELL_TRACE_SPAN("frame", "update");
+        RdkShell::FramePhaseTimer updateTimer(RdkShell::FramePhase::Update);
         #ifdef RDKSHELL_ENABLE_IPC
         if (gIpcEnabled)
         {
             gServerMessageHandler->process();
         }
         #endif
+        RdkShell::ImageDecoder::instance()->process();
         RdkShell::CompositorController::update();
     }
 }
@@ -22,6 +22,12 @@
 #include "logger.h"
 #include "essosinstance.h"
 #include "compositorcontroller.h"
+#include "damagetracker.h"
+#include "tracerecorder.h"
+#include "imagedecoder.h"
+#include "texturecache.h"
+#include "compressedtexture.h"
+#include "glprogramcache.h"
 #include <jpeglib.h>
 #include <png.h>
 #include <string.h>
@@ -33,23 +39,25 @@ namespace RdkShell
     {
         struct jpeg_error_mgr pub;
         jmp_buf setjmp_buffer;
+        char message[JMSG_LENGTH_MAX]; // per decode, jpegs are decoded on several threads
     };
 
-    char jpegLastErrorMsg[JMSG_LENGTH_MAX];
     void onJpegError(j_common_ptr cinfo)
     {
         jpegErrorManagerStruct* error = (jpegErrorManagerStruct*) cinfo->err;
-        ( *(cinfo->err->format_message) ) (cinfo, jpegLastErrorMsg);
+        ( *(cinfo->err->format_message) ) (cinfo, error->message);
         longjmp(error->setjmp_buffer, 1);
     }
 
+    // u_bounds holds the left top corner and the size of the image in clip space
     GLchar imageVertexShaderString[] =
         "attribute vec2 a_position; \n"
         "attribute vec2 a_uv; \n"
+        "uniform vec4 u_bounds; \n"
         "varying vec2 v_uv; \n"
         "void main() \n"
         "{ \n"
-        "  gl_Position = vec4(a_position, 0.0, 1.0); \n"
+        "  gl_Position = vec4(u_bounds.xy + a_position * u_bounds.zw, 0.0, 1.0); \n"
         "  v_uv = a_uv; \n"
         "} \n";
 
@@ -71,21 +79,30 @@ namespace RdkShell
         int bytesLeft;
     };
 
-    Image::Image() : mFileName(), mProgram(0), mVertexShader(0), mFragmentShader(0),
-        mResolutionLocation(0), mPositionLocation(0), mUvLocation(0), mTextureLocation(0), mTexture(0)
+    // every image draws with the same program, which keeps the bounds it was last given
+    struct ImageProgram
+    {
+        ImageProgram() : program(0), boundsLocation(-1), bounds{0.f, 0.f, 0.f, 0.f} {}
+        GLuint program;
+        GLint boundsLocation;
+        float bounds[4];
+    };
+    static ImageProgram sImageProgram;
+
+    Image::Image() : mFileName(), mTexture(0), mDecodeRequest(0), mReadyCallback()
     {
         initialize();
     }
 
     Image::Image(const std::string& fileName, int32_t x, int32_t y, int32_t width, int32_t height) : 
-        mFileName(), mProgram(0), mVertexShader(0), mFragmentShader(0), mX(x), mY(y), mWidth(width), mHeight(height),
-        mResolutionLocation(0), mPositionLocation(0), mUvLocation(0), mTextureLocation(0), mTexture(0)
+        mFileName(), mX(x), mY(y), mWidth(width), mHeight(height), mTexture(0), mDecodeRequest(0), mReadyCallback()
     {
         initialize();
         loadLocalFile(fileName);
     }
 
-    Image::Image(const char* imageData, int32_t width, int32_t height) : mWidth(width), mHeight(height)
+    Image::Image(const char* imageData, int32_t width, int32_t height) : mFileName(), mWidth(width), mHeight(height),
+        mTexture(0), mDecodeRequest(0), mReadyCallback()
     {
         initialize();
         loadImageData(imageData, mWidth*mHeight);
@@ -93,93 +110,25 @@ namespace RdkShell
 
     Image::~Image()
     {
+        cancelDecode();
         mFileName = "";
-        if (mTexture != 0)
-        {
-            glDeleteTextures(1, &mTexture);
-            mTexture = 0;
-        }
-        glDetachShader(mProgram, mFragmentShader);
-        glDetachShader(mProgram, mVertexShader);
-        glDeleteShader(mFragmentShader);
-        glDeleteShader(mVertexShader);
-        glDeleteProgram(mProgram);
+        releaseTexture();
     }
 
-    bool Image::createProgram(const GLchar* vertexShaderString, const char* fragmentShaderString)
+    void Image::initialize()
     {
-        GLint stat;
-
-        mFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        const GLchar *fragmentSource = (const GLchar *)fragmentShaderString;
-        glShaderSource(mFragmentShader, 1, &fragmentSource, NULL);
-        glCompileShader(mFragmentShader);
-        glGetShaderiv(mFragmentShader, GL_COMPILE_STATUS, &stat);
-
-        if (!stat)
+        if (sImageProgram.program != 0)
         {
-            Logger::log(LogLevel::Error, "error compiling the fragment shader %d", glGetError());
-
-            GLint maxLength = 0;
-            glGetShaderiv(mFragmentShader, GL_INFO_LOG_LENGTH, &maxLength);
-
-            std::vector<char> errorLog(maxLength);
-            glGetShaderInfoLog(mFragmentShader, maxLength, &maxLength, (char *) &errorLog[0]);
-
-            Logger::log(LogLevel::Error, "compile error: %s", (char *) &errorLog[0]);
-
-            glDeleteShader(mFragmentShader);
-            return false;
+            return;
         }
-
-        mVertexShader = glCreateShader(GL_VERTEX_SHADER);
-        const GLchar *vertextSource = (const GLchar *)vertexShaderString;
-        glShaderSource(mVertexShader, 1, &vertextSource, NULL);
-        glCompileShader(mVertexShader);
-        glGetShaderiv(mVertexShader, GL_COMPILE_STATUS, &stat);
-
-        if (!stat)
+        sImageProgram.program = GlProgramCache::instance()->program(imageVertexShaderString, imageFragmentShaderString);
+        if (sImageProgram.program != 0)
         {
-            char log[1000];
-            GLsizei len;
-            glGetShaderInfoLog(mVertexShader, 1000, &len, log);
-            Logger::log(LogLevel::Error, "compile error: %s", log);
-
-            Logger::log(LogLevel::Error, "error compiling the vertex shader %d", glGetError());
-
-            return false;
-        }
-
-        mProgram = glCreateProgram();
-        glAttachShader(mProgram, mFragmentShader);
-        glAttachShader(mProgram, mVertexShader);
-
-        return true;
-    }
-
-    void Image::initialize()
-    {
-        bool success = createProgram(imageVertexShaderString, imageFragmentShaderString);
-        if (success)
-        {
-            mPositionLocation = 0;
-            mUvLocation = 1;
-            glBindAttribLocation(mProgram, mPositionLocation, "a_position");
-            glBindAttribLocation(mProgram, mUvLocation,  "a_uv");
-
-            GLint stat;
-
-            glLinkProgram(mProgram);  // needed to put attribs into effect
-            glGetProgramiv(mProgram, GL_LINK_STATUS, &stat);
-
-            if (!stat)
-            {
-                char log[1000];
-                GLsizei len;
-                glGetProgramInfoLog(mProgram, 1000, &len, log);
-                Logger::log(LogLevel::Error, "error linking the program %s", log);
-            }
-            mTextureLocation = glGetUniformLocation(mProgram, "s_texture");
+            sImageProgram.boundsLocation = glGetUniformLocation(sImageProgram.program, "u_bounds");
+            glUseProgram(sImageProgram.program);
+            glUniform1i(glGetUniformLocation(sImageProgram.program, "s_texture"), 1);
+            glUniform4fv(sImageProgram.boundsLocation, 1, sImageProgram.bounds);
+            glUseProgram(0);
         }
     }
 
@@ -189,11 +138,10 @@ namespace RdkShell
         {
             return;
         }
-        glUseProgram(mProgram);
+        glUseProgram(sImageProgram.program);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, mTexture);
-        glUniform1i(mTextureLocation, 1);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -217,29 +165,14 @@ namespace RdkShell
             bottom = screenToClipSpace(mY + mHeight, screenHeight);
         }
 
-        const float vertices[4][2] =
-        {
-            {left, top},
-            {right, top},
-            {left, bottom},
-            {right, bottom}
-        };
-
-        static const float uvCoordinates[4][2] =
+        const float bounds[4] = { left, top, right - left, bottom - top };
+        if (memcmp(bounds, sImageProgram.bounds, sizeof(bounds)) != 0)
         {
-            { 0, 1},
-            { 1, 1},
-            { 0, 0},
-            { 1, 0}
-        };
+            memcpy(sImageProgram.bounds, bounds, sizeof(bounds));
+            glUniform4fv(sImageProgram.boundsLocation, 1, bounds);
+        }
 
-        glVertexAttribPointer(mPositionLocation, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-        glVertexAttribPointer(mUvLocation, 2, GL_FLOAT, GL_FALSE, 0, uvCoordinates);
-        glEnableVertexAttribArray(mPositionLocation);
-        glEnableVertexAttribArray(mUvLocation);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glDisableVertexAttribArray(mPositionLocation);
-        glDisableVertexAttribArray(mUvLocation);
+        GlProgramCache::instance()->drawQuad();
 
         glUseProgram(0);
     }
@@ -248,10 +181,20 @@ namespace RdkShell
     {
         uint32_t screenWidth, screenHeight;
         RdkShell::EssosInstance::instance()->resolution(screenWidth, screenHeight);
+        RdkShellRect repaintRect;
+        if (DamageTracker::instance()->repaintRect(repaintRect))
+        {
+            rect.intersect(repaintRect);
+            if (rect.isEmpty())
+            {
+                return;
+            }
+        }
         glEnable(GL_SCISSOR_TEST);
         glScissor(rect.x, screenHeight-rect.height-rect.y, rect.width, rect.height);
         draw();
         glDisable(GL_SCISSOR_TEST);
+        DamageTracker::instance()->applyScissor();
     }
 
     void Image::fileName(std::string& fileName)
@@ -259,61 +202,197 @@ namespace RdkShell
         fileName = mFileName;
     }
 
+    static GLuint uploadTexture(const DecodedImage& image)
+    {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        if (image.compressedFormat != 0)
+        {
+            if (!CompressedTexture::upload(image))
+            {
+                glDeleteTextures(1, &texture);
+                return 0;
+            }
+            return texture;
+        }
+
+        // decoded rows are tightly packed
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width, image.height, 0, image.format,
+                    GL_UNSIGNED_BYTE, image.pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return texture;
+    }
+
+    void Image::releaseTexture()
+    {
+        if (mTexture != 0)
+        {
+            TextureCache::instance()->release(mTexture);
+            mTexture = 0;
+        }
+    }
+
     bool Image::loadLocalFile(const std::string& fileName, uint32_t* imageWidth, uint32_t* imageHeight)
     {
         bool success = false;
         if (mFileName != fileName)
         {
+            cancelDecode();
             mFileName = fileName;
+            releaseTexture();
 
-            if (mTexture != 0)
+            std::string sourceFile = CompressedTexture::selectFile(fileName, CompressedTexture::isFormatSupported);
+            std::string cacheKey;
+            if (!TextureCache::fileKey(sourceFile, cacheKey))
             {
-                glDeleteTextures(1, &mTexture);
-                mTexture = 0;
+                Logger::log(LogLevel::Error, "unable to open %s", sourceFile.c_str());
+                return false;
             }
-
-            unsigned char *image = nullptr;
             int32_t width = 0;
             int32_t height = 0;
-            bool isPngImage = false, isBitMapImage = false;
-            if ((-1 != fileName.find(".bmp")) || (-1 != fileName.find(".BMP")))
-            {
-                isBitMapImage = true;
-                success = loadBmp(fileName, image, width, height);
-            }
-            else if (-1 != fileName.find(".png"))
+            mTexture = TextureCache::instance()->acquire(cacheKey, width, height);
+            if (0 == mTexture)
             {
-                success = loadPng(fileName, image, width, height);
-                isPngImage = true;
-            }
-            else
-            {
-                success = loadJpeg(fileName, image, width, height);
+                DecodedImage image;
+                GLuint texture = decodeFile(sourceFile, image) ? uploadTexture(image) : 0;
+                if (texture != 0)
+                {
+                    width = image.width;
+                    height = image.height;
+                    mTexture = TextureCache::instance()->add(cacheKey, texture, width, height, image.textureBytes());
+                }
+                else if ((image.compressedFormat != 0) && (CompressedTexture::selectFile(fileName, CompressedTexture::isFormatSupported) != sourceFile))
+                {
+                    // the driver rejected the compressed texture, its format is no longer supported so another file is picked
+                    mFileName.clear();
+                    return loadLocalFile(fileName, imageWidth, imageHeight);
+                }
             }
+            success = (mTexture != 0);
             if (success)
             {
                 if (imageWidth)
                     *imageWidth = width;
                 if (imageHeight)
                     *imageHeight = height;
+            }
+        }
+        return success;
+    }
 
-                glGenTextures(1, &mTexture);
-                glBindTexture(GL_TEXTURE_2D, mTexture);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    bool Image::loadLocalFileAsync(const std::string& fileName, ImageReadyCallback callback, uint32_t targetWidth, uint32_t targetHeight)
+    {
+        if (mFileName == fileName)
+        {
+            return (mTexture != 0) || (mDecodeRequest != 0);
+        }
+        cancelDecode();
+        mFileName = fileName;
+        releaseTexture();
 
-                
+        // missing files are still reported right away
+        std::string sourceFile = CompressedTexture::selectFile(fileName, CompressedTexture::isFormatSupported);
+        std::string cacheKey;
+        if (!TextureCache::fileKey(sourceFile, cacheKey))
+        {
+            Logger::log(LogLevel::Error, "unable to open %s", sourceFile.c_str());
+            return false;
+        }
+        if ((targetWidth > 0) && (targetHeight > 0))
+        {
+            cacheKey += "|" + std::to_string(targetWidth) + "x" + std::to_string(targetHeight);
+        }
+        int32_t width = 0;
+        int32_t height = 0;
+        mTexture = TextureCache::instance()->acquire(cacheKey, width, height);
+        if (mTexture != 0)
+        {
+            if (callback)
+            {
+                callback(true);
+            }
+            return true;
+        }
+        mReadyCallback = callback;
+        mDecodeRequest = ImageDecoder::instance()->decode(
+            [sourceFile, targetWidth, targetHeight](DecodedImage& image) { return Image::decodeFile(sourceFile, image, targetWidth, targetHeight); },
+            [this, sourceFile, cacheKey, targetWidth, targetHeight](GLuint texture, const DecodedImage& image)
+            {
+                onDecodeComplete(sourceFile, cacheKey, targetWidth, targetHeight, texture, image);
+            });
+        return true;
+    }
 
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-                glTexImage2D(GL_TEXTURE_2D, 0, (isPngImage||isBitMapImage)?GL_RGBA:GL_RGB,
-                            width, height, 0, (isPngImage||isBitMapImage)?GL_RGBA:GL_RGB,
-                            GL_UNSIGNED_BYTE, image);
+    void Image::cancelDecode()
+    {
+        if (mDecodeRequest != 0)
+        {
+            ImageDecoder::instance()->cancel(mDecodeRequest);
+            mDecodeRequest = 0;
+        }
+        mReadyCallback = nullptr;
+    }
+
+    void Image::onDecodeComplete(const std::string& sourceFile, const std::string& cacheKey, uint32_t targetWidth, uint32_t targetHeight,
+        GLuint texture, const DecodedImage& image)
+    {
+        mDecodeRequest = 0;
+        if ((0 == texture) && (image.compressedFormat != 0) &&
+            (CompressedTexture::selectFile(mFileName, CompressedTexture::isFormatSupported) != sourceFile))
+        {
+            // the driver rejected the compressed texture, its format is no longer supported so another file is decoded
+            std::string fileName;
+            fileName.swap(mFileName);
+            ImageReadyCallback retryCallback;
+            retryCallback.swap(mReadyCallback);
+            if (loadLocalFileAsync(fileName, retryCallback, targetWidth, targetHeight))
+            {
+                return;
             }
-            free(image);
+            mReadyCallback.swap(retryCallback);
+        }
+        if (0 == texture)
+        {
+            Logger::log(LogLevel::Error, "unable to decode %s", mFileName.c_str());
+        }
+        else
+        {
+            mTexture = TextureCache::instance()->add(cacheKey, texture, image.width, image.height, image.textureBytes());
+        }
+        // the callback may release this image, so nothing is touched after it
+        ImageReadyCallback callback;
+        callback.swap(mReadyCallback);
+        if (callback)
+        {
+            callback(texture != 0);
         }
-        return success;
+    }
+
+    bool Image::decodeFile(const std::string& fileName, DecodedImage& image, uint32_t targetWidth, uint32_t targetHeight)
+    {
+        if (CompressedTexture::isCompressedFile(fileName))
+        {
+            return CompressedTexture::load(fileName, image);
+        }
+        else if ((-1 != fileName.find(".bmp")) || (-1 != fileName.find(".BMP")))
+        {
+            image.format = GL_RGBA;
+            return loadBmp(fileName, image.pixels, image.width, image.height);
+        }
+        else if (-1 != fileName.find(".png"))
+        {
+            image.format = GL_RGBA;
+            return loadPng(fileName, image.pixels, image.width, image.height, targetWidth, targetHeight);
+        }
+        image.format = GL_RGB;
+        return loadJpeg(fileName, image.pixels, image.width, image.height, targetWidth, targetHeight);
     }
 
     void Image::bounds(int32_t& x, int32_t& y, int32_t& width, int32_t& height)
@@ -334,37 +413,33 @@ namespace RdkShell
 
     bool Image::loadImageData(const char* imageData, int32_t imageSize)
     {
-        bool success = false;
-        if (mTexture != 0)
+        releaseTexture();
+        if (NULL == imageData)
         {
-            glDeleteTextures(1, &mTexture);
-            mTexture = 0;
+            Logger::log(LogLevel::Error, "unable to access image data");
+            return false;
         }
 
-        unsigned char *image = nullptr;
+        std::string cacheKey = TextureCache::dataKey(imageData, imageSize);
         int32_t width = 0;
         int32_t height = 0;
-        bool isPngImage = true;
-        success = loadPngFromData(imageData, imageSize, image, width, height); 
-        if (success)
-        {
-            glGenTextures(1, &mTexture);
-            glBindTexture(GL_TEXTURE_2D, mTexture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-            glTexImage2D(GL_TEXTURE_2D, 0, (isPngImage)?GL_RGBA:GL_RGB,
-                        width, height, 0, (isPngImage)?GL_RGBA:GL_RGB,
-                        GL_UNSIGNED_BYTE, image);
-        }
-        free(image);
-        return success;
+        mTexture = TextureCache::instance()->acquire(cacheKey, width, height);
+        if (0 == mTexture)
+        {
+            DecodedImage image;
+            if (loadPngFromData(imageData, imageSize, image.pixels, image.width, image.height))
+            {
+                image.format = GL_RGBA;
+                mTexture = TextureCache::instance()->add(cacheKey, uploadTexture(image), image.width, image.height, image.textureBytes());
+            }
+        }
+        return mTexture != 0;
     }
 
-    bool Image::loadJpeg(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height)
+    bool Image::loadJpeg(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height,
+        uint32_t targetWidth, uint32_t targetHeight)
     {
+        RDKSHELL_TRACE_SPAN("image", "decodeJpeg");
         FILE *file;
         int depth;
         file = fopen(fileName.c_str(), "rb");
@@ -379,7 +454,7 @@ namespace RdkShell
         jpegError.pub.error_exit = onJpegError;
         if (setjmp(jpegError.setjmp_buffer))
         {
-            Logger::log(LogLevel::Error, "error decoding: %s", jpegLastErrorMsg);
+            Logger::log(LogLevel::Error, "error decoding: %s", jpegError.message);
             jpeg_destroy_decompress(&cinfo);
             fclose(file);
             return false;
@@ -387,23 +462,40 @@ namespace RdkShell
         jpeg_create_decompress(&cinfo);
         jpeg_stdio_src(&cinfo, file);
         jpeg_read_header(&cinfo, 0);
+        // grayscale jpegs are expanded so every jpeg is uploaded as rgb
+        cinfo.out_color_space = JCS_RGB;
         cinfo.scale_num = 1;
         cinfo.scale_denom = 1;
+        // libjpeg skips most of the work for the reduced sizes, pick the smallest one still covering the target
+        if ((targetWidth > 0) && (targetHeight > 0))
+        {
+            for (unsigned int denominator = 8; denominator > 1; denominator /= 2)
+            {
+                if (((cinfo.image_width / denominator) >= targetWidth) && ((cinfo.image_height / denominator) >= targetHeight))
+                {
+                    cinfo.scale_denom = denominator;
+                    break;
+                }
+            }
+        }
         jpeg_start_decompress(&cinfo);
         width = cinfo.output_width;
         height = cinfo.output_height;
-        depth = cinfo.num_components;
+        depth = cinfo.output_components;
         int32_t rowStride = width * depth;
-        image = (unsigned char *) malloc(width * height * depth);
-        JSAMPARRAY buffer = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, rowStride, 1);
-        int64_t nextImageIndex = 0;
+        image = (unsigned char *) malloc((size_t)rowStride * height);
+        if (NULL == image)
+        {
+            Logger::log(LogLevel::Error, "unable to allocate %dx%d image for %s", width, height, fileName.c_str());
+            jpeg_destroy_decompress(&cinfo);
+            fclose(file);
+            return false;
+        }
+        // scanlines are written straight into the image
         while( cinfo.output_scanline < cinfo.output_height )
         {
-            jpeg_read_scanlines( &cinfo, buffer, 1 );
-            for(int i = 0; i < rowStride; i++)
-            {
-                image[nextImageIndex++] = buffer[0][i];
-            }
+            JSAMPROW row = image + ((size_t)cinfo.output_scanline * rowStride);
+            jpeg_read_scanlines( &cinfo, &row, 1 );
         }
         fclose(file);
         jpeg_finish_decompress(&cinfo);
@@ -411,8 +503,10 @@ namespace RdkShell
         return true;
     }
 
-    bool Image::loadPng(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height)
+    bool Image::loadPng(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height,
+        uint32_t targetWidth, uint32_t targetHeight)
     {
+        RDKSHELL_TRACE_SPAN("image", "decodePng");
         FILE *file;
         int depth;
         file = fopen(fileName.c_str(), "rb");
@@ -486,41 +580,101 @@ namespace RdkShell
             }
             
             png_set_add_alpha(pngPointer, 0xff, PNG_FILLER_AFTER);
+
+            bool interlaced = (png_get_interlace_type(pngPointer, infoPointer) != PNG_INTERLACE_NONE);
+            if (interlaced)
+            {
+                png_set_interlace_handling(pngPointer);
+            }
             
             png_read_update_info(pngPointer, infoPointer);
 
-            if (!setjmp(png_jmpbuf(pngPointer)))
+            // non interlaced images are read a row at a time and reduced by averaging blocks of pixels on the way,
+            // so the full size image is never held in memory
+            int32_t factor = 1;
+            if ((targetWidth > 0) && (targetHeight > 0) && !interlaced)
             {
-                uint32_t rowBytes = png_get_rowbytes(pngPointer,infoPointer);
-                png_bytep* rowPointers = (png_bytep *)malloc(sizeof(png_bytep) * height);
-                if (NULL != rowPointers)
+                while (((uint32_t)(width / (factor * 2)) >= targetWidth) && ((uint32_t)(height / (factor * 2)) >= targetHeight))
                 {
-                    image = (unsigned char*) malloc(rowBytes * height);
-                    if (NULL != image)
+                    factor *= 2;
+                }
+            }
+            int32_t sourceWidth = width;
+            int32_t sourceHeight = height;
+            width = sourceWidth / factor;
+            height = sourceHeight / factor;
+            uint32_t rowBytes = png_get_rowbytes(pngPointer,infoPointer);
+            uint32_t outputRowBytes = width * 4;
+            image = (unsigned char*) malloc((size_t)outputRowBytes * height);
+            png_bytep rowBuffer = (factor > 1) ? (png_bytep) malloc(rowBytes) : NULL;
+            uint32_t* rowSums = (factor > 1) ? (uint32_t*) calloc(outputRowBytes, sizeof(uint32_t)) : NULL;
+            png_bytep* rowPointers = interlaced ? (png_bytep*) malloc(sizeof(png_bytep) * height) : NULL;
+            bool allocated = (NULL != image) && ((factor == 1) || ((NULL != rowBuffer) && (NULL != rowSums))) &&
+                (!interlaced || (NULL != rowPointers));
+
+            if (!allocated)
+            {
+                Logger::log(LogLevel::Error, "unable to create memory for image data [%s]", fileName.c_str());
+            }
+            else if (!setjmp(png_jmpbuf(pngPointer)))
+            {
+                if (interlaced)
+                {
+                    for (int row=0; row<height; row++)
                     {
-                        for (int row=0; row<height; row++)
-                        {
-                            rowPointers[row] = (png_byte*)((png_byte*)image + (row*rowBytes));
-                        }
-                        
-                        png_read_image(pngPointer, rowPointers);
-
-                        png_read_end(pngPointer, NULL);
-
-                        free(rowPointers);
-                        rowPointers = NULL;
-                        ret = true;
+                        rowPointers[row] = (png_byte*)((png_byte*)image + (row*rowBytes));
+                    }
+                    png_read_image(pngPointer, rowPointers);
+                }
+                else if (factor == 1)
+                {
+                    for (int row=0; row<height; row++)
+                    {
+                        png_read_row(pngPointer, image + ((size_t)row * outputRowBytes), NULL);
                     }
                 }
                 else
                 {
-                    Logger::log(LogLevel::Error, "unable to create memory for image data [%s]", fileName.c_str());
+                    uint32_t blockSize = factor * factor;
+                    for (int row=0; row<sourceHeight; row++)
+                    {
+                        png_read_row(pngPointer, rowBuffer, NULL);
+                        if (row >= height * factor)
+                        {
+                            // rows left over by the reduction are still read to reach the end of the image
+                            continue;
+                        }
+                        for (int column=0; column<width*factor; column++)
+                        {
+                            uint32_t* sum = rowSums + ((column / factor) * 4);
+                            png_bytep pixel = rowBuffer + (column * 4);
+                            sum[0] += pixel[0];
+                            sum[1] += pixel[1];
+                            sum[2] += pixel[2];
+                            sum[3] += pixel[3];
+                        }
+                        if ((row % factor) == (factor - 1))
+                        {
+                            png_bytep output = image + ((size_t)(row / factor) * outputRowBytes);
+                            for (uint32_t i = 0; i < outputRowBytes; i++)
+                            {
+                                output[i] = (png_byte)(rowSums[i] / blockSize);
+                            }
+                            memset(rowSums, 0, outputRowBytes * sizeof(uint32_t));
+                        }
+                    }
                 }
+
+                png_read_end(pngPointer, NULL);
+                ret = true;
             }
             else
             {
                 Logger::log(LogLevel::Error, "unable to read png info [%s]", fileName.c_str());
             }
+            free(rowPointers);
+            free(rowBuffer);
+            free(rowSums);
         }
         else
         {
@@ -533,6 +687,7 @@ namespace RdkShell
 
     bool Image::loadBmp(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height)
     {
+        RDKSHELL_TRACE_SPAN("image", "decodeBmp");
         FILE *file;
         int depth;
         file = fopen(fileName.c_str(), "rb");
@@ -569,7 +724,7 @@ namespace RdkShell
         fseek(file, 30, SEEK_SET);
         fread(&compressionMethod, 4, 1, file);
 
-        Logger::log(LogLevel::Debug, "Bitmap infoformation: filename[%s] width[%d] height[%d] bitsperpixel[%d] compressionmethod [%d]", fileName.c_str(), width, height, bitsPerPixel, compressionMethod);
+        RDKSHELL_LOG_DEBUG("Bitmap infoformation: filename[%s] width[%d] height[%d] bitsperpixel[%d] compressionmethod [%d]", fileName.c_str(), width, height, bitsPerPixel, compressionMethod);
 
         if ((width == 0) || (height == 0))
         {
@@ -631,7 +786,7 @@ namespace RdkShell
             }
         }
         fclose(file);
-        Logger::log(LogLevel::Debug, "completed reading bitmap file [%s]", fileName.c_str());
+        RDKSHELL_LOG_DEBUG("completed reading bitmap file [%s]", fileName.c_str());
         return true;
     }
 
@@ -649,6 +804,7 @@ namespace RdkShell
 
     bool Image::loadPngFromData(const char* imageData, int32_t imageSize, unsigned char *&image, int32_t &width, int32_t &height)
     {
+        RDKSHELL_TRACE_SPAN("image", "decodePngData");
         int depth;
         if (NULL == imageData)
         {
@@ -19,12 +19,18 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <GLES2/gl2.h>
 #include "rdkshellrect.h"
 
 namespace RdkShell
 {
+    struct DecodedImage;
+
+    // runs on the render thread once an image loaded in the background can be drawn, or failed to load
+    typedef std::function<void(bool success)> ImageReadyCallback;
+
     class Image
     {
         public:
@@ -36,28 +42,36 @@ namespace RdkShell
             void draw(RdkShellRect rect);
             void fileName(std::string& fileName);
             bool loadLocalFile(const std::string& fileName, uint32_t* imageWidth = nullptr, uint32_t* imageHeight = nullptr);
+            // decodes on the image decoder threads and draws nothing until the texture is uploaded. jpeg and png
+            // images larger than the target size are reduced while they are decoded, but never below it
+            bool loadLocalFileAsync(const std::string& fileName, ImageReadyCallback callback = nullptr,
+                uint32_t targetWidth = 0, uint32_t targetHeight = 0);
             void bounds(int32_t& x, int32_t& y, int32_t& width, int32_t& height);
             void setBounds(int32_t x, int32_t y, int32_t width, int32_t height);
             bool loadImageData(const char* imageData, int32_t imageSize);
         private:
-            bool createProgram(const GLchar* vertexShaderString, const GLchar* fragmentShaderString);
+            // the shader program is shared by all images
             void initialize();
-            bool loadJpeg(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height);
-            bool loadPng(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height);
-            bool loadBmp(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height);
-            bool loadPngFromData(const char* imageData, int32_t imageSize, unsigned char *&image, int32_t &width, int32_t &height);
+            // textures belong to the texture cache, images only hold a reference
+            void releaseTexture();
+            void cancelDecode();
+            void onDecodeComplete(const std::string& sourceFile, const std::string& cacheKey, uint32_t targetWidth, uint32_t targetHeight,
+                GLuint texture, const DecodedImage& image);
+            // the decoders do not touch the image, so they also run on the image decoder threads
+            static bool decodeFile(const std::string& fileName, DecodedImage& image, uint32_t targetWidth = 0, uint32_t targetHeight = 0);
+            static bool loadJpeg(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height,
+                uint32_t targetWidth = 0, uint32_t targetHeight = 0);
+            static bool loadPng(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height,
+                uint32_t targetWidth = 0, uint32_t targetHeight = 0);
+            static bool loadBmp(std::string fileName, unsigned char *&image, int32_t &width, int32_t &height);
+            static bool loadPngFromData(const char* imageData, int32_t imageSize, unsigned char *&image, int32_t &width, int32_t &height);
             std::string mFileName;
             int32_t mX;
             int32_t mY;
             int32_t mWidth;
             int32_t mHeight;
-            GLint mProgram;
-            GLint mVertexShader;
-            GLint mFragmentShader;
-            GLint mResolutionLocation;
-            GLint mPositionLocation;
-            GLint mUvLocation; 
-            GLint mTextureLocation;
             GLuint mTexture;
+            uint32_t mDecodeRequest;
+            ImageReadyCallback mReadyCallback;
     };
 }
@@ -19,6 +19,7 @@
 
 #include "rdkshelljson.h"
 #include "logger.h"
+#include "compositorcontroller.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -77,4 +78,215 @@ bool RdkShellJson::readJsonFile(const char* path, rapidjson::Document& document)
   }
   return true;
 }
+
+bool RdkShellJson::toRdkShellData(const rapidjson::Value& value, RdkShellData& data)
+{
+  if (value.IsBool())
+  {
+    data = value.GetBool();
+  }
+  else if (value.IsInt())
+  {
+    data = (int32_t)value.GetInt();
+  }
+  else if (value.IsUint())
+  {
+    data = (uint32_t)value.GetUint();
+  }
+  else if (value.IsNumber())
+  {
+    data = value.GetDouble();
+  }
+  else if (value.IsString())
+  {
+    data = std::string(value.GetString());
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+bool RdkShellJson::readBatchOperations(const rapidjson::Value& value, std::vector<BatchOperation>& operations)
+{
+  if (!value.IsArray())
+  {
+    Logger::log(LogLevel::Warn,  "batch operations must be an array");
+    return false;
+  }
+
+  operations.clear();
+  operations.reserve(value.Size());
+  for (rapidjson::SizeType i = 0; i < value.Size(); i++)
+  {
+    const rapidjson::Value& entry = value[i];
+    if (!entry.IsObject() || !entry.HasMember("method") || !entry["method"].IsString() ||
+        !entry.HasMember("client") || !entry["client"].IsString())
+    {
+      Logger::log(LogLevel::Warn,  "batch operation %u needs a method and a client", i);
+      return false;
+    }
+
+    BatchOperation operation;
+    operation.method = entry["method"].GetString();
+    operation.client = entry["client"].GetString();
+    if (entry.HasMember("properties") && entry["properties"].IsObject())
+    {
+      const rapidjson::Value& properties = entry["properties"];
+      for (rapidjson::Value::ConstMemberIterator it = properties.MemberBegin(); it != properties.MemberEnd(); ++it)
+      {
+        RdkShellData data;
+        if (!toRdkShellData(it->value, data))
+        {
+          Logger::log(LogLevel::Warn,  "batch operation %u has an unsupported value for %s", i, it->name.GetString());
+          return false;
+        }
+        operation.properties[it->name.GetString()] = data;
+      }
+    }
+    operations.push_back(operation);
+  }
+  return true;
+}
+
+void RdkShellJson::writeClientStats(JsonWriter& writer, const std::vector<ClientStats>& stats)
+{
+  writer.StartArray();
+  for (const ClientStats& clientStats : stats)
+  {
+    writer.StartObject();
+    writer.Key("client");
+    writer.String(clientStats.client.c_str(), (rapidjson::SizeType)clientStats.client.length());
+    writer.Key("framesComposed");
+    writer.Uint64(clientStats.framesComposed);
+    writer.Key("cpuTimeInMs");
+    writer.Double(clientStats.cpuTimeInMs);
+    writer.Key("maxCpuTimeInMs");
+    writer.Double(clientStats.maxCpuTimeInMs);
+    writer.Key("gpuTimeInMs");
+    writer.Double(clientStats.gpuTimeInMs);
+    writer.Key("surfaceCount");
+    writer.Uint(clientStats.surfaceCount);
+    writer.Key("frameBufferMemory");
+    writer.Uint64(clientStats.frameBufferMemory);
+    writer.EndObject();
+  }
+  writer.EndArray();
+}
+
+struct JsonMessageBuffers
+{
+  JsonMessageBuffers() : buffer(), writer(buffer), message() {}
+  rapidjson::StringBuffer buffer;
+  JsonWriter writer;
+  std::string message;
+};
+
+static thread_local JsonMessageBuffers sJsonMessageBuffers;
+
+JsonMessageWriter::JsonMessageWriter()
+{
+  // clearing keeps the capacity of the buffer
+  sJsonMessageBuffers.buffer.Clear();
+  sJsonMessageBuffers.writer.Reset(sJsonMessageBuffers.buffer);
+}
+
+JsonWriter& JsonMessageWriter::writer()
+{
+  return sJsonMessageBuffers.writer;
+}
+
+void JsonMessageWriter::beginResponse(const char* method)
+{
+  JsonWriter& jsonWriter = sJsonMessageBuffers.writer;
+  jsonWriter.StartObject();
+  jsonWriter.Key("type");
+  jsonWriter.String("response");
+  jsonWriter.Key("method");
+  jsonWriter.String(method);
+  jsonWriter.Key("params");
+  jsonWriter.StartObject();
+}
+
+void JsonMessageWriter::endResponse(bool success)
+{
+  JsonWriter& jsonWriter = sJsonMessageBuffers.writer;
+  jsonWriter.Key("success");
+  jsonWriter.Bool(success);
+  jsonWriter.EndObject();
+  jsonWriter.EndObject();
+}
+
+void JsonMessageWriter::beginEvent(const char* name)
+{
+  JsonWriter& jsonWriter = sJsonMessageBuffers.writer;
+  jsonWriter.StartObject();
+  jsonWriter.Key("type");
+  jsonWriter.String("event");
+  jsonWriter.Key("name");
+  jsonWriter.String(name);
+  jsonWriter.Key("params");
+}
+
+void JsonMessageWriter::endEvent()
+{
+  sJsonMessageBuffers.writer.EndObject();
+}
+
+const char* JsonMessageWriter::data() const
+{
+  return sJsonMessageBuffers.buffer.GetString();
+}
+
+size_t JsonMessageWriter::length() const
+{
+  return sJsonMessageBuffers.buffer.GetSize();
+}
+
+std::string& JsonMessageWriter::message()
+{
+  sJsonMessageBuffers.message.assign(sJsonMessageBuffers.buffer.GetString(), sJsonMessageBuffers.buffer.GetSize());
+  return sJsonMessageBuffers.message;
+}
+
+JsonRequest::JsonRequest() : mBuffer(), mAllocator(mArena, sizeof(mArena)), mDocument(&mAllocator)
+{
+}
+
+bool JsonRequest::parse(std::string& request)
+{
+  mBuffer.swap(request);
+  return parseBuffer();
+}
+
+bool JsonRequest::parse(const char* data, size_t length)
+{
+  mBuffer.assign(data, length);
+  return parseBuffer();
+}
+
+bool JsonRequest::parseBuffer()
+{
+  reset();
+  mDocument.ParseInsitu(&mBuffer[0]);
+  return !mDocument.HasParseError() && mDocument.IsObject();
+}
+
+void JsonRequest::reset()
+{
+  // values allocated from the pool are never freed individually, drop the old document before clearing the pool
+  mDocument.SetObject();
+  mAllocator.Clear();
+}
+
+rapidjson::Document& JsonRequest::document()
+{
+  return mDocument;
+}
+
+rapidjson::Document::AllocatorType& JsonRequest::allocator()
+{
+  return mAllocator;
+}
 }
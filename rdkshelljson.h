@@ -25,13 +25,76 @@
 #include "rapidjson/error/en.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
+#include "rdkshelldata.h"
+
+#include <vector>
 
 namespace RdkShell
 {
+    struct BatchOperation;
+    struct ClientStats;
+
+    typedef rapidjson::Writer<rapidjson::StringBuffer> JsonWriter;
+
     class RdkShellJson
     {
       public:
         static bool readJsonFile(const char* path, rapidjson::Document& document);
+        static bool toRdkShellData(const rapidjson::Value& value, RdkShellData& data);
+        static bool readBatchOperations(const rapidjson::Value& value, std::vector<BatchOperation>& operations);
+        static void writeClientStats(JsonWriter& writer, const std::vector<ClientStats>& stats);
+    };
+
+    /*
+        JsonMessageWriter serializes an ipc response or event into a per thread buffer that is reused for every
+        message, so once the buffer has grown to the largest message no allocation is done. only one message
+        can be built at a time on a thread, a new JsonMessageWriter discards the previous contents.
+    */
+    class JsonMessageWriter
+    {
+      public:
+        JsonMessageWriter();
+        JsonWriter& writer();
+        // {"type":"response","method":<method>,"params":{ ... "success":<success>}}, results go in between
+        void beginResponse(const char* method);
+        void endResponse(bool success);
+        // {"type":"event","name":<name>,"params": ... }, the caller writes the params value
+        void beginEvent(const char* name);
+        void endEvent();
+        const char* data() const;
+        size_t length() const;
+        // the serialized message in a reused per thread string, for transports taking a std::string
+        std::string& message();
+    };
+
+    #define RDKSHELL_JSON_REQUEST_ARENA_SIZE 4096
+
+    /*
+        JsonRequest parses an ipc request in place: the document strings point into the request buffer and the
+        values are allocated from an arena inside the object. reusing a JsonRequest for the next request keeps
+        both the buffer and the arena, so typical requests are parsed without touching the heap.
+    */
+    class JsonRequest
+    {
+      public:
+        JsonRequest();
+        // takes over the contents of request, which is left with the previous buffer of this object
+        bool parse(std::string& request);
+        bool parse(const char* data, size_t length);
+        // prepares an empty object document to be filled through allocator()
+        void reset();
+        rapidjson::Document& document();
+        rapidjson::Document::AllocatorType& allocator();
+
+      private:
+        JsonRequest(const JsonRequest&);
+        JsonRequest& operator=(const JsonRequest&);
+        bool parseBuffer();
+
+        std::string mBuffer;
+        char mArena[RDKSHELL_JSON_REQUEST_ARENA_SIZE];
+        rapidjson::MemoryPoolAllocator<> mAllocator;
+        rapidjson::Document mDocument;
     };
 }
 
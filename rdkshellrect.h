@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <algorithm>
+
 namespace RdkShell
 {
     struct RdkShellRect
@@ -26,6 +29,54 @@ namespace RdkShell
         public:
             RdkShellRect(): x(0), y(0), width(0), height(0) {}
             RdkShellRect(uint32_t xval, uint32_t yval, uint32_t w, uint32_t h):x(xval), y(yval), width(w), height(h) {} 
+
+            bool isEmpty() const
+            {
+                return (width == 0) || (height == 0);
+            }
+
+            bool contains(const RdkShellRect& other) const
+            {
+                return (other.x >= x) && (other.y >= y) &&
+                    (other.x + other.width <= x + width) && (other.y + other.height <= y + height);
+            }
+
+            void unite(const RdkShellRect& other)
+            {
+                if (other.isEmpty())
+                {
+                    return;
+                }
+                if (isEmpty())
+                {
+                    *this = other;
+                    return;
+                }
+                uint32_t right = std::max(x + width, other.x + other.width);
+                uint32_t bottom = std::max(y + height, other.y + other.height);
+                x = std::min(x, other.x);
+                y = std::min(y, other.y);
+                width = right - x;
+                height = bottom - y;
+            }
+
+            void intersect(const RdkShellRect& other)
+            {
+                uint32_t left = std::max(x, other.x);
+                uint32_t top = std::max(y, other.y);
+                uint32_t right = std::min(x + width, other.x + other.width);
+                uint32_t bottom = std::min(y + height, other.y + other.height);
+                if ((right <= left) || (bottom <= top))
+                {
+                    *this = RdkShellRect();
+                    return;
+                }
+                x = left;
+                y = top;
+                width = right - left;
+                height = bottom - top;
+            }
+
             uint32_t x;
             uint32_t y;
             uint32_t width;
@@ -20,264 +20,499 @@
 #include "servermessagehandler.h"
 #include "compositorcontroller.h"
 #include "communicationfactory.h"
-#include <sstream> 
+#include "framestats.h"
+#include "rdkshelljson.h"
+#include "ipcmethods.h"
+#include "binaryprotocol.h"
+#include "tracerecorder.h"
+#include "logger.h"
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+
+#define RDKSHELL_IPC_QUEUE_SIZE 256
+#define RDKSHELL_IPC_MAX_COMMANDS_PER_FRAME 64
+#define RDKSHELL_IPC_THREAD_WAIT_SECONDS 1
 
 namespace RdkShell
 {
-    /* message handlers */
-    static bool createDisplayHandler(int id, const rapidjson::Value& params, void* context);
-    static bool launchApplicationHandler(int id, const rapidjson::Value& params, void* context);
-    static bool killHandler(int id, const rapidjson::Value& params, void* context);
-    static bool setBoundsHandler(int id, const rapidjson::Value& params, void* context);
-    static bool setScaleHandler(int id, const rapidjson::Value& params, void* context);
-    static bool getBoundsHandler(int id, const rapidjson::Value& params, void* context);
-    static bool getScaleHandler(int id, const rapidjson::Value& params, void* context);
-    static bool addAnimationHandler(int id, const rapidjson::Value& params, void* context);
-  
-    ServerMessageHandler::ServerMessageHandler(): mHandlerMap(), mCommunicationHandler(NULL)
+    ServerMessageHandler::ServerMessageHandler(bool useIpcThread): mHandlerMap(), mCommunicationHandler(NULL),
+        mUseIpcThread(useIpcThread), mIpcThreadRunning(false), mIpcThread(),
+        mCommandQueue(RDKSHELL_IPC_QUEUE_SIZE), mBlockedCommand(), mRequestsPaused(false), mOutgoingQueue(RDKSHELL_IPC_QUEUE_SIZE),
+        mOutgoingOverflow(), mRecycledRequests(RDKSHELL_IPC_QUEUE_SIZE), mSpareRequest(), mPendingAnimations(), mPendingSizeChanges(),
+        mUserInactivePending(false), mInactiveMinutes(0.0), mAnimationEventId(findIpcEvent(RDKSHELL_EVENT_ANIMATION.c_str())),
+        mSizeChangeEventId(findIpcEvent(RDKSHELL_EVENT_SIZE_CHANGE_COMPLETE.c_str())), mUserInactiveEventId(findIpcEvent(RDKSHELL_EVENT_USER_INACTIVE.c_str()))
     {
         mCommunicationHandler = createCommunicationHandler(true);
         mCommunicationHandler->setListener(this);
         initializeMessageHandlers();
     }
+
+    ServerMessageHandler::~ServerMessageHandler()
+    {
+        stopIpcThread();
+    }
   
     void ServerMessageHandler::initializeMessageHandlers()
     {
-        mHandlerMap["kill"] = &killHandler;
-        mHandlerMap["createDisplay"] = &createDisplayHandler;
-        mHandlerMap["launchApplication"] = &launchApplicationHandler;
-        mHandlerMap["getBounds"] = getBoundsHandler;
-        mHandlerMap["setBounds"] = setBoundsHandler;
-        mHandlerMap["getScale"] = getScaleHandler;
-        mHandlerMap["setScale"] = setScaleHandler;
-        mHandlerMap["addAnimation"] = addAnimationHandler;
+        if (!IpcMethods::registerMethods(mHandlerMap))
+        {
+            Logger::log(LogLevel::Error, "unable to build the ipc method table");
+        }
     }
   
     void ServerMessageHandler::start()
     {
         CompositorController::setEventListener(shared_from_this());
         mCommunicationHandler->initialize();
+        if (mUseIpcThread)
+        {
+            mIpcThreadRunning = true;
+            mIpcThread = std::thread(&ServerMessageHandler::ipcThreadLoop, this);
+        }
     }
   
     void ServerMessageHandler::process()
     {
-        mCommunicationHandler->process();
+        RDKSHELL_TRACE_SPAN("ipc", "process");
+        FramePhaseTimer ipcTimer(FramePhase::Ipc);
+        sendCoalescedEvents();
+        if (!mUseIpcThread)
+        {
+            mCommunicationHandler->process();
+            return;
+        }
+
+        // the requests were already read and parsed on the ipc thread, only the handlers run on the render thread.
+        // no more requests are run while their responses cannot be handed to the ipc thread, the command queue
+        // then fills up and the ipc thread stops reading requests
+        IpcCommand command;
+        bool dispatched = false;
+        for (int i = 0; (i < RDKSHELL_IPC_MAX_COMMANDS_PER_FRAME) && flushOutgoingOverflow() && mCommandQueue.pop(command); i++)
+        {
+            dispatch(command.id, *command.method, command.acknowledge, command.request->document()["params"]);
+            releaseRequest(std::move(command.request));
+            dispatched = true;
+        }
+        // the ipc thread waits for room in the queue before it reads requests again, the fence pairs with the
+        // one in submitRequest so either the flag is seen here or the room is seen there
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (dispatched && mRequestsPaused)
+        {
+            mCommunicationHandler->wakeup();
+        }
     }
   
     void ServerMessageHandler::stop()
     {
+        stopIpcThread();
         CompositorController::setEventListener(nullptr);
         mCommunicationHandler->setListener(nullptr);
         mCommunicationHandler->terminate();
     }
-  
-    void ServerMessageHandler::sendErrorResponse(int id, std::string& method)
+
+    void ServerMessageHandler::stopIpcThread()
     {
-        std::stringstream response;
-        response << "{\"type\":\"response\", \"method\":\"" << method.c_str() << "\",\"params\":{ \"success\":" << std::boolalpha << false << "}}";
-        std::string message(response.str());
-        if (mCommunicationHandler)
+        if (mIpcThread.joinable())
         {
-            mCommunicationHandler->sendMessage(id, message);
+            mIpcThreadRunning = false;
+            mCommunicationHandler->wakeup();
+            mIpcThread.join();
         }
     }
-  
-    void ServerMessageHandler::onMessageReceived(int id, std::string& request)
+
+    void ServerMessageHandler::ipcThreadLoop()
     {
-        Document d;
-        d.Parse(request.c_str());
-  
-        if (d.HasMember("method") && d.HasMember("params"))
+        while (mIpcThreadRunning)
         {
-            std::string method =  d["method"].GetString();
-            const rapidjson::Value& params = d["params"];
-            if ((mHandlerMap.find(method) != mHandlerMap.end()))
+            sendOutgoingMessages();
+            if (mRequestsPaused && mCommandQueue.push(std::move(mBlockedCommand)))
             {
-                bool ret = mHandlerMap[method](id, params, this);
-                if (false == ret)
-                {
-                    sendErrorResponse(id, method);
-                }
+                mRequestsPaused = false;
+                mCommunicationHandler->pauseRequests(false);
             }
+            // returns early when the render thread queues a response or makes room for requests
+            mCommunicationHandler->process(RDKSHELL_IPC_THREAD_WAIT_SECONDS);
         }
     }
-  
-    bool createDisplayHandler(int id, const rapidjson::Value& params, void* context)
+
+    void ServerMessageHandler::sendOutgoingMessages()
     {
-        std::string client = params["0"].GetString();
-        std::string display = params.HasMember("1")?params["1"].GetString():"";
-        return CompositorController::createDisplay(client, display);
+        IpcOutgoingMessage outgoing;
+        while (mOutgoingQueue.pop(outgoing))
+        {
+            if (outgoing.isCompletion)
+            {
+                mCommunicationHandler->completeRequest(outgoing.id);
+            }
+            else if (outgoing.isEvent)
+            {
+                mCommunicationHandler->sendEvent(outgoing.eventId, outgoing.message);
+            }
+            else
+            {
+                mCommunicationHandler->sendMessage(outgoing.id, outgoing.message);
+            }
+        }
     }
-    
-    bool launchApplicationHandler(int id, const rapidjson::Value& params, void* context)
+
+    // returns true when nothing is left waiting for room in the outgoing queue
+    bool ServerMessageHandler::flushOutgoingOverflow()
     {
-        std::string client = params["0"].GetString();
-        std::string uri = params["1"].GetString();
-        std::string mime = params["2"].GetString();
-        return CompositorController::launchApplication(client, uri, mime);
+        bool pushed = false;
+        while (!mOutgoingOverflow.empty() && mOutgoingQueue.push(std::move(mOutgoingOverflow.front())))
+        {
+            mOutgoingOverflow.pop_front();
+            pushed = true;
+        }
+        if (pushed)
+        {
+            mCommunicationHandler->wakeup();
+        }
+        return mOutgoingOverflow.empty();
     }
-  
-    bool killHandler(int id, const rapidjson::Value& params, void* context)
+
+    /*
+        a client waits for every response and the communication handler keeps every request until it is
+        completed, so those are kept in order until the ipc thread makes room. events are dropped instead
+    */
+    bool ServerMessageHandler::pushOutgoingMessage(IpcOutgoingMessage& outgoing)
     {
-        std::string client = params["0"].GetString();
-        return CompositorController::kill(client);
+        bool queued = flushOutgoingOverflow() && mOutgoingQueue.push(std::move(outgoing));
+        if (!queued)
+        {
+            if (outgoing.isEvent)
+            {
+                Logger::log(LogLevel::Warn, "ipc outgoing queue is full, dropping event");
+                return false;
+            }
+            mOutgoingOverflow.push_back(std::move(outgoing));
+            return true;
+        }
+        mCommunicationHandler->wakeup();
+        return true;
     }
-  
-    bool setBoundsHandler(int id, const rapidjson::Value& params, void* context)
+
+    bool ServerMessageHandler::queueOutgoingMessage(int id, bool isEvent, int eventId, std::string& message)
+    {
+        IpcOutgoingMessage outgoing;
+        outgoing.id = id;
+        outgoing.isEvent = isEvent;
+        outgoing.eventId = eventId;
+        outgoing.message = message;
+        return pushOutgoingMessage(outgoing);
+    }
+
+    // the communication handler keeps every request until it is answered, the ones without a response are
+    // completed on the thread that reads the requests
+    void ServerMessageHandler::completeRequest(int id)
     {
-        std::string client = params["0"].GetString();
-        unsigned int x=0, y=0, w=0, h=0;
-        if (false == CompositorController::getBounds(client, x, y, w, h))
+        if (!mUseIpcThread)
         {
-            return false;
+            mCommunicationHandler->completeRequest(id);
+            return;
+        }
+        IpcOutgoingMessage outgoing;
+        outgoing.id = id;
+        outgoing.isCompletion = true;
+        pushOutgoingMessage(outgoing);
+    }
+
+    bool ServerMessageHandler::sendMessage(int id, std::string& message)
+    {
+        if (mUseIpcThread)
+        {
+            return queueOutgoingMessage(id, false, -1, message);
+        }
+        return (NULL != mCommunicationHandler) && mCommunicationHandler->sendMessage(id, message);
+    }
+
+    void ServerMessageHandler::sendEvent(int eventId, std::string& event)
+    {
+        if (mUseIpcThread)
+        {
+            queueOutgoingMessage(-1, true, eventId, event);
+        }
+        else if (NULL != mCommunicationHandler)
+        {
+            mCommunicationHandler->sendEvent(eventId, event);
         }
-        x = params.HasMember("1")?params["1"].GetUint():x;
-        y = params.HasMember("2")?params["2"].GetUint():y;
-        w = params.HasMember("3")?params["3"].GetUint():w;
-        h = params.HasMember("4")?params["4"].GetUint():h;
-        return CompositorController::setBounds(client, x, y, w, h);
     }
   
-    bool setScaleHandler(int id, const rapidjson::Value& params, void* context)
+    void ServerMessageHandler::dispatch(int id, const IpcMethod& method, bool acknowledge, const rapidjson::Value& params)
     {
-        std::string client = params["0"].GetString();
-        double sx=1.0, sy=1.0;
-        if (false == CompositorController::getScale(client, sx, sy))
+        // methods without results only respond when they fail, unless the client asked for an acknowledgement
+        JsonMessageWriter response;
+        response.beginResponse(method.schema->name);
+        IpcResult result(response.writer(), false);
+        bool ret = IpcMethods::invoke(method, params, false, result);
+        if (ret && !acknowledge && !IpcMethods::hasResults(method))
         {
-            return false;
+            completeRequest(id);
+            return;
         }
-        sx = params.HasMember("1")?params["1"].GetDouble():sx;
-        sy = params.HasMember("2")?params["2"].GetDouble():sy;
-        return CompositorController::setScale(client, sx, sy);
+        response.endResponse(ret);
+        sendMessage(id, response.message());
     }
   
-    bool addAnimationHandler(int id, const rapidjson::Value& params, void* context)
+    std::unique_ptr<JsonRequest> ServerMessageHandler::acquireRequest()
     {
-        std::string client = params["0"].GetString();
-        double duration = params["1"].GetDouble();
-        std::map<std::string, RdkShellData> animationProperties;
-        if (params.HasMember("2"))
+        // the spare request is only used by the thread reading requests, a rejected request is kept there
+        std::unique_ptr<JsonRequest> request(std::move(mSpareRequest));
+        if (!request && mUseIpcThread)
         {
-            animationProperties["x"] = params["2"].GetUint();
+            mRecycledRequests.pop(request);
         }
-        if (params.HasMember("3"))
+        if (!request)
         {
-            animationProperties["y"] = params["3"].GetUint();
+            request.reset(new JsonRequest());
         }
-        if (params.HasMember("4"))
+        return request;
+    }
+
+    void ServerMessageHandler::releaseRequest(std::unique_ptr<JsonRequest> request)
+    {
+        if (mUseIpcThread)
         {
-            animationProperties["w"] = params["4"].GetUint();
+            // a full queue just lets the request be freed
+            mRecycledRequests.push(std::move(request));
         }
-        if (params.HasMember("5"))
+        else
         {
-            animationProperties["h"] = params["5"].GetUint();
+            mSpareRequest = std::move(request);
         }
-        if (params.HasMember("6"))
+    }
+
+    void ServerMessageHandler::onMessageReceived(int id, std::string& message)
+    {
+        RDKSHELL_TRACE_SPAN("ipc", "parseRequest");
+        std::unique_ptr<JsonRequest> request(acquireRequest());
+        if (!request->parse(message))
         {
-            animationProperties["sx"] = params["6"].GetUint();
+            Logger::log(LogLevel::Warn, "ignoring malformed ipc request");
+            mSpareRequest = std::move(request);
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        if (params.HasMember("7"))
+
+        Document& d = request->document();
+        Value::ConstMemberIterator methodIterator = d.FindMember("method");
+        if ((methodIterator == d.MemberEnd()) || !methodIterator->value.IsString() || !d.HasMember("params"))
+        {
+            mSpareRequest = std::move(request);
+            mCommunicationHandler->completeRequest(id);
+            return;
+        }
+        Value::ConstMemberIterator acknowledgeIterator = d.FindMember("ack");
+        bool acknowledge = (acknowledgeIterator != d.MemberEnd()) && acknowledgeIterator->value.IsTrue();
+        const IpcMethodTable::Entry* method = mHandlerMap.find(methodIterator->value.GetString(), methodIterator->value.GetStringLength());
+        if (NULL == method)
         {
-            animationProperties["sy"] = params["7"].GetDouble();
+            handleSubscriptionRequest(id, methodIterator->value.GetString(), acknowledge, d["params"]);
+            mSpareRequest = std::move(request);
+            return;
         }
-        return CompositorController::addAnimation(client, duration, animationProperties);
+        submitRequest(id, *method, acknowledge, std::move(request));
     }
-  
-    bool getBoundsHandler(int id, const rapidjson::Value& params, void* context)
+
+    void ServerMessageHandler::onBinaryMessageReceived(int id, uint16_t methodId, std::string& payload)
     {
-        std::stringstream response;
-        std::string client = params["0"].GetString();
-        unsigned int x=0, y=0, w=0, h=0;
-        bool ret = CompositorController::getBounds(client, x, y, w, h);
-        response << "{\"type\":\"response\", \"method\":\"getBounds\", \"params\":{";
-        if (true == ret)
+        RDKSHELL_TRACE_SPAN("ipc", "decodeBinaryRequest");
+        bool acknowledge = (methodId & RDKSHELL_BINARY_ACKNOWLEDGE_FLAG) != 0;
+        methodId &= ~RDKSHELL_BINARY_ACKNOWLEDGE_FLAG;
+        const char* methodName = binaryMethodName(methodId);
+        if (NULL == methodName)
         {
-            response << "\"success\":" << std::boolalpha << true << ",\"x\":" << x << ",\"y\":" << y << ",\"w\":" << w << ",\"h\":" << h;
+            Logger::log(LogLevel::Warn, "ignoring binary request for unknown method %u", methodId);
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        else
+        const IpcMethodTable::Entry* method = mHandlerMap.find(methodName, strlen(methodName));
+        if (NULL == method)
         {
-            response << "\"success\":" << std::boolalpha << false;
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        response << "}}";
-        std::string message(response.str());
-        if (NULL != context)
+
+        // the parameters are decoded straight into the same document layout a json request has
+        std::unique_ptr<JsonRequest> request(acquireRequest());
+        request->reset();
+        rapidjson::Value params;
+        if (!decodeBinaryParameters(payload.data(), payload.length(), params, request->allocator()))
         {
-            ((ServerMessageHandler*)context)->communicationHandler()->sendMessage(id,message);
+            Logger::log(LogLevel::Warn, "ignoring malformed binary request for %s", methodName);
+            mSpareRequest = std::move(request);
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        return true;
+        request->document().AddMember("params", params, request->allocator());
+        submitRequest(id, *method, acknowledge, std::move(request));
     }
-  
-    bool getScaleHandler(int id, const rapidjson::Value& params, void* context)
+
+    /*
+        subscriptions belong to the connection rather than the compositor, so they are handled on the thread
+        reading the request and never reach the render thread
+    */
+    void ServerMessageHandler::handleSubscriptionRequest(int id, const char* method, bool acknowledge, const rapidjson::Value& params)
     {
-        std::stringstream response;
-        std::string client = params["0"].GetString();
-        double sx=0, sy=0;
-        bool ret = CompositorController::getScale(client, sx, sy);
-        response << "{\"type\":\"response\", \"method\":\"getScale\", \"params\":{";
-        if (true == ret)
+        bool subscribe = (strcmp(method, "subscribeEvent") == 0);
+        if (!subscribe && (strcmp(method, "unsubscribeEvent") != 0))
         {
-            response << "\"success\":" << std::boolalpha << true << ",\"sx\":" << sx << ",\"sy\":" << sy;
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        else
+        IpcArguments arguments(*findIpcMethodSchema(method), params, false);
+        bool ret = arguments.validate();
+        if (ret)
         {
-            response << "\"success\":" << std::boolalpha << false;
+            std::string event = arguments.getString(0);
+            ret = mCommunicationHandler->subscribeEvent(id, findIpcEvent(event.c_str()), subscribe);
+            if (!ret)
+            {
+                Logger::log(LogLevel::Warn, "unable to %s event %s", method, event.c_str());
+            }
         }
-        response << "}}";
-        std::string message(response.str());
-        if (NULL != context)
+        if (ret && !acknowledge)
         {
-            ((ServerMessageHandler*)context)->communicationHandler()->sendMessage(id,message);
+            mCommunicationHandler->completeRequest(id);
+            return;
         }
-        return true;
+        JsonMessageWriter response;
+        response.beginResponse(method);
+        response.endResponse(ret);
+        mCommunicationHandler->sendMessage(id, response.message());
+    }
+
+    void ServerMessageHandler::submitRequest(int id, const IpcMethodTable::Entry& method, bool acknowledge, std::unique_ptr<JsonRequest> request)
+    {
+        if (!mUseIpcThread)
+        {
+            dispatch(id, *method.handler, acknowledge, request->document()["params"]);
+            releaseRequest(std::move(request));
+            return;
+        }
+
+        IpcCommand command;
+        command.id = id;
+        command.method = method.handler;
+        command.acknowledge = acknowledge;
+        command.request = std::move(request);
+        if (mCommandQueue.push(std::move(command)))
+        {
+            return;
+        }
+        // the render thread is behind, the ipc thread keeps sending responses but stops reading requests
+        // until there is room, so the clients are slowed down instead of their requests being dropped
+        mRequestsPaused = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mCommandQueue.push(std::move(command)))
+        {
+            mRequestsPaused = false;
+            return;
+        }
+        mBlockedCommand = std::move(command);
+        mCommunicationHandler->pauseRequests(true);
     }
-    
+  
     void ServerMessageHandler::onAnimation(std::vector<std::map<std::string, RdkShellData>>& animationData)
     {
-        std::stringstream response;
-        bool isFirstClient= true;
-        response << "{\"type\":\"event\", \"name\": \"onAnimation\", \"params\":[";
-        for (int i=0; i<animationData.size(); i++)
+        mPendingAnimations.insert(mPendingAnimations.end(), animationData.begin(), animationData.end());
+    }
+
+    void ServerMessageHandler::onSizeChangeComplete(const std::string& client)
+    {
+        if (std::find(mPendingSizeChanges.begin(), mPendingSizeChanges.end(), client) == mPendingSizeChanges.end())
         {
-            std::map<std::string, RdkShellData>& data = animationData[i];
-            if (!isFirstClient)
-            {
-                response << ",";
-            }
-            isFirstClient= false;
-            response << "{";
-            bool isFirstProperty = true;
-            for ( const auto &property : data )
+            mPendingSizeChanges.push_back(client);
+        }
+    }
+
+    void ServerMessageHandler::onUserInactive(const double minutes)
+    {
+        mUserInactivePending = true;
+        mInactiveMinutes = minutes;
+    }
+
+    /*
+        sendCoalescedEvents sends the events collected since the last frame, one event of each kind carrying
+        everything that happened, so a client never gets more than one of them per frame
+    */
+    void ServerMessageHandler::sendCoalescedEvents()
+    {
+        if (!mPendingAnimations.empty())
+        {
+            JsonMessageWriter response;
+            response.beginEvent("onAnimation");
+            JsonWriter& writer = response.writer();
+            writer.StartArray();
+            for (size_t i=0; i<mPendingAnimations.size(); i++)
             {
-                if (!isFirstProperty)
-                {
-                    response << ",";
-                }
-                isFirstProperty = false; 
-                response << "\"" << property.first << "\":";
-                if (property.first == "x" || property.first == "y")
-                {
-                    response << property.second.toInteger32();
-                }
-                else if (property.first == "w" || property.first == "h")
-                {
-                    response << property.second.toUnsignedInteger32();
-                }
-                else if (property.first == "sx" || property.first == "sy")
+                writer.StartObject();
+                for ( const auto &property : mPendingAnimations[i] )
                 {
-                    response << property.second.toDouble();
-                }
-                else if (property.first == "client")
-                {
-                    response << "\"" << property.second.toString() << "\"";
+                    if (property.first == "x" || property.first == "y")
+                    {
+                        writer.Key(property.first.c_str(), (rapidjson::SizeType)property.first.length());
+                        writer.Int(property.second.toInteger32());
+                    }
+                    else if (property.first == "w" || property.first == "h")
+                    {
+                        writer.Key(property.first.c_str(), (rapidjson::SizeType)property.first.length());
+                        writer.Uint(property.second.toUnsignedInteger32());
+                    }
+                    else if (property.first == "sx" || property.first == "sy")
+                    {
+                        writer.Key(property.first.c_str(), (rapidjson::SizeType)property.first.length());
+                        writer.Double(property.second.toDouble());
+                    }
+                    else if (property.first == "client")
+                    {
+                        std::string client = property.second.toString();
+                        writer.Key("client");
+                        writer.String(client.c_str(), (rapidjson::SizeType)client.length());
+                    }
                 }
+                writer.EndObject();
             }
-            response << "}";
+            writer.EndArray();
+            response.endEvent();
+            sendEvent(mAnimationEventId, response.message());
+            mPendingAnimations.clear();
         }
-        response << "]}";
-        std::string message(response.str());
-        if (mCommunicationHandler)
+
+        if (!mPendingSizeChanges.empty())
+        {
+            JsonMessageWriter response;
+            response.beginEvent("onSizeChangeComplete");
+            JsonWriter& writer = response.writer();
+            writer.StartArray();
+            for (size_t i=0; i<mPendingSizeChanges.size(); i++)
+            {
+                writer.StartObject();
+                writer.Key("client");
+                writer.String(mPendingSizeChanges[i].c_str(), (rapidjson::SizeType)mPendingSizeChanges[i].length());
+                writer.EndObject();
+            }
+            writer.EndArray();
+            response.endEvent();
+            sendEvent(mSizeChangeEventId, response.message());
+            mPendingSizeChanges.clear();
+        }
+
+        if (mUserInactivePending)
         {
-            mCommunicationHandler->sendEvent(message);
+            JsonMessageWriter response;
+            response.beginEvent("onUserInactive");
+            JsonWriter& writer = response.writer();
+            writer.StartArray();
+            writer.StartObject();
+            writer.Key("minutes");
+            writer.Double(mInactiveMinutes);
+            writer.EndObject();
+            writer.EndArray();
+            response.endEvent();
+            sendEvent(mUserInactiveEventId, response.message());
+            mUserInactivePending = false;
         }
     }
   
@@ -22,13 +22,18 @@
 
 #include "communicationhandler.h"
 #include <iostream>
+#include <deque>
 #include <memory>
 #include <map>
 #include <vector>
 #include <string>
 #include "rdkshelldata.h"
 #include "rdkshellevents.h"
+#include "spscqueue.h"
+#include "ipcmethods.h"
 #include "rapidjson/document.h"
+#include <atomic>
+#include <thread>
 
 using namespace rapidjson;
 
@@ -37,22 +42,82 @@ namespace RdkShell
     class ServerMessageHandler: public RdkShellClientListener, public RdkShellEventListener, public std::enable_shared_from_this<ServerMessageHandler>
     {
         public:
-            ServerMessageHandler();
+            ServerMessageHandler(bool useIpcThread=false);
+            virtual ~ServerMessageHandler();
             void start();
             void process();
             void stop();
+            bool sendMessage(int id, std::string& message);
+            void sendEvent(int eventId, std::string& event);
             /* RdkShellClientListener methods */
             virtual void onMessageReceived(int id, std::string& message);
+            virtual void onBinaryMessageReceived(int id, uint16_t methodId, std::string& payload);
   
             /* RdkShellEventListener methods */
             virtual void onAnimation(std::vector<std::map<std::string, RdkShellData>>& animationData);
+            virtual void onSizeChangeComplete(const std::string& client);
+            virtual void onUserInactive(const double minutes);
             CommunicationHandler* communicationHandler();
   
         private:
+            // a request parsed on the ipc thread and executed on the render thread
+            struct IpcCommand
+            {
+                IpcCommand() : id(-1), method(NULL), acknowledge(false), request() {}
+                int id;
+                const IpcMethod* method;
+                bool acknowledge;
+                std::unique_ptr<JsonRequest> request;
+            };
+
+            // a response or event produced on the render thread and sent by the ipc thread
+            struct IpcOutgoingMessage
+            {
+                IpcOutgoingMessage() : id(-1), isEvent(false), isCompletion(false), eventId(-1), message() {}
+                int id;
+                bool isEvent;
+                bool isCompletion; // the request id gets no response
+                int eventId;
+                std::string message;
+            };
+
             void initializeMessageHandlers();
-            void sendErrorResponse(int id, std::string& method);
-            std::map<std::string, bool(*)(int, const rapidjson::Value&, void*)> mHandlerMap;
+            void dispatch(int id, const IpcMethod& method, bool acknowledge, const rapidjson::Value& params);
+            std::unique_ptr<JsonRequest> acquireRequest();
+            void releaseRequest(std::unique_ptr<JsonRequest> request);
+            void submitRequest(int id, const IpcMethodTable::Entry& method, bool acknowledge, std::unique_ptr<JsonRequest> request);
+            bool queueOutgoingMessage(int id, bool isEvent, int eventId, std::string& message);
+            bool pushOutgoingMessage(IpcOutgoingMessage& outgoing);
+            bool flushOutgoingOverflow();
+            void completeRequest(int id);
+            void handleSubscriptionRequest(int id, const char* method, bool acknowledge, const rapidjson::Value& params);
+            void sendCoalescedEvents();
+            void ipcThreadLoop();
+            void sendOutgoingMessages();
+            void stopIpcThread();
+            IpcMethodTable mHandlerMap;
             CommunicationHandler* mCommunicationHandler;
+            bool mUseIpcThread;
+            std::atomic<bool> mIpcThreadRunning;
+            std::thread mIpcThread;
+            SpscQueue<IpcCommand> mCommandQueue;
+            // the request that did not fit into the command queue, no requests are read until it is queued
+            IpcCommand mBlockedCommand;
+            std::atomic<bool> mRequestsPaused;
+            SpscQueue<IpcOutgoingMessage> mOutgoingQueue;
+            // responses and completions that did not fit into the outgoing queue, render thread only
+            std::deque<IpcOutgoingMessage> mOutgoingOverflow;
+            // parsed requests handed back from the render thread so the ipc thread can reuse their buffers
+            SpscQueue<std::unique_ptr<JsonRequest>> mRecycledRequests;
+            std::unique_ptr<JsonRequest> mSpareRequest;
+            // high rate events collected on the render thread and sent once per frame
+            std::vector<std::map<std::string, RdkShellData>> mPendingAnimations;
+            std::vector<std::string> mPendingSizeChanges;
+            bool mUserInactivePending;
+            double mInactiveMinutes;
+            int mAnimationEventId;
+            int mSizeChangeEventId;
+            int mUserInactiveEventId;
     };
 }
 #endif  //RDKSHELL_SERVER_MESSAGE_HANDLER_H
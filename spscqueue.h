@@ -0,0 +1,92 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+
+#define RDKSHELL_CACHE_LINE_SIZE 64
+
+namespace RdkShell
+{
+    /*
+        SpscQueue is a bounded lock-free queue for exactly one producer thread and one consumer thread.
+        the capacity is rounded up to a power of two. push fails instead of blocking when the queue is full.
+    */
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        explicit SpscQueue(size_t capacity) : mSlots(roundUpToPowerOfTwo(capacity)), mMask(mSlots.size() - 1), mHead(0), mTail(0)
+        {
+        }
+
+        // producer only
+        bool push(T&& item)
+        {
+            size_t tail = mTail.load(std::memory_order_relaxed);
+            if ((tail - mHead.load(std::memory_order_acquire)) == mSlots.size())
+            {
+                return false;
+            }
+            mSlots[tail & mMask] = std::move(item);
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer only
+        bool pop(T& item)
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            if (head == mTail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = std::move(mSlots[head & mMask]);
+            mHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+        }
+
+    private:
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        std::vector<T> mSlots;
+        size_t mMask;
+        // head and tail are written by different threads, keep them on separate cache lines
+        char mPadding0[RDKSHELL_CACHE_LINE_SIZE];
+        std::atomic<size_t> mHead;
+        char mPadding1[RDKSHELL_CACHE_LINE_SIZE];
+        std::atomic<size_t> mTail;
+    };
+}
@@ -0,0 +1,299 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "compressedtexture.h"
+#include "imagedecoder.h"
+#include "logger.h"
+#include "rdkshell.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace RdkShell;
+
+// the test does not link rdkshell.cpp, the decoder and the trace recorder only need its clocks
+namespace RdkShell
+{
+    double seconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ((double)ts.tv_nsec/1000000000);
+    }
+
+    double milliseconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((double)(ts.tv_sec * 1000) + ((double)ts.tv_nsec/1000000));
+    }
+
+    double microseconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((double)(ts.tv_sec * 1000000) + ((double)ts.tv_nsec/1000));
+    }
+}
+
+#define TEST_ETC1_RGB8 0x8D64
+#define TEST_RGBA8_ETC2_EAC 0x9278
+#define TEST_ASTC_8x8 0x93B7
+
+static int sFailures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            Logger::log(LogLevel::Error, "%s:%d check failed: %s", __FILE__, __LINE__, #condition); \
+            sFailures++; \
+        } \
+    } while (0)
+
+static std::vector<unsigned char> pkmFile(const char* version, uint16_t type, uint16_t width, uint16_t height, size_t dataSize)
+{
+    std::vector<unsigned char> data(16 + dataSize, 0);
+    memcpy(data.data(), "PKM ", 4);
+    memcpy(data.data() + 4, version, 2);
+    data[6] = type >> 8;
+    data[7] = type & 0xFF;
+    data[8] = width >> 8;
+    data[9] = width & 0xFF;
+    data[10] = height >> 8;
+    data[11] = height & 0xFF;
+    data[12] = width >> 8;
+    data[13] = width & 0xFF;
+    data[14] = height >> 8;
+    data[15] = height & 0xFF;
+    return data;
+}
+
+static void writeKtx32(std::vector<unsigned char>& data, size_t offset, uint32_t value)
+{
+    memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+// little endian ktx with a single 2d level, imageSize is written after the key value data when it fits
+static std::vector<unsigned char> ktxFile(GLenum format, uint32_t width, uint32_t height, uint32_t keyValueBytes, uint32_t imageSize, size_t dataSize)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    size_t fileSize = 64 + (size_t)keyValueBytes + 4 + dataSize;
+    std::vector<unsigned char> data((keyValueBytes > 1024) ? 64 : fileSize, 0);
+    memcpy(data.data(), identifier, sizeof(identifier));
+    writeKtx32(data, 12, 0x04030201);
+    writeKtx32(data, 28, format);
+    writeKtx32(data, 36, width);
+    writeKtx32(data, 40, height);
+    writeKtx32(data, 52, 1);
+    writeKtx32(data, 56, 1);
+    writeKtx32(data, 60, keyValueBytes);
+    if (data.size() == fileSize)
+    {
+        writeKtx32(data, 64 + keyValueBytes, imageSize);
+    }
+    return data;
+}
+
+static void testParse()
+{
+    CompressedTextureInfo info;
+
+    std::vector<unsigned char> pkm = pkmFile("10", 0, 30, 18, 0);
+    CHECK(CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    CHECK(info.format == TEST_ETC1_RGB8);
+    CHECK((info.width == 30) && (info.height == 18));
+    CHECK(info.dataOffset == 16);
+    CHECK(info.dataSize == 8 * 5 * 8);
+
+    pkm = pkmFile("20", 3, 4, 4, 0);
+    CHECK(CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    CHECK(info.format == TEST_RGBA8_ETC2_EAC);
+    CHECK(info.dataSize == 16);
+
+    // version 1 only has etc1, type 2 is not supported and the version must be known
+    pkm = pkmFile("10", 1, 4, 4, 0);
+    CHECK(!CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    pkm = pkmFile("20", 2, 4, 4, 0);
+    CHECK(!CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    pkm = pkmFile("30", 0, 4, 4, 0);
+    CHECK(!CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    pkm = pkmFile("10", 0, 0, 4, 0);
+    CHECK(!CompressedTexture::parse(pkm.data(), pkm.size(), info));
+    pkm = pkmFile("10", 0, 4, 4, 0);
+    CHECK(!CompressedTexture::parse(pkm.data(), 15, info));
+
+    std::vector<unsigned char> ktx = ktxFile(TEST_ASTC_8x8, 20, 9, 16, 48, 48);
+    CHECK(CompressedTexture::parse(ktx.data(), ktx.size(), info));
+    CHECK(info.format == TEST_ASTC_8x8);
+    CHECK((info.width == 20) && (info.height == 9));
+    CHECK(info.dataOffset == 64 + 16 + 4);
+    CHECK(info.dataSize == 48);
+
+    // only the header was read, the size comes from the format
+    ktx = ktxFile(TEST_ASTC_8x8, 20, 9, 16, 1000, 48);
+    CHECK(CompressedTexture::parse(ktx.data(), 64, info));
+    CHECK(info.dataSize == 3 * 2 * 16);
+
+    // big endian files are swapped
+    ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    for (size_t offset = 12; offset < ktx.size(); offset += 4)
+    {
+        std::swap(ktx[offset], ktx[offset + 3]);
+        std::swap(ktx[offset + 1], ktx[offset + 2]);
+    }
+    CHECK(CompressedTexture::parse(ktx.data(), ktx.size(), info));
+    CHECK((info.format == TEST_ETC1_RGB8) && (info.width == 8) && (info.dataSize == 32));
+
+    ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    CHECK(!CompressedTexture::parse(ktx.data(), 63, info));
+    writeKtx32(ktx, 16, GL_UNSIGNED_BYTE);
+    CHECK(!CompressedTexture::parse(ktx.data(), ktx.size(), info));
+    ktx = ktxFile(GL_RGBA, 8, 8, 0, 256, 256);
+    CHECK(!CompressedTexture::parse(ktx.data(), ktx.size(), info));
+    ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    writeKtx32(ktx, 52, 6);
+    CHECK(!CompressedTexture::parse(ktx.data(), ktx.size(), info));
+
+    // the key value data claims more than the file holds
+    ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0xFFFFFFFF, 32, 32);
+    if (CompressedTexture::parse(ktx.data(), ktx.size(), info))
+    {
+        CHECK(info.dataOffset > ktx.size());
+        CHECK(info.dataSize == 32);
+    }
+    ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    writeKtx32(ktx, 60, 0xFFFFFFF0);
+    if (CompressedTexture::parse(ktx.data(), ktx.size(), info))
+    {
+        CHECK(info.dataOffset > ktx.size());
+    }
+
+    // the block count of the largest sizes does not fit
+    ktx = ktxFile(TEST_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF, 0, 16, 16);
+    CHECK(!CompressedTexture::parse(ktx.data(), ktx.size(), info));
+    CHECK(CompressedTexture::expectedSize(TEST_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF) == 0);
+    CHECK(CompressedTexture::expectedSize(GL_RGBA, 4, 4) == 0);
+}
+
+static std::string sDirectory;
+
+static std::string writeFile(const char* name, const std::vector<unsigned char>& data)
+{
+    std::string fileName = sDirectory + "/" + name;
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (NULL == file)
+    {
+        Logger::log(LogLevel::Error, "unable to write %s", fileName.c_str());
+        sFailures++;
+        return fileName;
+    }
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+    return fileName;
+}
+
+static void testLoad()
+{
+    DecodedImage image;
+    CHECK(CompressedTexture::load(writeFile("etc1.pkm", pkmFile("10", 0, 8, 4, 16)), image));
+    CHECK((image.width == 8) && (image.height == 4));
+    CHECK((image.compressedFormat == TEST_ETC1_RGB8) && (image.compressedSize == 16));
+
+    // padding after the blocks is neither uploaded nor accounted
+    DecodedImage paddedImage;
+    CHECK(CompressedTexture::load(writeFile("padded.ktx", ktxFile(TEST_ASTC_8x8, 8, 8, 8, 64, 64)), paddedImage));
+    CHECK(paddedImage.compressedSize == 16);
+    CHECK(paddedImage.textureBytes() == 16);
+
+    DecodedImage truncatedImage;
+    CHECK(!CompressedTexture::load(writeFile("truncated.pkm", pkmFile("10", 0, 8, 8, 16)), truncatedImage));
+    CHECK(!CompressedTexture::load(writeFile("short.ktx", ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 64, 32)), truncatedImage));
+    CHECK(!CompressedTexture::load(writeFile("small.ktx", ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 16, 16)), truncatedImage));
+    CHECK(!CompressedTexture::load(writeFile("header.ktx", ktxFile(TEST_ETC1_RGB8, 8, 8, 0xFFFFFFFF, 32, 32)), truncatedImage));
+    std::vector<unsigned char> ktx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    writeKtx32(ktx, 60, 0xFFFFFFF0);
+    CHECK(!CompressedTexture::load(writeFile("keyvalue.ktx", ktx), truncatedImage));
+    CHECK(NULL == truncatedImage.pixels);
+}
+
+static void testSelectFile()
+{
+    auto supported = [](GLenum format) { return format == TEST_ETC1_RGB8; };
+    auto unsupported = [](GLenum) { return false; };
+
+    std::vector<unsigned char> png(8, 0);
+    std::string pngFile = writeFile("a.png", png);
+    std::string ktxFileName = writeFile("a.ktx", ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32));
+    CHECK(CompressedTexture::selectFile(pngFile, supported) == ktxFileName);
+    CHECK(CompressedTexture::selectFile(pngFile, unsupported) == pngFile);
+    CHECK(CompressedTexture::selectFile(ktxFileName, supported) == ktxFileName);
+    CHECK(CompressedTexture::selectFile(ktxFileName, unsupported) == pngFile);
+
+    // a pkm is used when the ktx next to it is truncated or in a format the gpu does not have
+    std::string jpgFile = writeFile("b.jpg", png);
+    std::vector<unsigned char> truncatedKtx = ktxFile(TEST_ETC1_RGB8, 8, 8, 0, 32, 32);
+    truncatedKtx.resize(40);
+    writeFile("b.ktx", truncatedKtx);
+    std::string pkmFileName = writeFile("b.pkm", pkmFile("10", 0, 8, 8, 32));
+    CHECK(CompressedTexture::selectFile(jpgFile, supported) == pkmFileName);
+    writeFile("b.ktx", ktxFile(TEST_ASTC_8x8, 8, 8, 0, 16, 16));
+    CHECK(CompressedTexture::selectFile(jpgFile, supported) == pkmFileName);
+    CHECK(CompressedTexture::selectFile(jpgFile, unsupported) == jpgFile);
+
+    // without a file to decode in software the compressed file is kept
+    std::string aloneFile = writeFile("c.ktx", ktxFile(TEST_ASTC_8x8, 8, 8, 0, 16, 16));
+    CHECK(CompressedTexture::selectFile(aloneFile, unsupported) == aloneFile);
+    std::string oversizedFile = writeFile("d.ktx", ktxFile(TEST_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF, 0, 32, 32));
+    std::string oversizedFallback = writeFile("d.bmp", png);
+    CHECK(CompressedTexture::selectFile(oversizedFile, [](GLenum) { return true; }) == oversizedFallback);
+
+    std::string missingFile = sDirectory + "/missing.png";
+    CHECK(CompressedTexture::selectFile(missingFile, supported) == missingFile);
+}
+
+int main()
+{
+    char directory[] = "/tmp/rdkshell_compressed_texture_XXXXXX";
+    if (NULL == mkdtemp(directory))
+    {
+        Logger::log(LogLevel::Error, "unable to create a test directory");
+        return 1;
+    }
+    sDirectory = directory;
+
+    testParse();
+    testLoad();
+    testSelectFile();
+
+    std::string removeCommand = "rm -rf " + sDirectory;
+    if (system(removeCommand.c_str()) != 0)
+    {
+        Logger::log(LogLevel::Warn, "unable to remove %s", sDirectory.c_str());
+    }
+    Logger::log(LogLevel::Information, "compressed texture test %s, %d failed checks", (sFailures == 0) ? "passed" : "failed", sFailures);
+    return (sFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "texturecache.h"
+#include "logger.h"
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace RdkShell
+{
+    TextureCache::TextureCache() : mBytes(0), mBudgetBytes((uint64_t)RDKSHELL_TEXTURE_CACHE_DEFAULT_BUDGET_MB * 1024 * 1024),
+        mHits(0), mMisses(0), mEvictions(0)
+    {
+        char const *budget = getenv("RDKSHELL_TEXTURE_CACHE_BUDGET_MB");
+        if (budget && (atoi(budget) >= 0))
+        {
+            mBudgetBytes = (uint64_t)atoi(budget) * 1024 * 1024;
+        }
+    }
+
+    TextureCache::~TextureCache()
+    {
+    }
+
+    TextureCache *TextureCache::instance()
+    {
+        // never destroyed, images released while the process exits still return their textures
+        static TextureCache* textureCache = new TextureCache();
+
+        return textureCache;
+    }
+
+    bool TextureCache::fileKey(const std::string& fileName, std::string& key)
+    {
+        struct stat fileStat;
+        if (stat(fileName.c_str(), &fileStat) != 0)
+        {
+            return false;
+        }
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), "|%lld|%lld.%09ld", (long long)fileStat.st_size, (long long)fileStat.st_mtim.tv_sec, fileStat.st_mtim.tv_nsec);
+        key = fileName + suffix;
+        return true;
+    }
+
+    std::string TextureCache::dataKey(const char* data, size_t size)
+    {
+        // fnv-1a
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 1099511628211ULL;
+        }
+        char key[64];
+        snprintf(key, sizeof(key), "data|%zu|%016llx", size, (unsigned long long)hash);
+        return key;
+    }
+
+    GLuint TextureCache::acquire(const std::string& key, int32_t& width, int32_t& height)
+    {
+        auto entryIterator = mEntries.find(key);
+        if (entryIterator == mEntries.end())
+        {
+            mMisses++;
+            return 0;
+        }
+        Entry& entry = entryIterator->second;
+        addReference(entry);
+        mHits++;
+        width = entry.width;
+        height = entry.height;
+        return entry.texture;
+    }
+
+    GLuint TextureCache::add(const std::string& key, GLuint texture, int32_t width, int32_t height, uint64_t bytes)
+    {
+        auto entryIterator = mEntries.find(key);
+        if (entryIterator != mEntries.end())
+        {
+            glDeleteTextures(1, &texture);
+            addReference(entryIterator->second);
+            return entryIterator->second.texture;
+        }
+
+        Entry entry;
+        entry.texture = texture;
+        entry.width = width;
+        entry.height = height;
+        entry.bytes = bytes;
+        entry.references = 1;
+        entry.idleIterator = mIdleEntries.end();
+        mEntries[key] = entry;
+        mKeysByTexture[texture] = key;
+        mBytes += entry.bytes;
+        trim();
+        return texture;
+    }
+
+    void TextureCache::addReference(Entry& entry)
+    {
+        if (0 == entry.references++)
+        {
+            mIdleEntries.erase(entry.idleIterator);
+        }
+    }
+
+    void TextureCache::release(GLuint texture)
+    {
+        auto keyIterator = mKeysByTexture.find(texture);
+        if (keyIterator == mKeysByTexture.end())
+        {
+            Logger::log(LogLevel::Warn, "releasing texture %u that is not cached", texture);
+            glDeleteTextures(1, &texture);
+            return;
+        }
+        Entry& entry = mEntries[keyIterator->second];
+        if ((entry.references > 0) && (0 == --entry.references))
+        {
+            entry.idleIterator = mIdleEntries.insert(mIdleEntries.end(), keyIterator->second);
+            trim();
+        }
+    }
+
+    void TextureCache::trim()
+    {
+        // textures in use are never evicted, so the cache can stay over budget until they are released
+        while ((mBytes > mBudgetBytes) && !mIdleEntries.empty())
+        {
+            auto entryIterator = mEntries.find(mIdleEntries.front());
+            mIdleEntries.pop_front();
+            Entry& entry = entryIterator->second;
+            glDeleteTextures(1, &entry.texture);
+            mKeysByTexture.erase(entry.texture);
+            mBytes -= entry.bytes;
+            mEvictions++;
+            mEntries.erase(entryIterator);
+        }
+    }
+
+    void TextureCache::setBudget(uint64_t budgetInBytes)
+    {
+        mBudgetBytes = budgetInBytes;
+        trim();
+    }
+
+    void TextureCache::stats(TextureCacheStats& cacheStats)
+    {
+        cacheStats.entries = mEntries.size();
+        cacheStats.entriesInUse = mEntries.size() - mIdleEntries.size();
+        cacheStats.bytes = mBytes;
+        cacheStats.budgetBytes = mBudgetBytes;
+        cacheStats.hits = mHits;
+        cacheStats.misses = mMisses;
+        cacheStats.evictions = mEvictions;
+    }
+
+    void TextureCache::toJson(JsonWriter& writer)
+    {
+        TextureCacheStats cacheStats;
+        stats(cacheStats);
+        writer.StartObject();
+        writer.Key("entries");
+        writer.Uint(cacheStats.entries);
+        writer.Key("entriesInUse");
+        writer.Uint(cacheStats.entriesInUse);
+        writer.Key("bytes");
+        writer.Uint64(cacheStats.bytes);
+        writer.Key("budgetBytes");
+        writer.Uint64(cacheStats.budgetBytes);
+        writer.Key("hits");
+        writer.Uint64(cacheStats.hits);
+        writer.Key("misses");
+        writer.Uint64(cacheStats.misses);
+        writer.Key("evictions");
+        writer.Uint64(cacheStats.evictions);
+        writer.EndObject();
+    }
+}
@@ -0,0 +1,96 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "rdkshelljson.h"
+
+#include <GLES2/gl2.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+#define RDKSHELL_TEXTURE_CACHE_DEFAULT_BUDGET_MB 32
+
+namespace RdkShell
+{
+    struct TextureCacheStats
+    {
+        TextureCacheStats() : entries(0), entriesInUse(0), bytes(0), budgetBytes(0), hits(0), misses(0), evictions(0) {}
+        uint32_t entries;
+        uint32_t entriesInUse;
+        uint64_t bytes;
+        uint64_t budgetBytes;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+    };
+
+    /*
+        TextureCache keeps the textures of decoded images so showing an image again does not decode it again.
+        textures are reference counted, the ones nobody uses stay cached and are evicted least recently used
+        first once the cache is over its gpu memory budget. render thread only.
+    */
+    class TextureCache
+    {
+    public:
+        static TextureCache *instance();
+
+        // the key changes when the file is modified, false when the file cannot be read
+        static bool fileKey(const std::string& fileName, std::string& key);
+        static std::string dataKey(const char* data, size_t size);
+
+        // returns the cached texture with a new reference, or 0 when the key is not cached
+        GLuint acquire(const std::string& key, int32_t& width, int32_t& height);
+        // takes ownership of the texture and returns it with one reference, or the texture already
+        // cached for the key when it was added in the meantime
+        GLuint add(const std::string& key, GLuint texture, int32_t width, int32_t height, uint64_t bytes);
+        void release(GLuint texture);
+        void setBudget(uint64_t budgetInBytes);
+        void stats(TextureCacheStats& cacheStats);
+        void toJson(JsonWriter& writer);
+
+    private:
+        TextureCache();
+        ~TextureCache();
+
+        struct Entry
+        {
+            GLuint texture;
+            int32_t width;
+            int32_t height;
+            uint64_t bytes;
+            uint32_t references;
+            std::list<std::string>::iterator idleIterator;
+        };
+
+        void addReference(Entry& entry);
+        void trim();
+
+        std::unordered_map<std::string, Entry> mEntries;
+        std::unordered_map<GLuint, std::string> mKeysByTexture;
+        std::list<std::string> mIdleEntries; // unused entries, least recently used first
+        uint64_t mBytes;
+        uint64_t mBudgetBytes;
+        uint64_t mHits;
+        uint64_t mMisses;
+        uint64_t mEvictions;
+    };
+}
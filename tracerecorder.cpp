@@ -0,0 +1,283 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "tracerecorder.h"
+#include "rdkshell.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <signal.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace RdkShell
+{
+    // the spans of one thread, written by that thread only
+    struct TraceBuffer
+    {
+        TraceBuffer(int id) : threadId(id), count(0), orphaned(false), events(new TraceEvent[RDKSHELL_TRACE_EVENTS_PER_THREAD]) {}
+        int threadId;
+        std::atomic<uint64_t> count;
+        std::atomic<bool> orphaned; // the thread exited, the buffer is released when the next capture starts
+        std::unique_ptr<TraceEvent[]> events;
+    };
+
+    struct ThreadTraceState
+    {
+        ThreadTraceState() : buffer(NULL) {}
+        ~ThreadTraceState()
+        {
+            if (NULL != buffer)
+            {
+                buffer->orphaned.store(true, std::memory_order_release);
+            }
+        }
+        TraceBuffer* buffer;
+    };
+
+    static thread_local ThreadTraceState sThreadTraceState;
+    static std::atomic<bool> sTraceSignalPending(false);
+
+    static void onTraceSignal(int /*signalNumber*/)
+    {
+        sTraceSignalPending.store(true, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> TraceRecorder::sRecording(false);
+
+    TraceRecorder::TraceRecorder() : mCaptureStartTime(0), mCaptureEndTime(0.0), mTraceFile(RDKSHELL_TRACE_DEFAULT_FILE),
+        mSignalCaptureDuration(RDKSHELL_TRACE_DEFAULT_DURATION_SECONDS)
+    {
+    }
+
+    TraceRecorder::~TraceRecorder()
+    {
+    }
+
+    TraceRecorder *TraceRecorder::instance()
+    {
+        static TraceRecorder traceRecorder;
+
+        return &traceRecorder;
+    }
+
+    void TraceRecorder::start(double durationInSeconds)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mBufferMutex);
+            for (auto it = mBuffers.begin(); it != mBuffers.end();)
+            {
+                if ((*it)->orphaned.load(std::memory_order_acquire))
+                {
+                    it = mBuffers.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        mCaptureStartTime = (uint64_t)microseconds();
+        mCaptureEndTime = (durationInSeconds > 0) ? seconds() + durationInSeconds : 0.0;
+        sRecording.store(true, std::memory_order_release);
+        Logger::log(LogLevel::Information, "trace capture started for %f seconds", durationInSeconds);
+    }
+
+    bool TraceRecorder::stop()
+    {
+        if (!isRecording())
+        {
+            Logger::log(LogLevel::Warn, "no trace capture is running");
+            return false;
+        }
+        sRecording.store(false, std::memory_order_release);
+        uint64_t captureEndTime = (uint64_t)microseconds();
+
+        std::ofstream file(mTraceFile, std::ios::trunc);
+        if (!file.good())
+        {
+            Logger::log(LogLevel::Warn, "unable to write trace to %s", mTraceFile.c_str());
+            return false;
+        }
+        rapidjson::StringBuffer buffer;
+        JsonWriter writer(buffer);
+        toJson(writer, mCaptureStartTime, captureEndTime);
+        file.write(buffer.GetString(), buffer.GetSize());
+        file << std::endl;
+        Logger::log(LogLevel::Information, "trace written to %s", mTraceFile.c_str());
+        return true;
+    }
+
+    TraceBuffer* TraceRecorder::bufferForThread()
+    {
+        if (NULL == sThreadTraceState.buffer)
+        {
+            TraceBuffer* buffer = new TraceBuffer(syscall(__NR_gettid));
+            std::lock_guard<std::mutex> lock(mBufferMutex);
+            mBuffers.push_back(std::unique_ptr<TraceBuffer>(buffer));
+            sThreadTraceState.buffer = buffer;
+        }
+        return sThreadTraceState.buffer;
+    }
+
+    void TraceRecorder::record(const char* category, const char* name, uint64_t startTime, uint64_t endTime)
+    {
+        TraceBuffer* buffer = bufferForThread();
+        uint64_t count = buffer->count.load(std::memory_order_relaxed);
+        TraceEvent& event = buffer->events[count % RDKSHELL_TRACE_EVENTS_PER_THREAD];
+        event.category = category;
+        event.name = name;
+        event.startTime = startTime;
+        event.duration = (uint32_t)(endTime - startTime);
+        buffer->count.store(count + 1, std::memory_order_release);
+    }
+
+    void TraceRecorder::update()
+    {
+        if (sTraceSignalPending.exchange(false, std::memory_order_relaxed))
+        {
+            if (isRecording())
+            {
+                stop();
+            }
+            else
+            {
+                start(mSignalCaptureDuration);
+            }
+        }
+        if (isRecording() && (mCaptureEndTime > 0) && (seconds() >= mCaptureEndTime))
+        {
+            stop();
+        }
+    }
+
+    void TraceRecorder::setTraceFile(const std::string& fileName)
+    {
+        mTraceFile = fileName;
+    }
+
+    const std::string& TraceRecorder::traceFile() const
+    {
+        return mTraceFile;
+    }
+
+    void TraceRecorder::enableSignalTrigger(double durationInSeconds)
+    {
+        mSignalCaptureDuration = durationInSeconds;
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = onTraceSignal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGUSR2, &action, NULL) != 0)
+        {
+            Logger::log(LogLevel::Warn, "unable to install the trace signal handler");
+            return;
+        }
+        Logger::log(LogLevel::Information, "SIGUSR2 will capture %f seconds of trace into %s", durationInSeconds, mTraceFile.c_str());
+    }
+
+    void TraceRecorder::toJson(JsonWriter& writer, uint64_t startTime, uint64_t endTime)
+    {
+        int processId = getpid();
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("process_name");
+        writer.Key("ph");
+        writer.String("M");
+        writer.Key("pid");
+        writer.Int(processId);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("rdkshell");
+        writer.EndObject();
+        writer.EndObject();
+
+        std::vector<TraceEvent> events;
+        std::lock_guard<std::mutex> lock(mBufferMutex);
+        for (const std::unique_ptr<TraceBuffer>& buffer : mBuffers)
+        {
+            // the thread may still be finishing a span, so slots it reused while they were copied are skipped
+            uint64_t count = buffer->count.load(std::memory_order_acquire);
+            uint64_t first = (count > RDKSHELL_TRACE_EVENTS_PER_THREAD) ? count - RDKSHELL_TRACE_EVENTS_PER_THREAD : 0;
+            events.clear();
+            for (uint64_t index = first; index < count; index++)
+            {
+                events.push_back(buffer->events[index % RDKSHELL_TRACE_EVENTS_PER_THREAD]);
+            }
+            uint64_t countAfterCopy = buffer->count.load(std::memory_order_acquire);
+            uint64_t firstValid = (countAfterCopy > RDKSHELL_TRACE_EVENTS_PER_THREAD) ? countAfterCopy - RDKSHELL_TRACE_EVENTS_PER_THREAD : 0;
+            if (firstValid > first)
+            {
+                events.erase(events.begin(), events.begin() + std::min<uint64_t>(firstValid - first, events.size()));
+            }
+            if ((first > 0) && !events.empty() && (events.front().startTime > startTime))
+            {
+                Logger::log(LogLevel::Warn, "the trace of thread %d lost its oldest spans, the capture was longer than its buffer", buffer->threadId);
+            }
+
+            for (const TraceEvent& event : events)
+            {
+                if ((event.startTime < startTime) || (event.startTime + event.duration > endTime))
+                {
+                    continue;
+                }
+                writer.StartObject();
+                writer.Key("name");
+                writer.String(event.name);
+                writer.Key("cat");
+                writer.String(event.category);
+                writer.Key("ph");
+                writer.String("X");
+                writer.Key("ts");
+                writer.Uint64(event.startTime);
+                writer.Key("dur");
+                writer.Uint(event.duration);
+                writer.Key("pid");
+                writer.Int(processId);
+                writer.Key("tid");
+                writer.Int(buffer->threadId);
+                writer.EndObject();
+            }
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    TraceSpan::TraceSpan(const char* category, const char* name) : mCategory(category), mName(name),
+        mStartTime(TraceRecorder::isRecording() ? (uint64_t)RdkShell::microseconds() : 0)
+    {
+    }
+
+    TraceSpan::~TraceSpan()
+    {
+        if (0 != mStartTime)
+        {
+            TraceRecorder::instance()->record(mCategory, mName, mStartTime, (uint64_t)RdkShell::microseconds());
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2022 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "rdkshelljson.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#define RDKSHELL_TRACE_EVENTS_PER_THREAD 16384
+#define RDKSHELL_TRACE_DEFAULT_FILE "/tmp/rdkshell_trace.json"
+#define RDKSHELL_TRACE_DEFAULT_DURATION_SECONDS 10
+
+namespace RdkShell
+{
+    // category and name must be string literals, only the pointers are recorded
+    struct TraceEvent
+    {
+        const char* category;
+        const char* name;
+        uint64_t startTime;
+        uint32_t duration;
+    };
+
+    struct TraceBuffer;
+
+    /*
+        TraceRecorder keeps the spans of each thread in a preallocated ring owned by that thread, so recording
+        a span never locks or allocates. a capture is started and stopped on the render thread, through ipc or
+        SIGUSR2, and written as a chrome trace that perfetto and chrome://tracing open directly.
+    */
+    class TraceRecorder
+    {
+    public:
+        static TraceRecorder *instance();
+        static bool isRecording()
+        {
+            return sRecording.load(std::memory_order_relaxed);
+        }
+
+        // a duration of 0 records until stop is called
+        void start(double durationInSeconds = 0.0);
+        // ends the capture and writes it to the trace file
+        bool stop();
+        void record(const char* category, const char* name, uint64_t startTime, uint64_t endTime);
+        // called every frame on the render thread to end timed captures and handle SIGUSR2
+        void update();
+        void setTraceFile(const std::string& fileName);
+        const std::string& traceFile() const;
+        // SIGUSR2 starts a capture of the given length, a second signal ends it early
+        void enableSignalTrigger(double durationInSeconds);
+
+    private:
+        TraceRecorder();
+        ~TraceRecorder();
+        TraceBuffer* bufferForThread();
+        void toJson(JsonWriter& writer, uint64_t startTime, uint64_t endTime);
+
+        static std::atomic<bool> sRecording;
+        std::mutex mBufferMutex;
+        std::vector<std::unique_ptr<TraceBuffer>> mBuffers;
+        uint64_t mCaptureStartTime;
+        double mCaptureEndTime;
+        std::string mTraceFile;
+        double mSignalCaptureDuration;
+    };
+
+    class TraceSpan
+    {
+    public:
+        TraceSpan(const char* category, const char* name);
+        ~TraceSpan();
+
+    private:
+        const char* mCategory;
+        const char* mName;
+        uint64_t mStartTime;
+    };
+}
+
+#define RDKSHELL_TRACE_CONCAT_INNER(a, b) a##b
+#define RDKSHELL_TRACE_CONCAT(a, b) RDKSHELL_TRACE_CONCAT_INNER(a, b)
+// records the rest of the enclosing scope as a span while a capture is running
+#define RDKSHELL_TRACE_SPAN(category, name) RdkShell::TraceSpan RDKSHELL_TRACE_CONCAT(rdkshellTraceSpan, __LINE__)(category, name)